@@ -164,6 +164,8 @@ macro(pism_find_prerequisites)
   find_package (NetCDF REQUIRED)
   find_package (FFTW REQUIRED)
   find_package (HDF5 COMPONENTS C HL)
+  # used by the asynchronous output code
+  find_package (Threads REQUIRED)
 
   # Optional libraries
   if (Pism_USE_PNETCDF)
@@ -242,7 +244,8 @@ macro(pism_set_dependencies)
     ${NETCDF_LIBRARIES}
     ${MPI_C_LIBRARIES}
     ${HDF5_LIBRARIES}
-    ${HDF5_HL_LIBRARIES})
+    ${HDF5_HL_LIBRARIES}
+    ${CMAKE_THREAD_LIBS_INIT})
 
   # optional libraries
   if (Pism_USE_JANSSON)
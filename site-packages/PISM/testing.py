@@ -2,6 +2,8 @@
 
 import PISM
 import numpy as np
+import os
+import contextlib
 
 def shallow_grid(Mx=3, My=5, Lx=10e3, Ly=20e3):
     "Create a shallow computational grid for testing"
@@ -10,6 +12,43 @@ def shallow_grid(Mx=3, My=5, Lx=10e3, Ly=20e3):
                                 PISM.CELL_CORNER,
                                 PISM.NOT_PERIODIC)
 
+def index_field(grid, name, offset=0.0):
+    """Create a 2D field equal to 1000*j + i + offset.
+
+    Values identify grid points and are represented exactly in all output formats, so
+    they can be compared exactly after a round trip through a file."""
+    v = PISM.IceModelVec2S(grid, name, PISM.WITHOUT_GHOSTS)
+    with PISM.vec.Access(nocomm=v):
+        for (i, j) in grid.points():
+            v[i, j] = 1000.0 * j + i + offset
+    return v
+
+def check_index_field(v, offset=0.0):
+    "Check that v contains values set by index_field()."
+    with PISM.vec.Access(nocomm=v):
+        for (i, j) in v.grid().points():
+            assert v[i, j] == 1000.0 * j + i + offset, (i, j, v[i, j])
+
+def read_field(grid, name, file_name, method="regrid"):
+    "Read a 2D field from a file using IceModelVec::regrid() or IceModelVec::read()."
+    v = PISM.IceModelVec2S(grid, name, PISM.WITHOUT_GHOSTS)
+    if method == "regrid":
+        v.regrid(file_name, critical=True)
+    else:
+        v.read(file_name, 0)
+    return v
+
+@contextlib.contextmanager
+def temporary_files(*file_names):
+    "Remove files (if they exist) when done, even if a test fails."
+    try:
+        yield
+    finally:
+        if PISM.Context().rank == 0:
+            for f in file_names:
+                if os.path.exists(f):
+                    os.remove(f)
+
 def sample(vec, i=0, j=0):
     "Sample a PISM array"
     with PISM.vec.Access(nocomm=vec):
@@ -20,6 +20,7 @@
 #include "AgeColumnSystem.hh"
 
 #include "pism/util/error_handling.hh"
+#include "pism/util/iceModelVec.hh"
 
 namespace pism {
 
@@ -50,15 +51,20 @@ void AgeColumnSystem::init(int i, int j, double thickness) {
     return;
   }
 
-  coarse_to_fine(m_u3, i, j, &m_u[0]);
-  coarse_to_fine(m_v3, i, j, &m_v[0]);
-  coarse_to_fine(m_w3, i, j, &m_w[0]);
-
-  coarse_to_fine(m_age3, m_i, m_j,   &m_A[0]);
-  coarse_to_fine(m_age3, m_i, m_j+1, &m_A_n[0]);
-  coarse_to_fine(m_age3, m_i+1, m_j, &m_A_e[0]);
-  coarse_to_fine(m_age3, m_i, m_j-1, &m_A_s[0]);
-  coarse_to_fine(m_age3, m_i-1, m_j, &m_A_w[0]);
+  const double *coarse[] = {
+    m_u3.get_column(i, j),
+    m_v3.get_column(i, j),
+    m_w3.get_column(i, j),
+    m_age3.get_column(m_i, m_j),
+    m_age3.get_column(m_i, m_j + 1),
+    m_age3.get_column(m_i + 1, m_j),
+    m_age3.get_column(m_i, m_j - 1),
+    m_age3.get_column(m_i - 1, m_j)
+  };
+  double *fine[] = {&m_u[0], &m_v[0], &m_w[0],
+                    &m_A[0], &m_A_n[0], &m_A_e[0], &m_A_s[0], &m_A_w[0]};
+
+  coarse_to_fine(coarse, 8, fine);
 }
 
 //! First-order upwind scheme with implicit in the vertical: one column solve.
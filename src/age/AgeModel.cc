@@ -17,12 +17,16 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <cmath>
+#include <algorithm>
+
 #include "AgeModel.hh"
 
 #include "pism/age/AgeColumnSystem.hh"
 #include "pism/util/error_handling.hh"
 #include "pism/util/Vars.hh"
 #include "pism/util/io/File.hh"
+#include "pism/util/pism_utilities.hh"
 
 namespace pism {
 
@@ -55,13 +59,40 @@ void AgeModelInputs::check() const {
   check_input(w3, "w3");
 }
 
+/*!
+ * Width of the halo of the age field.
+ *
+ * The semi-Lagrangian method may use a wider halo to allow longer sub-steps.
+ */
+static unsigned int age_stencil_width(const Config &config) {
+  unsigned int result = config.get_number("grid.max_stencil_width");
+
+  if (config.get_string("age.method") == "semi_lagrangian") {
+    result = std::max(result, (unsigned int)config.get_number("age.semi_lagrangian.halo_width"));
+  }
+
+  return result;
+}
+
 AgeModel::AgeModel(IceGrid::ConstPtr grid, stressbalance::StressBalance *stress_balance)
   : Component(grid),
     // FIXME: should be able to use width=1...
-    m_ice_age(m_grid, "age", WITH_GHOSTS, m_config->get_number("grid.max_stencil_width")),
+    m_ice_age(m_grid, "age", WITH_GHOSTS, age_stencil_width(*m_config)),
     m_work(m_grid, "work_vector", WITHOUT_GHOSTS),
     m_stress_balance(stress_balance) {
 
+  m_semi_lagrangian   = m_config->get_string("age.method") == "semi_lagrangian";
+  m_halo_width        = age_stencil_width(*m_config);
+  m_update_interval   = m_config->get_number("age.semi_lagrangian.update_interval", "seconds");
+  m_time_since_update = 0.0;
+  m_time_since_update_name = "age_time_since_update";
+
+  if (m_semi_lagrangian and m_halo_width < 2) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "age.semi_lagrangian.halo_width = %d is invalid"
+                                  " (has to be 2 or greater)", m_halo_width);
+  }
+
   m_ice_age.set_attrs("model_state", "age of ice",
                       "s", "years", "" /* no standard name*/, 0);
 
@@ -104,6 +135,9 @@ calculation.  Note that the columnSystemCtx methods coarse_to_fine() and
 fine_to_coarse() interpolate back and forth between this fine grid and
 the storage grid.  The storage grid may or may not be equally-spaced.  See
 AgeColumnSystem::solve() for the actual method.
+
+If `age.method` is set to "semi_lagrangian" we use a semi-Lagrangian method
+instead; see update_semi_lagrangian().
  */
 void AgeModel::update(double t, double dt, const AgeModelInputs &inputs) {
 
@@ -112,6 +146,15 @@ void AgeModel::update(double t, double dt, const AgeModelInputs &inputs) {
 
   inputs.check();
 
+  if (m_semi_lagrangian) {
+    update_semi_lagrangian(dt, inputs);
+  } else {
+    update_upwind(dt, inputs);
+  }
+}
+
+void AgeModel::update_upwind(double dt, const AgeModelInputs &inputs) {
+
   const IceModelVec2S &ice_thickness = *inputs.ice_thickness;
 
   const IceModelVec3
@@ -169,6 +212,205 @@ void AgeModel::update(double t, double dt, const AgeModelInputs &inputs) {
   m_work.update_ghosts(m_ice_age);
 }
 
+/*!
+ * Interpolate `age` at the point with (fractional) grid indexes `(x, y)` and the height
+ * above the base `z`.
+ *
+ * Indexes `(x, y)` have to be within `halo_width - 1` grid cells from `(i, j)`.
+ */
+static double interpolate_age(const IceModelVec3 &age, const std::vector<double> &z_levels,
+                              int i, int j, int halo_width,
+                              double x, double y, double z) {
+  const int max_shift = halo_width - 1;
+
+  x = std::max(std::min(x, (double)(i + max_shift)), (double)(i - max_shift));
+  y = std::max(std::min(y, (double)(j + max_shift)), (double)(j - max_shift));
+
+  const int
+    i0 = std::min((int)floor(x), i + max_shift - 1),
+    j0 = std::min((int)floor(y), j + max_shift - 1);
+
+  const double
+    a = x - i0,
+    b = y - j0;
+
+  // find the storage grid level just below z
+  const unsigned int Mz = z_levels.size();
+  unsigned int k0 = std::upper_bound(z_levels.begin(), z_levels.end(), z) - z_levels.begin();
+  k0 = std::min(std::max(k0, 1u), Mz - 1) - 1;
+
+  const double c = std::max(std::min((z - z_levels[k0]) / (z_levels[k0 + 1] - z_levels[k0]),
+                                     1.0),
+                            0.0);
+
+  const double
+    *A00 = age.get_column(i0,     j0),
+    *A10 = age.get_column(i0 + 1, j0),
+    *A01 = age.get_column(i0,     j0 + 1),
+    *A11 = age.get_column(i0 + 1, j0 + 1);
+
+  const double
+    a00 = A00[k0] + c * (A00[k0 + 1] - A00[k0]),
+    a10 = A10[k0] + c * (A10[k0 + 1] - A10[k0]),
+    a01 = A01[k0] + c * (A01[k0 + 1] - A01[k0]),
+    a11 = A11[k0] + c * (A11[k0 + 1] - A11[k0]);
+
+  return ((1.0 - a) * (1.0 - b) * a00 + a * (1.0 - b) * a10 +
+          (1.0 - a) * b * a01 + a * b * a11);
+}
+
+/*!
+ * Update age using a semi-Lagrangian method.
+ *
+ * The age is updated once the time since the last update reaches
+ * `age.semi_lagrangian.update_interval`, using the velocity field available at that
+ * time. The method is unconditionally stable, so the length of this interval is not
+ * restricted by the CFL condition. To keep departure points within the halo of the
+ * age field this interval is split into sub-steps such that the horizontal
+ * displacement during each sub-step does not exceed `age.semi_lagrangian.halo_width - 1`
+ * grid cells.
+ */
+void AgeModel::update_semi_lagrangian(double dt, const AgeModelInputs &inputs) {
+
+  m_time_since_update += dt;
+
+  if (m_time_since_update < m_update_interval) {
+    return;
+  }
+
+  const double update_dt = m_time_since_update;
+  m_time_since_update = 0.0;
+
+  const IceModelVec2S &ice_thickness = *inputs.ice_thickness;
+
+  const IceModelVec3
+    &u3 = *inputs.u3,
+    &v3 = *inputs.v3;
+
+  // maximum horizontal speed in grid cells per second
+  double max_rate = 0.0;
+  {
+    const double
+      dx = m_grid->dx(),
+      dy = m_grid->dy();
+
+    IceModelVec::AccessList list{&ice_thickness, &u3, &v3};
+
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      if (ice_thickness(i, j) <= 0.0) {
+        continue;
+      }
+
+      const unsigned int ks = m_grid->kBelowHeight(ice_thickness(i, j));
+      const double
+        *u = u3.get_column(i, j),
+        *v = v3.get_column(i, j);
+
+      for (unsigned int k = 0; k <= ks; ++k) {
+        max_rate = std::max(max_rate, std::max(fabs(u[k]) / dx, fabs(v[k]) / dy));
+      }
+    }
+
+    max_rate = GlobalMax(m_grid->com, max_rate);
+  }
+
+  const int n_steps = std::max(1, (int)ceil(max_rate * update_dt / (m_halo_width - 1)));
+
+  for (int n = 0; n < n_steps; ++n) {
+    semi_lagrangian_step(update_dt / n_steps, inputs);
+  }
+
+  m_log->message(3, "  age: took %d semi-Lagrangian sub-steps\n", n_steps);
+}
+
+/*!
+ * Take one step of the semi-Lagrangian method.
+ *
+ * For each grid point in the ice we trace the trajectory back to the departure point,
+ * using the velocity at the arrival point, and use trilinear interpolation to compute the
+ * age at the departure point. If the trajectory crosses the ice surface (or the base of
+ * the ice, in areas with freeze-on) during this step the age at the arrival point is the
+ * time since crossing.
+ *
+ * Uses ghosts of m_ice_age, which have to be up to date.
+ */
+void AgeModel::semi_lagrangian_step(double dt, const AgeModelInputs &inputs) {
+
+  const IceModelVec2S &ice_thickness = *inputs.ice_thickness;
+
+  const IceModelVec3
+    &u3 = *inputs.u3,
+    &v3 = *inputs.v3,
+    &w3 = *inputs.w3;
+
+  const std::vector<double> &z = m_grid->z();
+  const unsigned int Mz = z.size();
+
+  const double
+    dx = m_grid->dx(),
+    dy = m_grid->dy();
+
+  IceModelVec::AccessList list{&ice_thickness, &u3, &v3, &w3, &m_ice_age, &m_work};
+
+  ParallelSection loop(m_grid->com);
+  try {
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      const double H = ice_thickness(i, j);
+
+      if (H <= 0.0) {
+        // if no ice, set the entire column to zero age
+        m_work.set_column(i, j, 0.0);
+        continue;
+      }
+
+      const unsigned int ks = m_grid->kBelowHeight(H);
+
+      const double
+        *u = u3.get_column(i, j),
+        *v = v3.get_column(i, j),
+        *w = w3.get_column(i, j);
+
+      double *result = m_work.get_column(i, j);
+
+      for (unsigned int k = 0; k <= ks; ++k) {
+        // departure point
+        const double
+          x_d = i - dt * u[k] / dx,
+          y_d = j - dt * v[k] / dy,
+          z_d = z[k] - dt * w[k];
+
+        double age = 0.0;
+        if (z_d > H) {
+          // the trajectory crosses the ice surface
+          age = dt * (H - z[k]) / (z_d - z[k]);
+        } else if (z_d < 0.0) {
+          // the trajectory crosses the base of the ice (freeze-on)
+          age = dt * z[k] / (z[k] - z_d);
+        } else {
+          age = interpolate_age(m_ice_age, z, i, j, m_halo_width, x_d, y_d, z_d) + dt;
+        }
+
+        // ensure that the age of the ice is non-negative
+        result[k] = std::max(age, 0.0);
+      }
+
+      // set age above the ice surface to zero
+      for (unsigned int k = ks + 1; k < Mz; ++k) {
+        result[k] = 0.0;
+      }
+    }
+  } catch (...) {
+    loop.failed();
+  }
+  loop.check();
+
+  m_work.update_ghosts(m_ice_age);
+}
+
 const IceModelVec3 & AgeModel::age() const {
   return m_ice_age;
 }
@@ -177,6 +419,11 @@ MaxTimestep AgeModel::max_timestep_impl(double t) const {
   // fix a compiler warning
   (void) t;
 
+  if (m_semi_lagrangian) {
+    // the semi-Lagrangian method is unconditionally stable
+    return MaxTimestep("age model");
+  }
+
   if (m_stress_balance == NULL) {
     throw RuntimeError::formatted(PISM_ERROR_LOCATION,
                                   "AgeModel: no stress balance provided."
@@ -190,12 +437,22 @@ void AgeModel::init(const InputOptions &opts) {
 
   m_log->message(2, "* Initializing the age model...\n");
 
+  if (m_semi_lagrangian) {
+    m_log->message(2,
+                   " - using the semi-Lagrangian method (update interval: %.1f years)\n",
+                   units::convert(m_sys, m_update_interval, "seconds", "years"));
+  }
+
 
   double initial_age_years = m_config->get_number("age.initial_value", "years");
 
   if (opts.type == INIT_RESTART) {
     File input_file(m_grid->com, opts.filename, PISM_GUESS, PISM_READONLY);
 
+    if (m_semi_lagrangian and input_file.find_variable(m_time_since_update_name)) {
+      input_file.read_variable(m_time_since_update_name, {0}, {1}, &m_time_since_update);
+    }
+
     if (input_file.find_variable("age")) {
       m_ice_age.read(input_file, opts.record);
     } else {
@@ -215,10 +472,22 @@ void AgeModel::init(const InputOptions &opts) {
 
 void AgeModel::define_model_state_impl(const File &output) const {
   m_ice_age.define(output);
+
+  if (m_semi_lagrangian and not output.find_variable(m_time_since_update_name)) {
+    output.define_variable(m_time_since_update_name, PISM_DOUBLE, {});
+
+    output.write_attribute(m_time_since_update_name, "long_name",
+                           "time since the last update of the semi-Lagrangian age model");
+    output.write_attribute(m_time_since_update_name, "units", "seconds");
+  }
 }
 
 void AgeModel::write_model_state_impl(const File &output) const {
   m_ice_age.write(output);
+
+  if (m_semi_lagrangian) {
+    output.write_variable(m_time_since_update_name, {0}, {1}, &m_time_since_update);
+  }
 }
 
 } // end of namespace pism
@@ -1,4 +1,4 @@
-/* Copyright (C) 2016, 2017 PISM Authors
+/* Copyright (C) 2016, 2017, 2019 PISM Authors
  *
  * This file is part of PISM.
  *
@@ -55,6 +55,21 @@ protected:
   void define_model_state_impl(const File &output) const;
   void write_model_state_impl(const File &output) const;
 
+  void update_upwind(double dt, const AgeModelInputs &inputs);
+  void update_semi_lagrangian(double dt, const AgeModelInputs &inputs);
+  void semi_lagrangian_step(double dt, const AgeModelInputs &inputs);
+
+  //! true if the semi-Lagrangian method is used
+  bool m_semi_lagrangian;
+  //! width of the halo of m_ice_age (limits horizontal displacement during a sub-step)
+  unsigned int m_halo_width;
+  //! minimum interval between updates (used by the semi-Lagrangian method)
+  double m_update_interval;
+  //! time since the last update (used by the semi-Lagrangian method)
+  double m_time_since_update;
+  //! name of the variable used to save m_time_since_update
+  std::string m_time_since_update_name;
+
   IceModelVec3 m_ice_age;
   IceModelVec3 m_work;
   stressbalance::StressBalance *m_stress_balance;
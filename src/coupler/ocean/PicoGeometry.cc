@@ -20,7 +20,7 @@
 #include <algorithm> // max_element
 
 #include "PicoGeometry.hh"
-#include "pism/util/connected_components.hh"
+#include "pism/util/label_components.hh"
 #include "pism/util/IceModelVec2CellType.hh"
 #include "pism/util/pism_utilities.hh"
 
@@ -45,8 +45,6 @@ PicoGeometry::PicoGeometry(IceGrid::ConstPtr grid)
                                      {OCEAN, RISE, CONTINENTAL, FLOATING});
   m_ice_rises.metadata().set_string("flag_meanings",
                                      "ocean ice_rise continental_ice_sheet, floating_ice");
-
-  m_tmp_p0 = m_tmp.allocate_proc0_copy();
 }
 
 PicoGeometry::~PicoGeometry() {
@@ -115,7 +113,7 @@ void PicoGeometry::update(const IceModelVec2S &bed_elevation, const IceModelVec2
 enum RelabelingType {BY_AREA, AREA_THRESHOLD};
 
 /*!
- * Re-label components in a mask processed by label_connected_components.
+ * Re-label components in a mask processed by label_components.
  *
  * If type is `BY_AREA`, the biggest one gets the value of 2, all the other ones 1, the
  * background is set to zero.
@@ -206,26 +204,6 @@ static void relabel(RelabelingType type,
   }
 }
 
-/*!
- * Run the serial connected-component labeling algorithm on m_tmp.
- */
-void PicoGeometry::label_tmp() {
-  m_tmp.put_on_proc0(*m_tmp_p0);
-
-  ParallelSection rank0(m_grid->com);
-  try {
-    if (m_grid->rank() == 0) {
-      petsc::VecArray mask_p0(*m_tmp_p0);
-      label_connected_components(mask_p0.get(), m_grid->My(), m_grid->Mx(), false, 0.0);
-    }
-  } catch (...) {
-    rank0.failed();
-  }
-  rank0.check();
-
-  m_tmp.get_from_proc0(*m_tmp_p0);
-}
-
 static bool edge_p(int i, int j, int Mx, int My) {
   return (i == 0) or (i == Mx - 1) or (j == 0) or (j == My - 1);
 }
@@ -264,22 +242,7 @@ void PicoGeometry::compute_lakes(const IceModelVec2CellType &cell_type, IceModel
   }
 
   // identify "floating" areas that are not connected to the open ocean as defined above
-  {
-    m_tmp.put_on_proc0(*m_tmp_p0);
-
-    ParallelSection rank0(m_grid->com);
-    try {
-      if (m_grid->rank() == 0) {
-        petsc::VecArray mask_p0(*m_tmp_p0);
-        label_connected_components(mask_p0.get(), My, Mx, true, 2.0);
-      }
-    } catch (...) {
-      rank0.failed();
-    }
-    rank0.check();
-
-    m_tmp.get_from_proc0(*m_tmp_p0);
-  }
+  label_components(m_tmp, true, 2.0);
 
   result.copy_from(m_tmp);
 }
@@ -311,7 +274,7 @@ void PicoGeometry::compute_ice_rises(const IceModelVec2CellType &cell_type, bool
   }
 
   if (exclude_ice_rises) {
-    label_tmp();
+    label_components(m_tmp, false, 0.0);
 
     relabel(AREA_THRESHOLD,
             m_config->get_number("ocean.pico.maximum_ice_rise_area", "m2"),
@@ -360,22 +323,7 @@ void PicoGeometry::compute_continental_shelf_mask(const IceModelVec2S &bed_eleva
 
   // use "iceberg identification" to label parts *not* connected to the continental ice
   // sheet
-  {
-    m_tmp.put_on_proc0(*m_tmp_p0);
-
-    ParallelSection rank0(m_grid->com);
-    try {
-      if (m_grid->rank() == 0) {
-        petsc::VecArray mask_p0(*m_tmp_p0);
-        label_connected_components(mask_p0.get(), m_grid->My(), m_grid->Mx(), true, 2.0);
-      }
-    } catch (...) {
-      rank0.failed();
-    }
-    rank0.check();
-
-    m_tmp.get_from_proc0(*m_tmp_p0);
-  }
+  label_components(m_tmp, true, 2.0);
 
   // At this point areas with bed > threshold are 1, everything else is zero.
   //
@@ -422,7 +370,7 @@ void PicoGeometry::compute_ice_shelf_mask(const IceModelVec2Int &ice_rise_mask,
     }
   }
 
-  label_tmp();
+  label_components(m_tmp, false, 0.0);
 
   // remove ice rises and lakes
   for (Points p(*m_grid); p; p.next()) {
@@ -460,7 +408,7 @@ void PicoGeometry::compute_ocean_mask(const IceModelVec2CellType &cell_type, Ice
     }
   }
 
-  label_tmp();
+  label_components(m_tmp, false, 0.0);
 
   relabel(BY_AREA, 0.0, m_tmp);
 
@@ -65,7 +65,6 @@ private:
   void compute_box_mask(const IceModelVec2Int &D_gl, const IceModelVec2Int &D_cf, const IceModelVec2Int &shelf_mask,
                         int n_boxes, IceModelVec2Int &result);
 
-  void label_tmp();
   void relabel_by_size(IceModelVec2Int &mask);
 
   // storage for outputs
@@ -82,7 +81,6 @@ private:
 
   // temporary storage
   IceModelVec2Int m_tmp;
-  petsc::Vec::Ptr m_tmp_p0;
 };
 
 } // end of namespace ocean
@@ -16,6 +16,9 @@
 // along with PISM; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
+#include <cmath>                // std::abs, std::round, std::sqrt
+#include <algorithm>            // std::max
+
 #include "LingleClark.hh"
 
 #include "pism/util/io/File.hh"
@@ -27,17 +30,167 @@
 #include "pism/util/MaxTimestep.hh"
 #include "pism/util/pism_utilities.hh"
 #include "pism/util/fftw_utilities.hh"
+#include "pism/util/io/io_helpers.hh"
 #include "LingleClarkSerial.hh"
+#include "LingleClarkParallel.hh"
+#include "greens.hh"
+#include "matlablike.hh"
 
 namespace pism {
 namespace bed {
 
+//! Name of the variable storing the elastic load response in a cache file.
+static const char *load_response_name = "elastic_load_response";
+
+/*!
+ * Compute values of the elastic load response matrix for p = 0..Nx2, q = 0..Ny2,
+ * distributing the work among all processes in `com`.
+ */
+static std::vector<double> compute_load_response(MPI_Comm com,
+                                                 double dx, double dy,
+                                                 int Nx2, int Ny2) {
+  int rank = 0, size = 0;
+  MPI_Comm_rank(com, &rank);
+  MPI_Comm_size(com, &size);
+
+  const int N = (Nx2 + 1) * (Ny2 + 1);
+
+  std::vector<double> local(N, 0.0), result(N, 0.0);
+
+  greens_elastic G;
+  ge_data ge_data {dx, dy, 0, 0, &G};
+
+  // The cost of computing an integral depends on the distance from the load, so we
+  // distribute entries in a round-robin fashion.
+  for (int k = rank; k < N; k += size) {
+    ge_data.p = k % (Nx2 + 1);
+    ge_data.q = k / (Nx2 + 1);
+
+    local[k] = dblquad_cubature(ge_integrand,
+                                -dx / 2, dx / 2,
+                                -dy / 2, dy / 2,
+                                1.0e-8, &ge_data);
+  }
+
+  GlobalSum(com, local.data(), result.data(), N);
+
+  return result;
+}
+
+/*!
+ * Read the elastic load response from `filename`.
+ *
+ * Returns false if the file does not exist, does not contain the load response, or if it
+ * was computed using different grid parameters.
+ */
+static bool read_load_response(MPI_Comm com, const std::string &filename,
+                               double dx, double dy, int Nx, int Ny,
+                               std::vector<double> &result) {
+  if (not file_exists(com, filename)) {
+    return false;
+  }
+
+  File file(com, filename, PISM_NETCDF3, PISM_READONLY);
+
+  if (not file.find_variable(load_response_name)) {
+    return false;
+  }
+
+  const double
+    eps         = 1e-12,
+    key[]       = {dx, dy, (double)Nx, (double)Ny};
+  const char *key_names[] = {"dx", "dy", "Nx", "Ny"};
+
+  for (int k = 0; k < 4; ++k) {
+    auto value = file.read_double_attribute(load_response_name, key_names[k]);
+
+    if (value.size() != 1 or std::abs(value[0] - key[k]) > eps * std::abs(key[k])) {
+      return false;
+    }
+  }
+
+  const unsigned int
+    Nx2 = Nx / 2,
+    Ny2 = Ny / 2;
+
+  result.resize((Nx2 + 1) * (Ny2 + 1));
+  file.read_variable(load_response_name, {0, 0}, {Ny2 + 1, Nx2 + 1}, result.data());
+
+  return true;
+}
+
+/*!
+ * Save the elastic load response to `filename`, overwriting it.
+ */
+static void write_load_response(MPI_Comm com, const std::string &filename,
+                                double dx, double dy, int Nx, int Ny,
+                                const std::vector<double> &load_response) {
+  const unsigned int
+    Nx2 = Nx / 2,
+    Ny2 = Ny / 2;
+
+  File file(com, filename, PISM_NETCDF3, PISM_READWRITE_CLOBBER);
+
+  file.define_dimension("p", Nx2 + 1);
+  file.define_dimension("q", Ny2 + 1);
+  file.define_variable(load_response_name, PISM_DOUBLE, {"q", "p"});
+
+  file.write_attribute(load_response_name, "long_name",
+                       "elastic load response of the Lingle-Clark bed deformation model "
+                       "(Green's function of [Farrell] integrated over grid cells)");
+  file.write_attribute(load_response_name, "dx", PISM_DOUBLE, {dx});
+  file.write_attribute(load_response_name, "dy", PISM_DOUBLE, {dy});
+  file.write_attribute(load_response_name, "Nx", PISM_DOUBLE, {(double)Nx});
+  file.write_attribute(load_response_name, "Ny", PISM_DOUBLE, {(double)Ny});
+
+  file.write_variable(load_response_name, {0, 0}, {Ny2 + 1, Nx2 + 1}, load_response.data());
+}
+
+/*!
+ * Get the part of the elastic load response matrix on the `Nx*Ny` extended grid that is
+ * not determined by symmetry (the matrix is symmetric about `(Nx / 2, Ny / 2)`).
+ *
+ * Computing it is expensive, so it is read from `bed_deformation.lc.elastic_load_response_file`
+ * if this file exists and was created using the same grid parameters. Otherwise the load
+ * response is computed in parallel and saved to this file (if set).
+ */
+std::vector<double> LingleClark::elastic_load_response(int Nx, int Ny) const {
+  const std::string
+    filename = m_config->get_string("bed_deformation.lc.elastic_load_response_file");
+
+  const double
+    dx = m_grid->dx(),
+    dy = m_grid->dy();
+
+  std::vector<double> result;
+
+  if (not filename.empty() and
+      read_load_response(m_grid->com, filename, dx, dy, Nx, Ny, result)) {
+    m_log->message(2, "     read spherical elastic load response matrix from '%s'\n",
+                   filename.c_str());
+    return result;
+  }
+
+  m_log->message(2, "     computing spherical elastic load response matrix ...");
+  result = compute_load_response(m_grid->com, dx, dy, Nx / 2, Ny / 2);
+  m_log->message(2, " done\n");
+
+  if (not filename.empty()) {
+    write_load_response(m_grid->com, filename, dx, dy, Nx, Ny, result);
+    m_log->message(2, "     saved spherical elastic load response matrix to '%s'\n",
+                   filename.c_str());
+  }
+
+  return result;
+}
+
 LingleClark::LingleClark(IceGrid::ConstPtr grid)
   : BedDef(grid),
     m_total_displacement(m_grid, "bed_displacement", WITHOUT_GHOSTS),
     m_relief(m_grid, "bed_relief", WITHOUT_GHOSTS),
     m_load_thickness(grid, "load_thickness", WITHOUT_GHOSTS),
-    m_elastic_displacement(grid, "elastic_bed_displacement", WITHOUT_GHOSTS) {
+    m_elastic_displacement(grid, "elastic_bed_displacement", WITHOUT_GHOSTS),
+    m_load_last(grid, "load_thickness_last", WITHOUT_GHOSTS) {
 
   m_time_name = m_config->get_string("time.dimension_name") + "_lingle_clark";
   m_t_last = m_grid->ctx()->time()->current();
@@ -50,6 +203,16 @@ LingleClark::LingleClark(IceGrid::ConstPtr grid)
                                   m_update_interval);
   }
 
+  m_load_change_tolerance = m_config->get_number("bed_deformation.lc.load_change_tolerance");
+  m_max_update_interval   = m_config->get_number("bed_deformation.lc.max_update_interval",
+                                                 "seconds");
+  m_skipped_updates       = 0;
+  m_error_bound           = 0.0;
+
+  m_load_last.set_attrs("internal",
+                        "load thickness used during the last bed deformation update",
+                        "meters", "meters", "", 0);
+
   // A work vector. This storage is used to put thickness change on rank 0 and to get the plate
   // displacement change back.
   m_total_displacement.set_attrs("internal",
@@ -57,7 +220,11 @@ LingleClark::LingleClark(IceGrid::ConstPtr grid)
                                  "in the Lingle-Clark bed deformation model",
                                  "meters", "meters", "", 0);
 
-  m_work0 = m_total_displacement.allocate_proc0_copy();
+  const bool parallel = m_config->get_string("bed_deformation.lc.fft") == "parallel";
+
+  if (not parallel) {
+    m_work0 = m_total_displacement.allocate_proc0_copy();
+  }
 
   m_relief.set_attrs("internal",
                      "bed relief relative to the modeled bed displacement",
@@ -69,7 +236,9 @@ LingleClark::LingleClark(IceGrid::ConstPtr grid)
                                    "elastic part of the displacement in the "
                                    "Lingle-Clark bed deformation model; "
                                    "see :cite:`BLKfastearth`", "meters", "meters", "", 0);
-  m_elastic_displacement0 = m_elastic_displacement.allocate_proc0_copy();
+  if (not parallel) {
+    m_elastic_displacement0 = m_elastic_displacement.allocate_proc0_copy();
+  }
 
   const int
     Mx = m_grid->Mx(),
@@ -102,6 +271,17 @@ LingleClark::LingleClark(IceGrid::ConstPtr grid)
   // do not point to auxiliary coordinates "lon" and "lat".
   m_viscous_displacement.metadata().set_string("coordinates", "");
 
+  std::vector<double> load_response;
+  if (use_elastic_model) {
+    load_response = elastic_load_response(Nx, Ny);
+  }
+
+  if (parallel) {
+    m_parallel_model.reset(new LingleClarkParallel(m_grid, m_extended_grid,
+                                                   use_elastic_model, load_response));
+    return;
+  }
+
   m_viscous_displacement0 = m_viscous_displacement.allocate_proc0_copy();
 
   ParallelSection rank0(m_grid->com);
@@ -110,7 +290,7 @@ LingleClark::LingleClark(IceGrid::ConstPtr grid)
       m_serial_model.reset(new LingleClarkSerial(m_log, *m_config, use_elastic_model,
                                                  Mx, My,
                                                  m_grid->dx(), m_grid->dy(),
-                                                 Nx, Ny));
+                                                 Nx, Ny, load_response));
     }
   } catch (...) {
     rank0.failed();
@@ -141,6 +321,19 @@ void LingleClark::bootstrap_impl(const IceModelVec2S &bed_elevation,
 
   compute_load(bed_elevation, ice_thickness, sea_level_elevation,
                m_load_thickness);
+  m_load_last.copy_from(m_load_thickness);
+
+  if (m_parallel_model) {
+    m_parallel_model->bootstrap(m_load_thickness, bed_uplift);
+
+    m_parallel_model->get_viscous_displacement(m_viscous_displacement);
+    m_parallel_model->get_elastic_displacement(m_elastic_displacement);
+    m_parallel_model->get_total_displacement(m_total_displacement);
+
+    // compute bed relief
+    m_topg.add(-1.0, m_total_displacement, m_relief);
+    return;
+  }
 
   petsc::Vec::Ptr thickness0 = m_load_thickness.allocate_proc0_copy();
 
@@ -189,6 +382,11 @@ void LingleClark::bootstrap_impl(const IceModelVec2S &bed_elevation,
 IceModelVec2S::Ptr LingleClark::elastic_load_response_matrix() const {
   IceModelVec2S::Ptr result(new IceModelVec2S(m_extended_grid, "lrm", WITHOUT_GHOSTS));
 
+  if (m_parallel_model) {
+    m_parallel_model->compute_load_response_matrix(*result);
+    return result;
+  }
+
   int
     Nx = m_extended_grid->Mx(),
     Ny = m_extended_grid->My();
@@ -265,10 +463,14 @@ void LingleClark::init_impl(const InputOptions &opts, const IceModelVec2S &ice_t
 
   compute_load(m_topg, ice_thickness, sea_level_elevation,
                m_load_thickness);
+  m_load_last.copy_from(m_load_thickness);
 
   // Now that viscous displacement and elastic displacement are finally initialized,
   // put them on rank 0 and initialize the serial model itself.
-  {
+  if (m_parallel_model) {
+    m_parallel_model->init(m_viscous_displacement, m_elastic_displacement);
+    m_parallel_model->get_total_displacement(m_total_displacement);
+  } else {
     m_viscous_displacement.put_on_proc0(*m_viscous_displacement0);
     m_elastic_displacement.put_on_proc0(*m_work0);
 
@@ -286,9 +488,9 @@ void LingleClark::init_impl(const InputOptions &opts, const IceModelVec2S &ice_t
       rank0.failed();
     }
     rank0.check();
-  }
 
-  m_total_displacement.get_from_proc0(*m_work0);
+    m_total_displacement.get_from_proc0(*m_work0);
+  }
 
   // compute bed relief
   m_topg.add(-1.0, m_total_displacement, m_relief);
@@ -343,6 +545,38 @@ void LingleClark::step(const IceModelVec2S &ice_thickness,
   compute_load(m_topg, ice_thickness, sea_level_elevation,
                m_load_thickness);
 
+  if (m_parallel_model) {
+    m_parallel_model->step(dt, m_load_thickness);
+
+    m_parallel_model->get_viscous_displacement(m_viscous_displacement);
+    m_parallel_model->get_elastic_displacement(m_elastic_displacement);
+    m_parallel_model->get_total_displacement(m_total_displacement);
+  } else {
+    step_serial(dt);
+  }
+
+  // Update bed elevation using bed displacement and relief.
+  {
+    m_total_displacement.add(1.0, m_relief, m_topg);
+    // Increment the topg state counter. SIAFD relies on this!
+    m_topg.inc_state_counter();
+  }
+
+  //! Finally, we need to update bed uplift and topg_last.
+  compute_uplift(m_topg, m_topg_last, dt, m_uplift);
+  m_topg_last.copy_from(m_topg);
+
+  m_load_last.copy_from(m_load_thickness);
+  m_skipped_updates = 0;
+  m_error_bound     = 0.0;
+}
+
+/*!
+ * Take a step of the serial model using the load in m_load_thickness.
+ *
+ * Sets m_viscous_displacement, m_elastic_displacement, and m_total_displacement.
+ */
+void LingleClark::step_serial(double dt) {
   m_load_thickness.put_on_proc0(*m_work0);
 
   ParallelSection rank0(m_grid->com);
@@ -371,17 +605,6 @@ void LingleClark::step(const IceModelVec2S &ice_thickness,
   m_elastic_displacement.get_from_proc0(*m_elastic_displacement0);
 
   m_total_displacement.get_from_proc0(*m_work0);
-
-  // Update bed elevation using bed displacement and relief.
-  {
-    m_total_displacement.add(1.0, m_relief, m_topg);
-    // Increment the topg state counter. SIAFD relies on this!
-    m_topg.inc_state_counter();
-  }
-
-  //! Finally, we need to update bed uplift and topg_last.
-  compute_uplift(m_topg, m_topg_last, dt, m_uplift);
-  m_topg_last.copy_from(m_topg);
 }
 
 //! Update the Lingle-Clark bed deformation model.
@@ -397,13 +620,100 @@ void LingleClark::update_impl(const IceModelVec2S &ice_thickness,
     throw RuntimeError(PISM_ERROR_LOCATION, "cannot go back in time");
   }
 
+  if (m_load_change_tolerance > 0.0) {
+    // In the adaptive mode updates may be skipped, so the current update time is
+    // m_t_last + k * m_update_interval for some k >= 1.
+    const double k = std::max(std::round((t_final - m_t_last) / m_update_interval), 1.0);
+    t_next = m_t_last + k * m_update_interval;
+  }
+
   if (std::abs(t_next - t_final) < m_t_eps) { // reached the next update time
     double dt_beddef = t_final - m_t_last;
+
+    if (m_load_change_tolerance > 0.0 and dt_beddef < m_max_update_interval - m_t_eps and
+        not update_needed(ice_thickness, sea_level_elevation, dt_beddef)) {
+      return;
+    }
+
     step(ice_thickness, sea_level_elevation, dt_beddef);
     m_t_last = t_final;
   }
 }
 
+/*!
+ * Returns true if the load changed enough since the last update to require a new one.
+ *
+ * The load change is measured using the root mean square of the change in the
+ * (ice-equivalent) load thickness.
+ *
+ * If the update is skipped, estimates the error in the bed elevation as the sum of
+ *
+ * - the displacement the bed would have had if it continued to move at the rate computed
+ *   during the last update (`elapsed_time` seconds ago), and
+ * - the isostatic equilibrium response to the maximum load change.
+ */
+bool LingleClark::update_needed(const IceModelVec2S &ice_thickness,
+                                const IceModelVec2S &sea_level_elevation,
+                                double elapsed_time) {
+  compute_load(m_topg, ice_thickness, sea_level_elevation,
+               m_load_thickness);
+
+  double
+    sum_squares     = 0.0,
+    max_load_change = 0.0;
+  {
+    IceModelVec::AccessList list{&m_load_thickness, &m_load_last};
+
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      const double change = m_load_thickness(i, j) - m_load_last(i, j);
+
+      sum_squares     += change * change;
+      max_load_change  = std::max(max_load_change, std::abs(change));
+    }
+
+    sum_squares     = GlobalSum(m_grid->com, sum_squares);
+    max_load_change = GlobalMax(m_grid->com, max_load_change);
+  }
+
+  const double load_change = std::sqrt(sum_squares / (m_grid->Mx() * m_grid->My()));
+
+  if (load_change >= m_load_change_tolerance) {
+    return true;
+  }
+
+  const double
+    ice_density    = m_config->get_number("constants.ice.density"),
+    mantle_density = m_config->get_number("bed_deformation.mantle_density"),
+    max_uplift     = m_uplift.norm(NORM_INFINITY);
+
+  m_skipped_updates += 1;
+  m_error_bound = (max_uplift * elapsed_time +
+                   (ice_density / mantle_density) * max_load_change);
+
+  m_log->message(3,
+                 "  Lingle-Clark: skipped an update (RMS load change %.3f m,"
+                 " bed elevation error bound %.3f m)\n",
+                 load_change, m_error_bound);
+
+  return false;
+}
+
+/*!
+ * Number of updates skipped (in the adaptive mode) since the last update.
+ */
+unsigned int LingleClark::skipped_updates() const {
+  return m_skipped_updates;
+}
+
+/*!
+ * Estimate of the bed elevation error (in meters) due to skipped updates.
+ */
+double LingleClark::error_bound() const {
+  return m_error_bound;
+}
+
 void LingleClark::define_model_state_impl(const File &output) const {
   BedDef::define_model_state_impl(output);
   m_viscous_displacement.define(output);
@@ -428,6 +738,53 @@ void LingleClark::write_model_state_impl(const File &output) const {
   output.write_variable(m_time_name, {0}, {1}, &m_t_last);
 }
 
+/*! @brief Number of Lingle-Clark model updates skipped since the last one. */
+class SkippedUpdates : public TSDiag<TSSnapshotDiagnostic, LingleClark> {
+public:
+  SkippedUpdates(const LingleClark *m)
+    : TSDiag<TSSnapshotDiagnostic, LingleClark>(m, "lc_skipped_updates") {
+
+    set_units("1", "1");
+    m_ts.variable().set_string("long_name",
+                               "number of Lingle-Clark bed deformation model updates"
+                               " skipped because the load did not change enough");
+    m_ts.variable().set_number("valid_min", 0.0);
+  }
+protected:
+  double compute() {
+    return model->skipped_updates();
+  }
+};
+
+/*! @brief Estimate of the bed elevation error due to skipped updates. */
+class ErrorBound : public TSDiag<TSSnapshotDiagnostic, LingleClark> {
+public:
+  ErrorBound(const LingleClark *m)
+    : TSDiag<TSSnapshotDiagnostic, LingleClark>(m, "lc_error_bound") {
+
+    set_units("m", "m");
+    m_ts.variable().set_string("long_name",
+                               "estimate of the bed elevation error due to skipped"
+                               " Lingle-Clark bed deformation model updates");
+    m_ts.variable().set_number("valid_min", 0.0);
+  }
+protected:
+  double compute() {
+    return model->error_bound();
+  }
+};
+
+TSDiagnosticList LingleClark::ts_diagnostics_impl() const {
+  TSDiagnosticList result = BedDef::ts_diagnostics_impl();
+
+  if (m_load_change_tolerance > 0.0) {
+    result["lc_skipped_updates"] = TSDiagnostic::Ptr(new SkippedUpdates(this));
+    result["lc_error_bound"]     = TSDiagnostic::Ptr(new ErrorBound(this));
+  }
+
+  return result;
+}
+
 DiagnosticList LingleClark::diagnostics_impl() const {
   DiagnosticList result = {
     {"viscous_bed_displacement", Diagnostic::wrap(m_viscous_displacement)},
@@ -28,6 +28,7 @@ namespace pism {
 namespace bed {
 
 class LingleClarkSerial;
+class LingleClarkParallel;
 
 //! A wrapper class around LingleClarkSerial.
 class LingleClark : public BedDef {
@@ -48,11 +49,16 @@ public:
             double dt);
 
   IceModelVec2S::Ptr elastic_load_response_matrix() const;
+
+  unsigned int skipped_updates() const;
+
+  double error_bound() const;
 protected:
   virtual void define_model_state_impl(const File &output) const;
   virtual void write_model_state_impl(const File &output) const;
 
   DiagnosticList diagnostics_impl() const;
+  TSDiagnosticList ts_diagnostics_impl() const;
 
   MaxTimestep max_timestep_impl(double t) const;
   void init_impl(const InputOptions &opts, const IceModelVec2S &ice_thickness,
@@ -65,11 +71,19 @@ protected:
                    const IceModelVec2S &sea_level_elevation,
                    double t, double dt);
 
+  void step_serial(double dt);
+
+  std::vector<double> elastic_load_response(int Nx, int Ny) const;
+
+  bool update_needed(const IceModelVec2S &ice_thickness,
+                     const IceModelVec2S &sea_level_elevation,
+                     double elapsed_time);
+
   //! Total (viscous and elastic) bed displacement.
   IceModelVec2S m_total_displacement;
 
   //! Storage on rank zero. Used to pass the load to the serial deformation model and get
-  //! bed displacement back.
+  //! bed displacement back. Not allocated if the parallel model is used.
   petsc::Vec::Ptr m_work0;
 
   //! Bed relief relative to the bed displacement.
@@ -81,6 +95,10 @@ protected:
   //! Serial viscoelastic bed deformation model.
   std::unique_ptr<LingleClarkSerial> m_serial_model;
 
+  //! Distributed viscoelastic bed deformation model (used if
+  //! `bed_deformation.lc.fft` is "parallel").
+  std::unique_ptr<LingleClarkParallel> m_parallel_model;
+
   //! extended grid for the viscous plate displacement
   IceGrid::Ptr m_extended_grid;
 
@@ -102,6 +120,17 @@ protected:
   double m_t_eps;
   //! Name of the variable used to store the last update time.
   std::string m_time_name;
+
+  //! Load thickness used during the last update.
+  IceModelVec2S m_load_last;
+  //! RMS load change that triggers an update (zero if updates are not adaptive)
+  double m_load_change_tolerance;
+  //! Maximum interval between updates in the adaptive mode, in seconds
+  double m_max_update_interval;
+  //! Number of updates skipped since the last one
+  unsigned int m_skipped_updates;
+  //! Estimate of the bed elevation error due to skipped updates, in meters
+  double m_error_bound;
 };
 
 } // end of namespace bed
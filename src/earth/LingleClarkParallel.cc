@@ -0,0 +1,718 @@
+// Copyright (C) 2019 PISM Authors
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include <cmath>                // sqrt
+#include <cstdlib>              // std::abs
+#include <cstring>              // memcpy
+#include <algorithm>            // std::max
+#include <fftw3.h>
+#include <gsl/gsl_math.h>       // M_PI
+
+#include "greens.hh"
+#include "LingleClarkParallel.hh"
+
+#include "pism/util/IceGrid.hh"
+#include "pism/util/pism_utilities.hh"
+#include "pism/util/ConfigInterface.hh"
+#include "pism/util/error_handling.hh"
+#include "pism/util/petscwrappers/IS.hh"
+#include "pism/util/fftw_utilities.hh"
+
+namespace pism {
+namespace bed {
+
+/*!
+ * Split `N` rows (or columns) between `size` processes.
+ */
+static void split(int N, int size, std::vector<int> &start, std::vector<int> &count) {
+  start.resize(size);
+  count.resize(size);
+
+  int s = 0;
+  for (int r = 0; r < size; ++r) {
+    count[r] = N / size + (r < N % size ? 1 : 0);
+    start[r] = s;
+    s += count[r];
+  }
+}
+
+/*!
+ * Create a scatter from a field on a PISM grid to the array of size `Nx*Ny` (distributed
+ * by rows, `j_count` rows starting at `j_start` on this process), placing the field at
+ * `(i_offset, j_offset)`.
+ */
+static void create_scatter(IceModelVec2S &field, Vec slabs,
+                           int Nx, int j_start, int j_count,
+                           int i_offset, int j_offset,
+                           petsc::VecScatter &result) {
+  PetscErrorCode ierr = 0;
+
+  const int
+    Mx = field.grid()->Mx(),
+    My = field.grid()->My();
+
+  std::vector<PetscInt> from, to;
+  for (int j = j_start; j < j_start + j_count; ++j) {
+    const int jj = j - j_offset;
+
+    if (jj < 0 or jj >= My) {
+      continue;
+    }
+
+    for (int i = 0; i < Mx; ++i) {
+      from.push_back(jj * Mx + i);
+      to.push_back(j * Nx + i + i_offset);
+    }
+  }
+
+  // convert from the natural ordering to the PETSc ordering
+  AO ao;
+  ierr = DMDAGetAO(*field.dm(), &ao);
+  PISM_CHK(ierr, "DMDAGetAO");
+
+  ierr = AOApplicationToPetsc(ao, from.size(), from.data());
+  PISM_CHK(ierr, "AOApplicationToPetsc");
+
+  petsc::IS is_from, is_to;
+  ierr = ISCreateGeneral(PETSC_COMM_SELF, from.size(), from.data(), PETSC_COPY_VALUES,
+                         is_from.rawptr());
+  PISM_CHK(ierr, "ISCreateGeneral");
+
+  ierr = ISCreateGeneral(PETSC_COMM_SELF, to.size(), to.data(), PETSC_COPY_VALUES,
+                         is_to.rawptr());
+  PISM_CHK(ierr, "ISCreateGeneral");
+
+  ierr = VecScatterCreate(field.vec(), is_from, slabs, is_to, result.rawptr());
+  PISM_CHK(ierr, "VecScatterCreate");
+}
+
+static void scatter(VecScatter s, Vec from, Vec to, ScatterMode mode) {
+  PetscErrorCode ierr = 0;
+
+  ierr = VecScatterBegin(s, from, to, INSERT_VALUES, mode);
+  PISM_CHK(ierr, "VecScatterBegin");
+
+  ierr = VecScatterEnd(s, from, to, INSERT_VALUES, mode);
+  PISM_CHK(ierr, "VecScatterEnd");
+}
+
+/*!
+ * Create a plan computing `howmany` 1D transforms of length `N` of contiguous sequences
+ * stored in `array`.
+ *
+ * Returns NULL if `howmany` is zero.
+ */
+static fftw_plan plan_1d(int N, int howmany, fftw_complex *array, int sign) {
+  if (howmany == 0) {
+    return NULL;
+  }
+
+  return fftw_plan_many_dft(1, &N, howmany,
+                            array, NULL, 1, N,
+                            array, NULL, 1, N,
+                            sign, FFTW_ESTIMATE);
+}
+
+static void execute(fftw_plan plan) {
+  if (plan != NULL) {
+    fftw_execute(plan);
+  }
+}
+
+/*!
+ * @param[in] grid PISM's grid
+ * @param[in] extended_grid extended grid used by the viscous model
+ * @param[in] include_elastic include elastic deformation component
+ * @param[in] load_response elastic load response (used if include_elastic is true)
+ */
+LingleClarkParallel::LingleClarkParallel(IceGrid::ConstPtr grid,
+                                         IceGrid::ConstPtr extended_grid,
+                                         bool include_elastic,
+                                         const std::vector<double> &load_response)
+  : m_grid(grid),
+    m_load_response(load_response),
+    m_Ue(grid, "elastic_displacement", WITHOUT_GHOSTS),
+    m_U(grid, "total_displacement", WITHOUT_GHOSTS),
+    m_input(grid, "input", WITHOUT_GHOSTS),
+    m_input_extended(extended_grid, "input", WITHOUT_GHOSTS),
+    m_log(grid->ctx()->log()) {
+
+  const Config &config = *grid->ctx()->config();
+
+  m_include_elastic = include_elastic;
+
+  if (include_elastic) {
+    // see LingleClarkSerial::LingleClarkSerial()
+    if (config.get_number("bed_deformation.lc.grid_size_factor") < 2) {
+      throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                    "bed_deformation.lc.elastic_model"
+                                    " requires bed_deformation.lc.grid_size_factor > 1");
+    }
+  }
+
+  // grid parameters
+  m_Mx = grid->Mx();
+  m_My = grid->My();
+  m_dx = grid->dx();
+  m_dy = grid->dy();
+  m_Nx = extended_grid->Mx();
+  m_Ny = extended_grid->My();
+
+  m_load_density   = config.get_number("constants.ice.density");
+  m_mantle_density = config.get_number("bed_deformation.mantle_density");
+  m_eta            = config.get_number("bed_deformation.mantle_viscosity");
+  m_D              = config.get_number("bed_deformation.lithosphere_flexural_rigidity");
+
+  m_standard_gravity = config.get_number("constants.standard_gravity");
+
+  // derive more parameters
+  m_Lx        = 0.5 * (m_Nx - 1.0) * m_dx;
+  m_Ly        = 0.5 * (m_Ny - 1.0) * m_dy;
+  m_i0_offset = (m_Nx - m_Mx) / 2;
+  m_j0_offset = (m_Ny - m_My) / 2;
+
+  // slab decomposition
+  {
+    const int
+      rank = grid->rank(),
+      size = grid->size();
+
+    split(m_Ny, size, m_row_start, m_row_count);
+    split(m_Nx, size, m_column_start, m_column_count);
+
+    m_j0 = m_row_start[rank];
+    m_nj = m_row_count[rank];
+    m_i0 = m_column_start[rank];
+    m_ni = m_column_count[rank];
+  }
+
+  PetscErrorCode ierr = 0;
+
+  // viscous displacement
+  ierr = VecCreateMPI(grid->com, m_nj * m_Nx, m_Nx * m_Ny, m_Uv.rawptr());
+  PISM_CHK(ierr, "VecCreateMPI");
+
+  ierr = VecDuplicate(m_Uv, m_work.rawptr());
+  PISM_CHK(ierr, "VecDuplicate");
+
+  create_scatter(m_input, m_work, m_Nx, m_j0, m_nj, m_i0_offset, m_j0_offset,
+                 m_scatter_middle);
+  if (m_include_elastic) {
+    // the elastic model needs an extended grid at least twice the size of the physical
+    // one (see above), so both of these fit
+    create_scatter(m_input, m_work, m_Nx, m_j0, m_nj, 0, 0,
+                   m_scatter_corner);
+    create_scatter(m_input, m_work, m_Nx, m_j0, m_nj, m_Nx / 2, m_Ny / 2,
+                   m_scatter_elastic);
+  }
+  create_scatter(m_input_extended, m_work, m_Nx, m_j0, m_nj, 0, 0,
+                 m_scatter_extended);
+
+  // FFTW storage: a process stores m_nj rows of length m_Nx in the physical space and
+  // m_ni columns of length m_Ny in the Fourier space.
+  {
+    const int
+      N        = std::max(std::max(m_nj * m_Nx, m_ni * m_Ny), 1),
+      N_column = std::max(m_ni * m_Ny, 1);
+
+    m_fftw_array = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * N);
+    m_send       = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * N);
+    m_receive    = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * N);
+    m_loadhat    = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * N_column);
+    m_lrm_hat    = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * N_column);
+
+    clear_fftw_array(m_fftw_array, 1, N);
+  }
+
+  m_rows_forward    = plan_1d(m_Nx, m_nj, m_fftw_array, FFTW_FORWARD);
+  m_rows_inverse    = plan_1d(m_Nx, m_nj, m_fftw_array, FFTW_BACKWARD);
+  m_columns_forward = plan_1d(m_Ny, m_ni, m_fftw_array, FFTW_FORWARD);
+  m_columns_inverse = plan_1d(m_Ny, m_ni, m_fftw_array, FFTW_BACKWARD);
+
+  // See the note about FFTW error handling in LingleClarkSerial::LingleClarkSerial().
+
+  precompute_coefficients();
+}
+
+LingleClarkParallel::~LingleClarkParallel() {
+  fftw_plan plans[] = {m_rows_forward, m_rows_inverse, m_columns_forward, m_columns_inverse};
+  for (auto p : plans) {
+    if (p != NULL) {
+      fftw_destroy_plan(p);
+    }
+  }
+  fftw_free(m_fftw_array);
+  fftw_free(m_send);
+  fftw_free(m_receive);
+  fftw_free(m_loadhat);
+  fftw_free(m_lrm_hat);
+}
+
+/*!
+ * Get total displacement.
+ */
+void LingleClarkParallel::get_total_displacement(IceModelVec2S &result) const {
+  result.copy_from(m_U);
+}
+
+/*!
+ * Get viscous plate displacement on the extended grid.
+ */
+void LingleClarkParallel::get_viscous_displacement(IceModelVec2S &result) const {
+  scatter(m_scatter_extended, m_Uv, result.vec(), SCATTER_REVERSE);
+}
+
+/*!
+ * Get elastic plate displacement.
+ */
+void LingleClarkParallel::get_elastic_displacement(IceModelVec2S &result) const {
+  result.copy_from(m_Ue);
+}
+
+/*!
+ * Transpose data in `m_fftw_array` from rows (`forward == true`) to columns and back.
+ *
+ * In the row layout the element `(i, j)` is stored at `(j - m_j0) * m_Nx + i`, in the
+ * column layout at `(i - m_i0) * m_Ny + j`.
+ */
+void LingleClarkParallel::transpose(bool forward) {
+  const int size = m_grid->size();
+
+  std::vector<int>
+    send_counts(size), send_displacements(size),
+    receive_counts(size), receive_displacements(size);
+
+  std::complex<double>
+    *array   = reinterpret_cast<std::complex<double>*>(m_fftw_array),
+    *send    = reinterpret_cast<std::complex<double>*>(m_send),
+    *receive = reinterpret_cast<std::complex<double>*>(m_receive);
+
+  // pack
+  int offset = 0;
+  for (int r = 0; r < size; ++r) {
+    send_displacements[r] = 2 * offset;
+
+    if (forward) {
+      // send the part of rows we own that falls into columns owned by r
+      for (int jj = 0; jj < m_nj; ++jj) {
+        for (int ii = 0; ii < m_column_count[r]; ++ii) {
+          send[offset++] = array[jj * m_Nx + m_column_start[r] + ii];
+        }
+      }
+      receive_counts[r] = 2 * m_row_count[r] * m_ni;
+    } else {
+      // send the part of columns we own that falls into rows owned by r
+      for (int ii = 0; ii < m_ni; ++ii) {
+        for (int jj = 0; jj < m_row_count[r]; ++jj) {
+          send[offset++] = array[ii * m_Ny + m_row_start[r] + jj];
+        }
+      }
+      receive_counts[r] = 2 * m_column_count[r] * m_nj;
+    }
+
+    // counts and displacements are in doubles
+    send_counts[r] = 2 * offset - send_displacements[r];
+  }
+
+  offset = 0;
+  for (int r = 0; r < size; ++r) {
+    receive_displacements[r] = offset;
+    offset += receive_counts[r];
+  }
+
+  MPI_Alltoallv(m_send, send_counts.data(), send_displacements.data(), MPI_DOUBLE,
+                m_receive, receive_counts.data(), receive_displacements.data(), MPI_DOUBLE,
+                m_grid->com);
+
+  // unpack
+  offset = 0;
+  for (int r = 0; r < size; ++r) {
+    if (forward) {
+      for (int jj = 0; jj < m_row_count[r]; ++jj) {
+        for (int ii = 0; ii < m_ni; ++ii) {
+          array[ii * m_Ny + m_row_start[r] + jj] = receive[offset++];
+        }
+      }
+    } else {
+      for (int ii = 0; ii < m_column_count[r]; ++ii) {
+        for (int jj = 0; jj < m_nj; ++jj) {
+          array[jj * m_Nx + m_column_start[r] + ii] = receive[offset++];
+        }
+      }
+    }
+  }
+}
+
+/*!
+ * Compute the 2D DFT of `m_fftw_array`. The input uses the row layout, the output the
+ * column layout.
+ */
+void LingleClarkParallel::fft_forward() {
+  execute(m_rows_forward);
+  transpose(true);
+  execute(m_columns_forward);
+}
+
+/*!
+ * Compute the (un-normalized) inverse 2D DFT of `m_fftw_array`. The input uses the
+ * column layout, the output the row layout.
+ */
+void LingleClarkParallel::fft_inverse() {
+  execute(m_columns_inverse);
+  transpose(false);
+  execute(m_rows_inverse);
+}
+
+/*!
+ * Set the real part of `m_fftw_array` to `input` (an array on the extended grid,
+ * distributed by rows) times `normalization` and the imaginary part to zero.
+ */
+void LingleClarkParallel::set_real_part(Vec input, double normalization) {
+  petsc::VecArray in(input);
+  const double *x = in.get();
+
+  for (int k = 0; k < m_nj * m_Nx; ++k) {
+    m_fftw_array[k][0] = x[k] * normalization;
+    m_fftw_array[k][1] = 0.0;
+  }
+}
+
+/*!
+ * Get the real part of `m_fftw_array`, multiply it by `normalization` and put it in
+ * `output`.
+ */
+void LingleClarkParallel::get_real_part(double normalization, Vec output) {
+  petsc::VecArray out(output);
+  double *y = out.get();
+
+  for (int k = 0; k < m_nj * m_Nx; ++k) {
+    y[k] = m_fftw_array[k][0] * normalization;
+  }
+}
+
+/*!
+ * Put `input` on the extended grid `output` (setting the rest of it to zero) using
+ * `scatter`.
+ */
+void LingleClarkParallel::embed(const IceModelVec2S &input, VecScatter s, Vec output) {
+  PetscErrorCode ierr = VecSet(output, 0.0); PISM_CHK(ierr, "VecSet");
+
+  m_input.copy_from(input);
+
+  scatter(s, m_input.vec(), output, SCATTER_FORWARD);
+}
+
+/*!
+ * Compute the load response matrix in `m_fftw_array` (row layout).
+ *
+ * See LingleClarkSerial::compute_load_response_matrix().
+ */
+void LingleClarkParallel::fill_load_response_matrix() {
+
+  const int
+    Nx2 = m_Nx / 2,
+    Ny2 = m_Ny / 2;
+
+  if (m_load_response.size() != (size_t)((Nx2 + 1) * (Ny2 + 1))) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "load response has %d elements (expected %d)",
+                                  (int)m_load_response.size(), (Nx2 + 1) * (Ny2 + 1));
+  }
+
+  FFTWArray LRM(m_fftw_array, m_nj, m_Nx);
+
+  for (int jj = 0; jj < m_nj; ++jj) {
+    const int q = std::abs(Ny2 - (m_j0 + jj));
+    for (int i = 0; i < m_Nx; ++i) {
+      const int p = std::abs(Nx2 - i);
+
+      LRM(jj, i) = m_load_response[q * (Nx2 + 1) + p];
+    }
+  }
+}
+
+/*!
+ * Compute the load response matrix on the extended grid.
+ *
+ * This method is used for testing only.
+ */
+void LingleClarkParallel::compute_load_response_matrix(IceModelVec2S &result) {
+  fill_load_response_matrix();
+  get_real_part(1.0, m_work);
+  scatter(m_scatter_extended, m_work, result.vec(), SCATTER_REVERSE);
+}
+
+/**
+ * Pre-compute coefficients used by the model.
+ */
+void LingleClarkParallel::precompute_coefficients() {
+
+  m_cx = fftfreq(m_Nx, m_Lx / (m_Nx * M_PI));
+  m_cy = fftfreq(m_Ny, m_Ly / (m_Ny * M_PI));
+
+  if (m_include_elastic) {
+    fill_load_response_matrix();
+    fft_forward();
+    memcpy(m_lrm_hat, m_fftw_array, m_ni * m_Ny * sizeof(fftw_complex));
+  }
+}
+
+/*!
+ * Solve for the viscous plate displacement, treating the bed uplift as known. Sets
+ * `m_Uv`.
+ *
+ * See LingleClarkSerial::uplift_problem().
+ */
+void LingleClarkParallel::uplift_problem(const IceModelVec2S &load_thickness,
+                                         const IceModelVec2S &bed_uplift) {
+
+  // Compute fft2(-load_density * g * load_thickness)
+  {
+    embed(load_thickness, m_scatter_middle, m_work);
+    set_real_part(m_work, - m_load_density * m_standard_gravity);
+    fft_forward();
+    memcpy(m_loadhat, m_fftw_array, m_ni * m_Ny * sizeof(fftw_complex));
+  }
+
+  // fft2(uplift)
+  {
+    embed(bed_uplift, m_scatter_middle, m_work);
+    set_real_part(m_work, 1.0);
+    fft_forward();
+  }
+
+  {
+    FFTWArray
+      u0_hat(m_fftw_array, m_ni, m_Ny),
+      load_hat(m_loadhat, m_ni, m_Ny);
+
+    for (int ii = 0; ii < m_ni; ii++) {
+      const int i = m_i0 + ii;
+      for (int j = 0; j < m_Ny; j++) {
+        const double
+          C = m_cx[i]*m_cx[i] + m_cy[j]*m_cy[j],
+          A = - 2.0 * m_eta * sqrt(C),
+          B = m_mantle_density * m_standard_gravity + m_D * C * C;
+
+        // on input u0_hat contains fft2(uplift)
+        u0_hat(ii, j) = (load_hat(ii, j) + A * u0_hat(ii, j)) / B;
+      }
+    }
+  }
+
+  fft_inverse();
+  get_real_part(1.0 / (m_Nx * m_Ny), m_Uv);
+
+  tweak(load_thickness, 0.0);
+}
+
+/*!
+ * Initialize using provided load thickness and the bed uplift rate.
+ *
+ * See LingleClarkSerial::bootstrap().
+ */
+void LingleClarkParallel::bootstrap(const IceModelVec2S &thickness,
+                                    const IceModelVec2S &uplift) {
+
+  // compute viscous displacement
+  uplift_problem(thickness, uplift);
+
+  if (m_include_elastic) {
+    compute_elastic_response(thickness);
+  } else {
+    m_Ue.set(0.0);
+  }
+
+  update_displacement();
+}
+
+/*!
+ * Initialize using provided plate displacement.
+ *
+ * @param[in] viscous_displacement initial viscous plate displacement (meters) on the extended grid
+ * @param[in] elastic_displacement initial elastic plate displacement (meters) on the regular grid
+ */
+void LingleClarkParallel::init(const IceModelVec2S &viscous_displacement,
+                               const IceModelVec2S &elastic_displacement) {
+
+  m_input_extended.copy_from(viscous_displacement);
+  scatter(m_scatter_extended, m_input_extended.vec(), m_Uv, SCATTER_FORWARD);
+
+  if (m_include_elastic) {
+    m_Ue.copy_from(elastic_displacement);
+  } else {
+    m_Ue.set(0.0);
+  }
+
+  update_displacement();
+}
+
+/*!
+ * Perform a time step.
+ *
+ * See LingleClarkSerial::step().
+ *
+ * @param[in] dt time step length
+ * @param[in] H load thickness on the physical (Mx*My) grid
+ */
+void LingleClarkParallel::step(double dt, const IceModelVec2S &H) {
+  if (dt > 0.0) {
+    // Compute fft2(-load_density * g * dt * H)
+    {
+      embed(H, m_scatter_middle, m_work);
+      set_real_part(m_work, - m_load_density * m_standard_gravity * dt);
+      fft_forward();
+      memcpy(m_loadhat, m_fftw_array, m_ni * m_Ny * sizeof(fftw_complex));
+    }
+
+    // Compute fft2(u).
+    {
+      set_real_part(m_Uv, 1.0);
+      fft_forward();
+    }
+
+    {
+      FFTWArray
+        u_hat(m_fftw_array, m_ni, m_Ny),
+        load_hat(m_loadhat, m_ni, m_Ny);
+
+      for (int ii = 0; ii < m_ni; ii++) {
+        const int i = m_i0 + ii;
+        for (int j = 0; j < m_Ny; j++) {
+          const double
+            C     = m_cx[i]*m_cx[i] + m_cy[j]*m_cy[j],
+            part1 = 2.0 * m_eta * sqrt(C),
+            part2 = (dt / 2.0) * (m_mantle_density * m_standard_gravity + m_D * C * C),
+            A = part1 - part2,
+            B = part1 + part2;
+
+          u_hat(ii, j) = (load_hat(ii, j) + A * u_hat(ii, j)) / B;
+        }
+      }
+    }
+
+    fft_inverse();
+    get_real_part(1.0 / (m_Nx * m_Ny), m_Uv);
+
+    // Here 1e16 approximates t = \infty.
+    tweak(H, 1e16);
+  } else {
+    // zero time step: viscous displacement is zero
+    PetscErrorCode ierr = VecSet(m_Uv, 0.0); PISM_CHK(ierr, "VecSet");
+  }
+
+  if (m_include_elastic) {
+    compute_elastic_response(H);
+  }
+
+  update_displacement();
+}
+
+/*!
+ * Compute elastic response to the load H. Sets `m_Ue`.
+ *
+ * See LingleClarkSerial::compute_elastic_response().
+ */
+void LingleClarkParallel::compute_elastic_response(const IceModelVec2S &H) {
+
+  // Compute fft2(load_density * H), placing the load in the corner of the extended grid
+  {
+    embed(H, m_scatter_corner, m_work);
+    set_real_part(m_work, m_load_density);
+    fft_forward();
+  }
+
+  {
+    FFTWArray
+      load_hat(m_fftw_array, m_ni, m_Ny),
+      LRM_hat(m_lrm_hat, m_ni, m_Ny);
+
+    for (int ii = 0; ii < m_ni; ii++) {
+      for (int j = 0; j < m_Ny; j++) {
+        load_hat(ii, j) = LRM_hat(ii, j) * load_hat(ii, j);
+      }
+    }
+  }
+
+  fft_inverse();
+  get_real_part(1.0 / (m_Nx * m_Ny), m_work);
+
+  scatter(m_scatter_elastic, m_work, m_Ue.vec(), SCATTER_REVERSE);
+}
+
+/*!
+ * Compute total displacement by combining viscous and elastic contributions.
+ */
+void LingleClarkParallel::update_displacement() {
+  scatter(m_scatter_middle, m_Uv, m_U.vec(), SCATTER_REVERSE);
+  m_U.add(1.0, m_Ue);
+}
+
+/*!
+ * Modify the viscous plate displacement to correct for the effect of imposing periodic
+ * boundary conditions at a finite distance.
+ *
+ * See LingleClarkSerial::tweak().
+ */
+void LingleClarkParallel::tweak(const IceModelVec2S &load_thickness, double time) {
+  PetscErrorCode ierr = 0;
+
+  // sum of values at j == 0 and i == 0
+  double average = 0.0;
+  {
+    petsc::VecArray U(m_Uv);
+    const double *u = U.get();
+
+    if (m_j0 == 0 and m_nj > 0) {
+      for (int i = 0; i < m_Nx; i++) {
+        average += u[i];
+      }
+    }
+
+    for (int jj = 0; jj < m_nj; jj++) {
+      average += u[jj * m_Nx];
+    }
+  }
+  average = GlobalSum(m_grid->com, average) / (double) (m_Nx + m_Ny);
+
+  double shift = 0.0;
+
+  if (time > 0.0) {
+    const double L_average = (m_Lx + m_Ly) / 2.0;
+    const double R         = L_average * (2.0 / 3.0);
+
+    const double H_sum = load_thickness.sum();
+
+    // compute disc thickness by dividing its volume by the area
+    const double H = (H_sum * m_dx * m_dy) / (M_PI * R * R);
+
+    shift = viscDisc(time,               // time in seconds
+                     H,                  // disc thickness
+                     R,                  // disc radius
+                     L_average,          // compute deflection at this radius
+                     m_mantle_density, m_load_density,    // mantle and load densities
+                     m_standard_gravity, //
+                     m_D,                // flexural rigidity
+                     m_eta);             // mantle viscosity
+  }
+
+  ierr = VecShift(m_Uv, shift - average); PISM_CHK(ierr, "VecShift");
+}
+
+} // end of namespace bed
+} // end of namespace pism
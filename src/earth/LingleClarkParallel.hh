@@ -0,0 +1,195 @@
+/* Copyright (C) 2019 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LINGLECLARKPARALLEL_H
+#define LINGLECLARKPARALLEL_H
+
+#include <vector>
+
+#include <fftw3.h>
+
+#include "pism/util/iceModelVec.hh"
+#include "pism/util/petscwrappers/Vec.hh"
+#include "pism/util/petscwrappers/VecScatter.hh"
+#include "pism/util/Logger.hh"
+
+namespace pism {
+namespace bed {
+
+//! Distributed-memory implementation of the Lingle-Clark bed deformation model.
+/*!
+  This class solves the same equations as LingleClarkSerial (which is kept as the
+  reference implementation) without gathering inputs on rank 0.
+
+  The extended (spectral) grid is split into slabs: in the physical space each process
+  owns a range of rows (`j`) of the extended grid, in the Fourier space it owns a range of
+  columns (`i`). A 2D transform is computed as 1D FFTs along rows, a global transpose
+  (`MPI_Alltoallv`) and 1D FFTs along columns. Spectral data (the load, the plate
+  displacement and the elastic load response matrix) are kept in the transposed
+  (column) layout, so a time step needs one transpose for each forward and inverse
+  transform.
+
+  Fields on the PISM grid and the viscous displacement on the extended grid are moved
+  between the PISM domain decomposition and the slab decomposition using PETSc scatters.
+*/
+class LingleClarkParallel {
+public:
+  LingleClarkParallel(IceGrid::ConstPtr grid,
+                      IceGrid::ConstPtr extended_grid,
+                      bool include_elastic,
+                      const std::vector<double> &load_response);
+  ~LingleClarkParallel();
+
+  void init(const IceModelVec2S &viscous_displacement,
+            const IceModelVec2S &elastic_displacement);
+
+  void bootstrap(const IceModelVec2S &thickness, const IceModelVec2S &uplift);
+
+  void step(double dt, const IceModelVec2S &H);
+
+  void get_total_displacement(IceModelVec2S &result) const;
+
+  void get_viscous_displacement(IceModelVec2S &result) const;
+
+  void get_elastic_displacement(IceModelVec2S &result) const;
+
+  void compute_load_response_matrix(IceModelVec2S &result);
+private:
+  void compute_elastic_response(const IceModelVec2S &H);
+
+  void uplift_problem(const IceModelVec2S &load_thickness,
+                      const IceModelVec2S &bed_uplift);
+
+  void precompute_coefficients();
+
+  void update_displacement();
+
+  void tweak(const IceModelVec2S &load_thickness, double time);
+
+  void fill_load_response_matrix();
+
+  void embed(const IceModelVec2S &input, VecScatter scatter, Vec output);
+
+  void set_real_part(Vec input, double normalization);
+  void get_real_part(double normalization, Vec output);
+
+  void fft_forward();
+  void fft_inverse();
+
+  void transpose(bool forward);
+
+  IceGrid::ConstPtr m_grid;
+
+  bool m_include_elastic;
+  // grid size
+  int m_Mx;
+  int m_My;
+  // grid spacing
+  double m_dx;
+  double m_dy;
+  //! load density (for computing load from its thickness)
+  double m_load_density;
+  //! mantle density
+  double m_mantle_density;
+  //! mantle viscosity
+  double m_eta;
+  //! lithosphere flexural rigidity
+  double m_D;
+
+  // acceleration due to gravity
+  double m_standard_gravity;
+
+  // size of the extended grid
+  int m_Nx;
+  int m_Ny;
+
+  // indices into extended grid for the corner of the physical grid
+  int m_i0_offset;
+  int m_j0_offset;
+
+  // half-lengths of the extended (FFT, spectral) computational domain
+  double m_Lx;
+  double m_Ly;
+
+  // Coefficients of derivatives in Fourier space
+  std::vector<double> m_cx, m_cy;
+
+  // the part of the elastic load response matrix that is not determined by symmetry
+  // (see LingleClark::elastic_load_response())
+  std::vector<double> m_load_response;
+
+  // rows of the extended grid (physical space) owned by each process
+  std::vector<int> m_row_start, m_row_count;
+  // columns of the extended grid (Fourier space) owned by each process
+  std::vector<int> m_column_start, m_column_count;
+
+  // this process' slabs
+  int m_j0, m_nj;
+  int m_i0, m_ni;
+
+  // viscous displacement on the extended grid, distributed by rows
+  petsc::Vec m_Uv;
+
+  // work space on the extended grid, distributed by rows
+  petsc::Vec m_work;
+
+  // elastic plate displacement
+  IceModelVec2S m_Ue;
+
+  // total (viscous and elastic) plate displacement
+  IceModelVec2S m_U;
+
+  // copy of an input on the PISM grid (used to get a Vec we can scatter from)
+  IceModelVec2S m_input;
+
+  // copy of an input on the extended grid
+  IceModelVec2S m_input_extended;
+
+  // scatters from the PISM grid to the extended grid; the physical grid is placed
+  // in the middle (used by the viscous model), in the corner (elastic model's input),
+  // and at (m_Nx / 2, m_Ny / 2) (elastic model's output)
+  petsc::VecScatter m_scatter_middle;
+  petsc::VecScatter m_scatter_corner;
+  petsc::VecScatter m_scatter_elastic;
+
+  // scatter from the PISM's decomposition of the extended grid to slabs
+  petsc::VecScatter m_scatter_extended;
+
+  // local FFT input and output (rows in the physical space, columns in the Fourier
+  // space)
+  fftw_complex *m_fftw_array;
+  // transpose buffers
+  fftw_complex *m_send;
+  fftw_complex *m_receive;
+  // Fourier transforms of the load and the load response matrix (column layout)
+  fftw_complex *m_loadhat;
+  fftw_complex *m_lrm_hat;
+
+  fftw_plan m_rows_forward;
+  fftw_plan m_rows_inverse;
+  fftw_plan m_columns_forward;
+  fftw_plan m_columns_inverse;
+
+  Logger::ConstPtr m_log;
+};
+
+} // end of namespace bed
+} // end of namespace pism
+
+#endif /* LINGLECLARKPARALLEL_H */
@@ -18,10 +18,10 @@
 
 #include <cassert>
 #include <cmath>                // sqrt
+#include <cstdlib>              // std::abs
 #include <fftw3.h>
 #include <gsl/gsl_math.h>       // M_PI
 
-#include "matlablike.hh"
 #include "greens.hh"
 #include "LingleClarkSerial.hh"
 
@@ -43,14 +43,16 @@ namespace bed {
  * @param[in] dy grid spacing in the Y direction
  * @param[in] Nx extended grid size in the X direction
  * @param[in] Ny extended grid size in the Y direction
+ * @param[in] load_response elastic load response (used if include_elastic is true)
  */
 LingleClarkSerial::LingleClarkSerial(Logger::ConstPtr log,
                                      const Config &config,
                                      bool include_elastic,
                                      int Mx, int My,
                                      double dx, double dy,
-                                     int Nx, int Ny)
-  : m_log(log) {
+                                     int Nx, int Ny,
+                                     const std::vector<double> &load_response)
+  : m_load_response(load_response), m_log(log) {
 
   // set parameters
   m_include_elastic = include_elastic;
@@ -159,55 +161,24 @@ void LingleClarkSerial::compute_load_response_matrix(fftw_complex *output) {
 
   FFTWArray LRM(output, m_Nx, m_Ny);
 
-  greens_elastic G;
-  ge_data ge_data {m_dx, m_dy, 0, 0, &G};
+  const int
+    Nx2 = m_Nx / 2,
+    Ny2 = m_Ny / 2;
 
-  int Nx2 = m_Nx / 2;
-  int Ny2 = m_Ny / 2;
-
-  // Top half
-  for (int j = 0; j <= Ny2; ++j) {
-    // Top left quarter
-    for (int i = 0; i <= Nx2; ++i) {
-      ge_data.p = Nx2 - i;
-      ge_data.q = Ny2 - j;
-
-      LRM(i, j) = dblquad_cubature(ge_integrand,
-                                   -m_dx / 2, m_dx / 2,
-                                   -m_dy / 2, m_dy / 2,
-                                   1.0e-8, &ge_data);
-    }
-
-    // Top right quarter
-    //
-    // Note: Nx2 = m_Nx / 2 (using integer division!), so
-    //
-    // - If m_Nx is even then 2 * Nx2 == m_Nx. So i < m_Nx implies i < 2 * Nx2 and
-    //   2 * Nx2 - i > 0.
-    //
-    // - If m_Nx is odd then 2 * Nx2 == m_Nx - 1 or m_Nx == 2 * Nx2 + 1. So i < m_Nx
-    //   implies i < 2 * Nx2 + 1, which is the same as 2 * Nx2 - i > -1 or
-    //   2 * Nx2 - i >= 0.
-    //
-    // Also, i == Nx2 + 1 gives 2 * Nx2 - i == Nx2 - 1
-    //
-    // So, in both cases (even and odd) 0 <= 2 * Nx2 - i <= Nx2 - 1.
-    //
-    // This means that LRM(2 * Nx2 - i, j) will not use indexes that are out of bounds
-    // *and* will only use values computed in the for loop above.
-    for (int i = Nx2 + 1; i < m_Nx; ++i) {
-      assert(2 * Nx2 - i >= 0);
-      LRM(i, j) = LRM(2 * Nx2 - i, j);
-    }
-  } // End of the loop over the top half
+  if (m_load_response.size() != (size_t)((Nx2 + 1) * (Ny2 + 1))) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "load response has %d elements (expected %d)",
+                                  (int)m_load_response.size(), (Nx2 + 1) * (Ny2 + 1));
+  }
 
-    // Bottom half
-    //
-    // See the comment above the "top right quarter" loop.
-  for (int j = Ny2 + 1; j < m_Ny; ++j) {
+  // The load response matrix is symmetric about (Nx2, Ny2); m_load_response contains
+  // values corresponding to the distance of (p, q) grid cells from the load.
+  for (int j = 0; j < m_Ny; ++j) {
+    const int q = std::abs(Ny2 - j);
     for (int i = 0; i < m_Nx; ++i) {
-      assert(2 * Ny2 - j >= 0);
-      LRM(i, j) = LRM(i, 2 * Ny2 - j);
+      const int p = std::abs(Nx2 - i);
+
+      LRM(i, j) = m_load_response[q * (Nx2 + 1) + p];
     }
   }
 }
@@ -224,14 +195,10 @@ void LingleClarkSerial::precompute_coefficients() {
 
   // compare geforconv.m
   if (m_include_elastic) {
-    m_log->message(2, "     computing spherical elastic load response matrix ...");
-    {
-      compute_load_response_matrix(m_fftw_input);
-      // Compute fft2(LRM) and save it in m_lrm_hat
-      fftw_execute(m_dft_forward);
-      copy_fftw_array(m_fftw_output, m_lrm_hat, m_Nx, m_Ny);
-    }
-    m_log->message(2, " done\n");
+    compute_load_response_matrix(m_fftw_input);
+    // Compute fft2(LRM) and save it in m_lrm_hat
+    fftw_execute(m_dft_forward);
+    copy_fftw_array(m_fftw_output, m_lrm_hat, m_Nx, m_Ny);
   }
 }
 
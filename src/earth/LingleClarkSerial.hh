@@ -61,7 +61,8 @@ public:
                     bool include_elastic,
                     int Mx, int My,
                     double dx, double dy,
-                    int Nx, int Ny);
+                    int Nx, int Ny,
+                    const std::vector<double> &load_response);
   ~LingleClarkSerial();
 
   void init(Vec viscous_displacement,
@@ -121,6 +122,10 @@ private:
   // Coefficients of derivatives in Fourier space
   std::vector<double> m_cx, m_cy;
 
+  // the part of the elastic load response matrix that is not determined by symmetry
+  // (see LingleClark::elastic_load_response())
+  std::vector<double> m_load_response;
+
   // viscous displacement on the extended grid
   petsc::Vec m_Uv;
 
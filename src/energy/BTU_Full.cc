@@ -79,6 +79,20 @@ BTU_Full::BTU_Full(IceGrid::ConstPtr g, const BTUGrid &grid)
   }
 
   m_column.reset(new BedrockColumn("bedrock_column", *m_config, vertical_spacing(), Mz()));
+
+  {
+    std::string method = m_config->get_string("energy.bedrock_thermal.update_method");
+
+    if (method == "tridiagonal") {
+      m_method = TRIDIAGONAL;
+    } else if (method == "steady_state") {
+      m_method = STEADY_STATE;
+    } else {
+      throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                    "invalid energy.bedrock_thermal.update_method: '%s'",
+                                    method.c_str());
+    }
+  }
 }
 
 BTU_Full::~BTU_Full() {
@@ -91,6 +105,11 @@ void BTU_Full::init_impl(const InputOptions &opts) {
 
   m_log->message(2, "* Initializing the bedrock thermal unit...\n");
 
+  if (m_method == STEADY_STATE) {
+    m_log->message(2,
+                   "  Bedrock temperature is set to the steady state profile during every update.\n");
+  }
+
   // 2D initialization. Takes care of the flux through the bottom surface of the thermal layer.
   BedThermalUnit::init_impl(opts);
 
@@ -178,9 +197,21 @@ void BTU_Full::update_impl(const IceModelVec2S &bedrock_top_temperature,
 
       double *T = m_temp->get_column(i, j);
 
-      m_column->solve(dt, m_bottom_surface_flux(i, j), bedrock_top_temperature(i, j),
-                      T,  // input
-                      T); // output
+      const double
+        Q_bottom = m_bottom_surface_flux(i, j),
+        T_top    = bedrock_top_temperature(i, j);
+
+      switch (m_method) {
+      case STEADY_STATE:
+        m_column->steady_state(Q_bottom, T_top, T);
+        break;
+      default:
+      case TRIDIAGONAL:
+        m_column->solve(dt, Q_bottom, T_top,
+                        T,  // input
+                        T); // output
+        break;
+      }
 
       // Check that T is positive:
       for (unsigned int k = 0; k < m_Mbz; ++k) {
@@ -258,19 +289,13 @@ void BTU_Full::bootstrap(const IceModelVec2S &bedrock_top_temperature) {
                 "  using temperature at the top bedrock surface and geothermal flux\n"
                 "  (bedrock temperature is linear in depth)...\n");
 
-  double dz = this->vertical_spacing();
-  const int k0 = m_Mbz - 1; // Tb[k0] = ice/bedrock interface temp
-
   IceModelVec::AccessList list{&bedrock_top_temperature, &m_bottom_surface_flux, m_temp.get()};
   for (Points p(*m_grid); p; p.next()) {
     const int i = p.i(), j = p.j();
 
     double *Tb = m_temp->get_column(i, j); // Tb points into temp memory
 
-    Tb[k0] = bedrock_top_temperature(i, j);
-    for (int k = k0-1; k >= 0; k--) {
-      Tb[k] = Tb[k+1] + dz * m_bottom_surface_flux(i, j) / m_k;
-    }
+    m_column->steady_state(m_bottom_surface_flux(i, j), bedrock_top_temperature(i, j), Tb);
   }
 
   m_temp->inc_state_counter();     // mark as modified
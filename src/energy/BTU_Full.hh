@@ -123,6 +123,9 @@ protected:
   //! true if the model needs to "bootstrap" the temperature field during the first time step
   bool m_bootstrapping_needed;
 
+  //! method used to update bedrock temperature ("tridiagonal" or "steady_state")
+  enum UpdateMethod {TRIDIAGONAL, STEADY_STATE} m_method;
+
   void update_flux_through_top_surface();
 
   std::shared_ptr<BedrockColumn> m_column;
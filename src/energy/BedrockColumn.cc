@@ -93,6 +93,30 @@ void BedrockColumn::solve(double dt, double Q_bottom, double T_top,
   solve(dt, Q_bottom, T_top, T_old.data(), result.data());
 }
 
+/*!
+ * Compute the steady state temperature profile corresponding to the heat flux `Q_bottom`
+ * through the bottom surface and the temperature `T_top` at the top surface.
+ *
+ * The steady state is linear in depth. It is also the steady state of the discrete system
+ * solved by solve().
+ */
+void BedrockColumn::steady_state(double Q_bottom, double T_top, double *result) const {
+  const unsigned int N = m_M - 1;
+
+  result[N] = T_top;
+  for (int k = (int)N - 1; k >= 0; --k) {
+    result[k] = result[k + 1] + m_dz * Q_bottom / m_k;
+  }
+}
+
+/*!
+ * This version of `steady_state()` is easier to use in Python.
+ */
+void BedrockColumn::steady_state(double Q_bottom, double T_top,
+                                 std::vector<double> &result) const {
+  result.resize(m_M);
+  steady_state(Q_bottom, T_top, result.data());
+}
 
 } // end of namespace energy
 } // end of namespace pism
@@ -49,6 +49,10 @@ public:
              const std::vector<double> &T_old,
              std::vector<double> &result);
 
+  void steady_state(double Q_bottom, double T_top, double *result) const;
+
+  void steady_state(double Q_bottom, double T_top, std::vector<double> &result) const;
+
 private:
   // temperature diffusivity coefficient
   double m_D;
@@ -78,6 +78,8 @@ EnergyModelStats::EnergyModelStats() {
   bulge_counter            = 0;
   reduced_accuracy_counter = 0;
   low_temperature_counter  = 0;
+  skipped_column_counter   = 0;
+  ice_column_counter       = 0;
   liquified_ice_volume     = 0.0;
 }
 
@@ -85,6 +87,8 @@ EnergyModelStats& EnergyModelStats::operator+=(const EnergyModelStats &other) {
   bulge_counter            += other.bulge_counter;
   reduced_accuracy_counter += other.reduced_accuracy_counter;
   low_temperature_counter  += other.low_temperature_counter;
+  skipped_column_counter   += other.skipped_column_counter;
+  ice_column_counter       += other.ice_column_counter;
   liquified_ice_volume     += other.liquified_ice_volume;
   return *this;
 }
@@ -122,6 +126,8 @@ void EnergyModelStats::sum(MPI_Comm com) {
   bulge_counter            = GlobalSum(com, bulge_counter);
   reduced_accuracy_counter = GlobalSum(com, reduced_accuracy_counter);
   low_temperature_counter  = GlobalSum(com, low_temperature_counter);
+  skipped_column_counter   = GlobalSum(com, skipped_column_counter);
+  ice_column_counter       = GlobalSum(com, ice_column_counter);
   liquified_ice_volume     = GlobalSum(com, liquified_ice_volume);
 }
 
@@ -308,6 +314,14 @@ void EnergyModel::update(double t, double dt, const Inputs &inputs) {
       snprintf(buffer, 50, " BULGE=%d ", m_stats.bulge_counter);
       m_stdout_flags = buffer + m_stdout_flags;
     }
+
+    if (m_stats.skipped_column_counter > 0) {
+      // percentage of ice-covered columns skipped by the steady column detection
+      const double skipped_percentage = (100.0 * m_stats.skipped_column_counter /
+                                         std::max(m_stats.ice_column_counter, 1u));
+      snprintf(buffer, 50, " SKIP=%.1f%% ", skipped_percentage);
+      m_stdout_flags = buffer + m_stdout_flags;
+    }
   }
 }
 
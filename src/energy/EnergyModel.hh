@@ -68,6 +68,10 @@ public:
   unsigned int bulge_counter;
   unsigned int reduced_accuracy_counter;
   unsigned int low_temperature_counter;
+  //! number of ice-covered columns skipped because they were in a steady state
+  unsigned int skipped_column_counter;
+  //! number of ice-covered columns
+  unsigned int ice_column_counter;
   double liquified_ice_volume;
 };
 
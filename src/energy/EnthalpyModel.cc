@@ -1,4 +1,4 @@
-/* Copyright (C) 2016, 2017, 2018 PISM Authors
+/* Copyright (C) 2016, 2017, 2018, 2019 PISM Authors
  *
  * This file is part of PISM.
  *
@@ -17,6 +17,9 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <cmath>
+#include <algorithm>
+
 #include "EnthalpyModel.hh"
 
 #include "DrainageCalculator.hh"
@@ -26,6 +29,7 @@
 #include "pism/util/io/File.hh"
 #include "utilities.hh"
 #include "pism/util/pism_utilities.hh"
+#include "pism/util/error_handling.hh"
 
 namespace pism {
 namespace energy {
@@ -33,7 +37,174 @@ namespace energy {
 EnthalpyModel::EnthalpyModel(IceGrid::ConstPtr grid,
                              stressbalance::StressBalance *stress_balance)
   : EnergyModel(grid, stress_balance) {
-  // empty
+
+  const std::string prefix = "energy.enthalpy.steady_column_skipping.";
+
+  m_skip_steady_columns = m_config->get_flag(prefix + "enabled");
+  m_skip_max_interval   = m_config->get_number(prefix + "max_interval");
+
+  m_skip_tolerance.enthalpy        = m_config->get_number(prefix + "enthalpy_tolerance");
+  m_skip_tolerance.surface_temp    = m_config->get_number(prefix + "surface_temperature_tolerance");
+  m_skip_tolerance.basal_heat_flux = m_config->get_number(prefix + "basal_heat_flux_tolerance");
+  m_skip_tolerance.ice_thickness   = m_config->get_number(prefix + "ice_thickness_tolerance");
+  m_skip_tolerance.strain_heating  = m_config->get_number(prefix + "strain_heating_tolerance");
+  m_skip_tolerance.speed           = m_config->get_number(prefix + "speed_tolerance", "m second-1");
+
+  if (m_skip_steady_columns) {
+    if (m_skip_max_interval < 1) {
+      throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                    "%smax_interval = %d is invalid (has to be positive)",
+                                    prefix.c_str(), m_skip_max_interval);
+    }
+
+    m_skip_counter.create(m_grid, "steady_column_skip_counter", WITHOUT_GHOSTS);
+    m_skip_counter.set_attrs("internal",
+                             "number of consecutive energy steps a steady column was skipped",
+                             "", "", "", 0);
+    // all columns have to be updated during the first time step
+    m_skip_counter.set(-1.0);
+
+    m_skip_error.create(m_grid, "steady_column_skip_error", WITHOUT_GHOSTS);
+    m_skip_error.set_attrs("internal",
+                           "estimate of the enthalpy change neglected in skipped steps",
+                           "J kg-1", "J kg-1", "", 0);
+    m_skip_error.set(0.0);
+
+    m_enthalpy_change_rate.create(m_grid, "enthalpy_change_rate", WITHOUT_GHOSTS);
+    m_enthalpy_change_rate.set_attrs("internal",
+                                     "maximum rate of change of enthalpy in a column",
+                                     "J kg-1 s-1", "J kg-1 s-1", "", 0);
+
+    m_last_surface_temp.create(m_grid, "last_surface_temp", WITHOUT_GHOSTS);
+    m_last_surface_temp.set_attrs("internal", "ice surface temperature used by the last update",
+                                  "Kelvin", "Kelvin", "", 0);
+
+    m_last_basal_heat_flux.create(m_grid, "last_basal_heat_flux", WITHOUT_GHOSTS);
+    m_last_basal_heat_flux.set_attrs("internal", "basal heat flux used by the last update",
+                                     "W m-2", "W m-2", "", 0);
+
+    m_last_ice_thickness.create(m_grid, "last_ice_thickness", WITHOUT_GHOSTS);
+    m_last_ice_thickness.set_attrs("internal", "ice thickness used by the last update",
+                                   "m", "m", "", 0);
+
+    m_last_strain_heating.create(m_grid, "last_strain_heating", WITHOUT_GHOSTS);
+    m_last_strain_heating.set_attrs("internal",
+                                    "maximum strain heating in the column used by the last update",
+                                    "W m-3", "W m-3", "", 0);
+
+    m_last_speed.create(m_grid, "last_speed", WITHOUT_GHOSTS);
+    m_last_speed.set_attrs("internal",
+                           "maximum ice speed in the column used by the last update",
+                           "m s-1", "m s-1", "", 0);
+  }
+}
+
+/*!
+ * Compute maximum strain heating and ice speed in the column (i,j), using storage grid levels
+ * within the ice.
+ */
+static void column_forcing(const IceModelVec3 &strain_heating,
+                           const IceModelVec3 &u3,
+                           const IceModelVec3 &v3,
+                           const IceModelVec3 &w3,
+                           int i, int j, unsigned int ks,
+                           double &max_strain_heating,
+                           double &max_speed) {
+  const double
+    *S = strain_heating.get_column(i, j),
+    *u = u3.get_column(i, j),
+    *v = v3.get_column(i, j),
+    *w = w3.get_column(i, j);
+
+  max_strain_heating = 0.0;
+  max_speed          = 0.0;
+  for (unsigned int k = 0; k <= ks; ++k) {
+    max_strain_heating = std::max(max_strain_heating, std::abs(S[k]));
+    max_speed          = std::max(max_speed, sqrt(u[k] * u[k] + v[k] * v[k] + w[k] * w[k]));
+  }
+}
+
+/*!
+ * Return true if the column (i,j) can be skipped during the current time step.
+ *
+ * A column can be skipped if it was cold during the last update, has not been skipped more
+ * than `max_interval` times in a row, the estimate of the neglected enthalpy change stays
+ * below `enthalpy_tolerance`, and forcing has not changed since the last update.
+ */
+bool EnthalpyModel::column_is_steady(int i, int j, double dt, const Inputs &inputs) const {
+
+  const int counter = m_skip_counter.as_int(i, j);
+  if (counter < 0 or counter >= m_skip_max_interval) {
+    return false;
+  }
+
+  if (m_skip_error(i, j) + m_enthalpy_change_rate(i, j) * dt > m_skip_tolerance.enthalpy) {
+    return false;
+  }
+
+  const double
+    H  = (*inputs.ice_thickness)(i, j),
+    Ts = (*inputs.surface_temp)(i, j),
+    Qb = (*inputs.basal_heat_flux)(i, j) + (*inputs.basal_frictional_heating)(i, j);
+
+  if (std::abs(H - m_last_ice_thickness(i, j)) > m_skip_tolerance.ice_thickness or
+      std::abs(Ts - m_last_surface_temp(i, j)) > m_skip_tolerance.surface_temp or
+      std::abs(Qb - m_last_basal_heat_flux(i, j)) > m_skip_tolerance.basal_heat_flux) {
+    return false;
+  }
+
+  double strain_heating = 0.0, speed = 0.0;
+  column_forcing(*inputs.volumetric_heating_rate, *inputs.u3, *inputs.v3, *inputs.w3,
+                 i, j, m_grid->kBelowHeight(H), strain_heating, speed);
+
+  const double S0 = m_last_strain_heating(i, j);
+  if (std::abs(strain_heating - S0) > m_skip_tolerance.strain_heating * S0 or
+      std::abs(speed - m_last_speed(i, j)) > m_skip_tolerance.speed) {
+    return false;
+  }
+
+  return true;
+}
+
+/*!
+ * Record forcing and the rate of change of enthalpy in the column (i,j) after an update.
+ *
+ * Should be called after the new enthalpy is stored in `m_work`.
+ */
+void EnthalpyModel::record_column_forcing(int i, int j, double dt, bool column_is_cold,
+                                          const Inputs &inputs) {
+  if (not column_is_cold) {
+    m_skip_counter(i, j) = -1.0;
+    return;
+  }
+
+  const double H = (*inputs.ice_thickness)(i, j);
+  const unsigned int ks = m_grid->kBelowHeight(H);
+
+  {
+    const double
+      *E_old = m_ice_enthalpy.get_column(i, j),
+      *E_new = m_work.get_column(i, j);
+
+    double max_change = 0.0;
+    for (unsigned int k = 0; k <= ks; ++k) {
+      max_change = std::max(max_change, std::abs(E_new[k] - E_old[k]));
+    }
+    m_enthalpy_change_rate(i, j) = max_change / dt;
+  }
+
+  double strain_heating = 0.0, speed = 0.0;
+  column_forcing(*inputs.volumetric_heating_rate, *inputs.u3, *inputs.v3, *inputs.w3,
+                 i, j, ks, strain_heating, speed);
+
+  m_skip_counter(i, j)          = 0.0;
+  m_skip_error(i, j)            = 0.0;
+  m_last_ice_thickness(i, j)    = H;
+  m_last_surface_temp(i, j)     = (*inputs.surface_temp)(i, j);
+  m_last_basal_heat_flux(i, j)  = ((*inputs.basal_heat_flux)(i, j) +
+                                   (*inputs.basal_frictional_heating)(i, j));
+  m_last_strain_heating(i, j)   = strain_heating;
+  m_last_speed(i, j)            = speed;
 }
 
 void EnthalpyModel::restart_impl(const File &input_file, int record) {
@@ -150,6 +321,12 @@ void EnthalpyModel::update_impl(double t, double dt, const Inputs &inputs) {
       &cell_type, &u3, &v3, &w3, &strain_heating3, &m_basal_melt_rate, &m_ice_enthalpy,
       &m_work};
 
+  if (m_skip_steady_columns) {
+    list.add({&m_skip_counter, &m_skip_error, &m_enthalpy_change_rate,
+        &m_last_surface_temp, &m_last_basal_heat_flux, &m_last_ice_thickness,
+        &m_last_strain_heating, &m_last_speed});
+  }
+
   double margin_threshold = m_config->get_number("energy.margin_ice_thickness_limit");
 
   unsigned int liquifiedCount = 0;
@@ -161,9 +338,22 @@ void EnthalpyModel::update_impl(double t, double dt, const Inputs &inputs) {
 
       const double H = ice_thickness(i, j);
 
-      system.init(i, j,
-                  marginal(ice_thickness, i, j, margin_threshold),
-                  H);
+      // skip columns that are in a steady state: enthalpy and the basal melt rate are not
+      // changed
+      if (m_skip_steady_columns and column_is_steady(i, j, dt, inputs)) {
+        m_work.set_column(i, j, m_ice_enthalpy.get_column(i, j));
+
+        m_skip_counter(i, j) += 1.0;
+        m_skip_error(i, j)   += m_enthalpy_change_rate(i, j) * dt;
+
+        m_stats.skipped_column_counter += 1;
+        m_stats.ice_column_counter += 1;
+        continue;
+      }
+
+      const bool is_marginal = marginal(ice_thickness, i, j, margin_threshold);
+
+      system.init(i, j, is_marginal, H);
 
       // enthalpy and pressures at top of ice
       const double
@@ -182,9 +372,15 @@ void EnthalpyModel::update_impl(double t, double dt, const Inputs &inputs) {
         // case and set to zero for now. Also, there is no basal melt
         // rate on ice free land and ice free ocean
         m_basal_melt_rate(i, j) = 0.0;
+
+        if (m_skip_steady_columns) {
+          m_skip_counter(i, j) = -1.0;
+        }
         continue;
       } // end of if (ice_free_column)
 
+      m_stats.ice_column_counter += 1;
+
       if (system.lambda() < 1.0) {
         m_stats.reduced_accuracy_counter += 1; // count columns with lambda < 1
       }
@@ -319,9 +515,10 @@ void EnthalpyModel::update_impl(double t, double dt, const Inputs &inputs) {
 
       } // end of post-processing
 
+      const bool base_is_cold = (Enthnew[0] < system.Enth_s(0)) && (till_water_thickness(i,j) == 0.0);
+
       // compute basal melt rate
       {
-        bool base_is_cold = (Enthnew[0] < system.Enth_s(0)) && (till_water_thickness(i,j) == 0.0);
         // Determine melt rate, but only preliminarily because of
         // drainage, from heat flux out of bedrock, heat flux into
         // ice, and frictional heating
@@ -373,6 +570,16 @@ void EnthalpyModel::update_impl(double t, double dt, const Inputs &inputs) {
       } // end of the basal melt rate computation
 
       system.fine_to_coarse(Enthnew, i, j, m_work);
+
+      if (m_skip_steady_columns) {
+        // only cold grounded columns away from ice margins are candidates for skipping
+        bool column_is_cold = base_is_cold and not is_floating and not is_marginal;
+        for (unsigned int k = 0; column_is_cold and k <= system.ks(); k++) {
+          column_is_cold = Enthnew[k] < system.Enth_s(k);
+        }
+
+        record_column_forcing(i, j, dt, column_is_cold, inputs);
+      }
     }
   } catch (...) {
     loop.failed();
@@ -392,5 +599,40 @@ void EnthalpyModel::write_model_state_impl(const File &output) const {
   m_basal_melt_rate.write(output);
 }
 
+/*! @brief Fraction of ice-covered columns skipped during the last energy time step. */
+class SkippedColumnFraction : public TSDiag<TSSnapshotDiagnostic, EnthalpyModel> {
+public:
+  SkippedColumnFraction(const EnthalpyModel *m)
+    : TSDiag<TSSnapshotDiagnostic, EnthalpyModel>(m, "enthalpy_skipped_column_fraction") {
+
+    set_units("1", "1");
+    m_ts.variable().set_string("long_name",
+                               "fraction of ice-covered columns skipped because"
+                               " they were in a steady state");
+    m_ts.variable().set_number("valid_min", 0.0);
+    m_ts.variable().set_number("valid_max", 1.0);
+  }
+protected:
+  double compute() {
+    const EnergyModelStats &stats = model->stats();
+
+    if (stats.ice_column_counter == 0) {
+      return 0.0;
+    }
+
+    return ((double) stats.skipped_column_counter) / stats.ice_column_counter;
+  }
+};
+
+TSDiagnosticList EnthalpyModel::ts_diagnostics_impl() const {
+  TSDiagnosticList result = EnergyModel::ts_diagnostics_impl();
+
+  if (m_skip_steady_columns) {
+    result["enthalpy_skipped_column_fraction"] = TSDiagnostic::Ptr(new SkippedColumnFraction(this));
+  }
+
+  return result;
+}
+
 } // end of namespace energy
 } // end of namespace pism
@@ -50,6 +50,30 @@ protected:
 
   virtual void define_model_state_impl(const File &output) const;
   virtual void write_model_state_impl(const File &output) const;
+
+  virtual TSDiagnosticList ts_diagnostics_impl() const;
+
+  bool column_is_steady(int i, int j, double dt, const Inputs &inputs) const;
+  void record_column_forcing(int i, int j, double dt, bool column_is_cold,
+                             const Inputs &inputs);
+
+  //! true if steady columns are updated at a reduced frequency
+  bool m_skip_steady_columns;
+  //! maximum number of consecutive time steps a steady column can be skipped
+  int m_skip_max_interval;
+  //! tolerances used to decide if a column is in a steady state
+  struct {
+    double enthalpy, surface_temp, basal_heat_flux, ice_thickness, strain_heating, speed;
+  } m_skip_tolerance;
+  //! number of consecutive skipped steps (-1 if the column has to be updated)
+  IceModelVec2Int m_skip_counter;
+  //! estimate of the enthalpy change neglected in skipped steps
+  IceModelVec2S m_skip_error;
+  //! maximum rate of change of enthalpy in a column during the last update
+  IceModelVec2S m_enthalpy_change_rate;
+  //! forcing used during the last update of a column; used to detect changes
+  IceModelVec2S m_last_surface_temp, m_last_basal_heat_flux, m_last_ice_thickness,
+    m_last_strain_heating, m_last_speed;
 };
 
 /*! @brief The "dummy" energy balance model. Reads in enthalpy from a file, but does not update it. */
@@ -120,8 +120,22 @@ void enthSystemCtx::init(int i, int j, bool marginal, double ice_thickness) {
     return;
   }
 
-  coarse_to_fine(m_u3, m_i, m_j, &m_u[0]);
-  coarse_to_fine(m_v3, m_i, m_j, &m_v[0]);
+  {
+    const double *coarse[] = {
+      m_u3.get_column(m_i, m_j),
+      m_v3.get_column(m_i, m_j),
+      m_strain_heating3.get_column(m_i, m_j),
+      m_Enth3.get_column(m_i, m_j),
+      m_Enth3.get_column(m_i, m_j + 1),
+      m_Enth3.get_column(m_i + 1, m_j),
+      m_Enth3.get_column(m_i, m_j - 1),
+      m_Enth3.get_column(m_i - 1, m_j)
+    };
+    double *fine[] = {&m_u[0], &m_v[0], &m_strain_heating[0], &m_Enth[0],
+                      &m_E_n[0], &m_E_e[0], &m_E_s[0], &m_E_w[0]};
+
+    coarse_to_fine(coarse, 8, fine);
+  }
 
   if (m_marginal and m_exclude_vertical_advection) {
     for (unsigned int k = 0; k < m_w.size(); ++k) {
@@ -131,14 +145,6 @@ void enthSystemCtx::init(int i, int j, bool marginal, double ice_thickness) {
     coarse_to_fine(m_w3, m_i, m_j, &m_w[0]);
   }
 
-  coarse_to_fine(m_strain_heating3, m_i, m_j, &m_strain_heating[0]);
-  coarse_to_fine(m_Enth3, m_i, m_j, &m_Enth[0]);
-
-  coarse_to_fine(m_Enth3, m_i, m_j+1, &m_E_n[0]);
-  coarse_to_fine(m_Enth3, m_i+1, m_j, &m_E_e[0]);
-  coarse_to_fine(m_Enth3, m_i, m_j-1, &m_E_s[0]);
-  coarse_to_fine(m_Enth3, m_i-1, m_j, &m_E_w[0]);
-
   compute_enthalpy_CTS();
 
   m_lambda = compute_lambda();
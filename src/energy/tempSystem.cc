@@ -78,16 +78,23 @@ void tempSystemCtx::initThisColumn(int i, int j, bool is_marginal, MaskValue mas
     return;
   }
 
-  coarse_to_fine(m_u3, m_i, m_j, &m_u[0]);
-  coarse_to_fine(m_v3, m_i, m_j, &m_v[0]);
-  coarse_to_fine(m_w3, m_i, m_j, &m_w[0]);
-  coarse_to_fine(m_strain_heating3, m_i, m_j, &m_strain_heating[0]);
-  coarse_to_fine(m_T3, m_i, m_j, &m_T[0]);
-
-  coarse_to_fine(m_T3, m_i, m_j+1, &m_T_n[0]);
-  coarse_to_fine(m_T3, m_i+1, m_j, &m_T_e[0]);
-  coarse_to_fine(m_T3, m_i, m_j-1, &m_T_s[0]);
-  coarse_to_fine(m_T3, m_i-1, m_j, &m_T_w[0]);
+  {
+    const double *coarse[] = {
+      m_u3.get_column(m_i, m_j),
+      m_v3.get_column(m_i, m_j),
+      m_w3.get_column(m_i, m_j),
+      m_strain_heating3.get_column(m_i, m_j),
+      m_T3.get_column(m_i, m_j),
+      m_T3.get_column(m_i, m_j + 1),
+      m_T3.get_column(m_i + 1, m_j),
+      m_T3.get_column(m_i, m_j - 1),
+      m_T3.get_column(m_i - 1, m_j)
+    };
+    double *fine[] = {&m_u[0], &m_v[0], &m_w[0], &m_strain_heating[0], &m_T[0],
+                      &m_T_n[0], &m_T_e[0], &m_T_s[0], &m_T_w[0]};
+
+    coarse_to_fine(coarse, 9, fine);
+  }
 
   m_lambda = compute_lambda();
 }
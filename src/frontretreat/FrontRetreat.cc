@@ -24,6 +24,7 @@
 #include "pism/util/pism_utilities.hh"
 #include "pism/geometry/part_grid_threshold_thickness.hh"
 #include "pism/geometry/Geometry.hh"
+#include "pism/frontretreat/util/FrontBand.hh"
 
 namespace pism {
 
@@ -76,7 +77,8 @@ void FrontRetreat::compute_modified_mask(const IceModelVec2CellType &input,
  */
 MaxTimestep FrontRetreat::max_timestep(const IceModelVec2CellType &cell_type,
                                        const IceModelVec2Int &bc_mask,
-                                       const IceModelVec2S &retreat_rate) const {
+                                       const IceModelVec2S &retreat_rate,
+                                       const FrontBand *band) const {
 
   IceGrid::ConstPtr grid = retreat_rate.grid();
   units::System::Ptr sys = grid->ctx()->unit_system();
@@ -93,7 +95,7 @@ MaxTimestep FrontRetreat::max_timestep(const IceModelVec2CellType &cell_type,
 
   IceModelVec::AccessList list{&cell_type, &bc_mask, &retreat_rate};
 
-  for (Points pt(*grid); pt; pt.next()) {
+  for (BandPoints pt(*grid, band); pt; pt.next()) {
     const int i = pt.i(), j = pt.j();
 
     if (cell_type.ice_free_ocean(i, j) and
@@ -141,6 +143,9 @@ MaxTimestep FrontRetreat::max_timestep(const IceModelVec2CellType &cell_type,
  * This code applies a horizontal retreat rate at "partially-filled" cells that are next
  * to icy cells.
  *
+ * If `band` is not NULL, only cells in this narrow band are visited. It has to contain
+ * all the cells next to the ice margin.
+ *
  * Models providing the "retreat rate" should set this field to zero in areas where a
  * particular parameterization does not apply. (For example: some calving models apply at
  * shelf calving fronts, others may apply at grounded termini but not at ice shelves,
@@ -151,7 +156,8 @@ void FrontRetreat::update_geometry(double dt,
                                    const IceModelVec2Int &bc_mask,
                                    const IceModelVec2S &retreat_rate,
                                    IceModelVec2S &Href,
-                                   IceModelVec2S &ice_thickness) {
+                                   IceModelVec2S &ice_thickness,
+                                   const FrontBand *band) {
 
   const IceModelVec2S &bed = geometry.bed_elevation;
   const IceModelVec2S &sea_level = geometry.sea_level_elevation;
@@ -177,7 +183,7 @@ void FrontRetreat::update_geometry(double dt,
   const Direction dirs[] = {North, East, South, West};
 
   // Step 1: Apply the computed horizontal retreat rate:
-  for (Points pt(*m_grid); pt; pt.next()) {
+  for (BandPoints pt(*m_grid, band); pt; pt.next()) {
     const int i = pt.i(), j = pt.j();
 
     // apply retreat rate at the margin (i.e. to partially-filled cells) only
@@ -250,7 +256,7 @@ void FrontRetreat::update_geometry(double dt,
   // Step 2: update ice thickness and Href in neighboring cells if we need to propagate mass losses.
   m_tmp.update_ghosts();
 
-  for (Points p(*m_grid); p; p.next()) {
+  for (BandPoints p(*m_grid, band); p; p.next()) {
     const int i = p.i(), j = p.j();
 
     // Note: this condition has to match the one in step 1 above.
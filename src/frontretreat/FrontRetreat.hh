@@ -28,6 +28,7 @@
 namespace pism {
 
 class Geometry;
+class FrontBand;
 
 //! An abstract class implementing calving front retreat resulting from application of a
 //! spatially-variable horizontal retreat rate.
@@ -44,11 +45,13 @@ public:
                        const IceModelVec2Int &bc_mask,
                        const IceModelVec2S &retreat_rate,
                        IceModelVec2S &Href,
-                       IceModelVec2S &ice_thickness);
+                       IceModelVec2S &ice_thickness,
+                       const FrontBand *band = nullptr);
 
   MaxTimestep max_timestep(const IceModelVec2CellType &cell_type,
                            const IceModelVec2Int &bc_mask,
-                           const IceModelVec2S &retreat_rate) const;
+                           const IceModelVec2S &retreat_rate,
+                           const FrontBand *band = nullptr) const;
 private:
 
   void compute_modified_mask(const IceModelVec2CellType &input,
@@ -24,6 +24,7 @@
 #include "pism/util/IceModelVec2CellType.hh"
 #include "pism/stressbalance/StressBalance.hh"
 #include "pism/geometry/Geometry.hh"
+#include "pism/frontretreat/util/FrontBand.hh"
 
 namespace pism {
 namespace calving {
@@ -62,7 +63,8 @@ void EigenCalving::init() {
   See equation (26) in [\ref Winkelmannetal2011].
 */
 void EigenCalving::update(const IceModelVec2CellType &cell_type,
-                          const IceModelVec2V &ice_velocity) {
+                          const IceModelVec2V &ice_velocity,
+                          const FrontBand *band) {
 
   // make a copy with a wider stencil
   m_cell_type.copy_from(cell_type);
@@ -78,10 +80,15 @@ void EigenCalving::update(const IceModelVec2CellType &cell_type,
                                                    m_strain_rates);
   m_strain_rates.update_ghosts();
 
+  if (band) {
+    // the calving rate is zero outside of the narrow band
+    m_calving_rate.set(0.0);
+  }
+
   IceModelVec::AccessList list{&m_cell_type, &m_calving_rate, &m_strain_rates};
 
   // Compute the horizontal calving rate
-  for (Points pt(*m_grid); pt; pt.next()) {
+  for (BandPoints pt(*m_grid, band); pt; pt.next()) {
     const int i = pt.i(), j = pt.j();
 
     // Find partially filled or empty grid boxes on the icefree ocean, which
@@ -24,6 +24,7 @@
 namespace pism {
 
 class Geometry;
+class FrontBand;
 
 namespace calving {
 
@@ -34,7 +35,8 @@ public:
 
   void init();
 
-  void update(const IceModelVec2CellType &cell_type, const IceModelVec2V &ice_velocity);
+  void update(const IceModelVec2CellType &cell_type, const IceModelVec2V &ice_velocity,
+              const FrontBand *band = nullptr);
 protected:
   DiagnosticList diagnostics_impl() const;
 
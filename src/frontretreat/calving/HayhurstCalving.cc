@@ -23,6 +23,7 @@
 #include "pism/util/error_handling.hh"
 #include "pism/util/IceModelVec2CellType.hh"
 #include "pism/geometry/Geometry.hh"
+#include "pism/frontretreat/util/FrontBand.hh"
 
 namespace pism {
 namespace calving {
@@ -69,7 +70,8 @@ void HayhurstCalving::init() {
 void HayhurstCalving::update(const IceModelVec2CellType &cell_type,
                              const IceModelVec2S &ice_thickness,
                              const IceModelVec2S &sea_level,
-                             const IceModelVec2S &bed_elevation) {
+                             const IceModelVec2S &bed_elevation,
+                             const FrontBand *band) {
 
   using std::min;
 
@@ -80,10 +82,15 @@ void HayhurstCalving::update(const IceModelVec2CellType &cell_type,
     // convert "Pa" to "MPa" and "m yr-1" to "m s-1"
     unit_scaling  = pow(1e-6, m_exponent_r) * convert(m_sys, 1.0, "m year-1", "m second-1");
 
+  if (band) {
+    // the calving rate is zero outside of the narrow band
+    m_calving_rate.set(0.0);
+  }
+
   IceModelVec::AccessList list{&ice_thickness, &cell_type, &m_calving_rate, &sea_level,
                                &bed_elevation};
 
-  for (Points pt(*m_grid); pt; pt.next()) {
+  for (BandPoints pt(*m_grid, band); pt; pt.next()) {
     const int i = pt.i(), j = pt.j();
 
     double water_depth = sea_level(i, j) - bed_elevation(i, j);
@@ -131,7 +138,7 @@ void HayhurstCalving::update(const IceModelVec2CellType &cell_type,
 
   const Direction dirs[] = {North, East, South, West};
 
-  for (Points p(*m_grid); p; p.next()) {
+  for (BandPoints p(*m_grid, band); p; p.next()) {
     const int i = p.i(), j = p.j();
 
     if (cell_type.ice_free(i, j) and cell_type.next_to_ice(i, j) ) {
@@ -25,6 +25,7 @@
 namespace pism {
 
 class Geometry;
+class FrontBand;
 
 namespace calving {
 
@@ -36,7 +37,8 @@ public:
   void init();
 
   void update(const IceModelVec2CellType &cell_type, const IceModelVec2S &ice_thickness,
-              const IceModelVec2S &sea_level, const IceModelVec2S &bed_elevation);
+              const IceModelVec2S &sea_level, const IceModelVec2S &bed_elevation,
+              const FrontBand *band = nullptr);
 
   const IceModelVec2S &calving_rate() const;
 
@@ -26,6 +26,7 @@
 #include "pism/rheology/FlowLawFactory.hh"
 #include "pism/rheology/FlowLaw.hh"
 #include "pism/geometry/Geometry.hh"
+#include "pism/frontretreat/util/FrontBand.hh"
 
 namespace pism {
 namespace calving {
@@ -99,7 +100,8 @@ void vonMisesCalving::init() {
 void vonMisesCalving::update(const IceModelVec2CellType &cell_type,
                              const IceModelVec2S &ice_thickness,
                              const IceModelVec2V &ice_velocity,
-                             const IceModelVec3 &ice_enthalpy) {
+                             const IceModelVec3 &ice_enthalpy,
+                             const FrontBand *band) {
 
   using std::max;
 
@@ -113,6 +115,11 @@ void vonMisesCalving::update(const IceModelVec2CellType &cell_type,
                                                    m_strain_rates);
   m_strain_rates.update_ghosts();
 
+  if (band) {
+    // the calving rate is zero outside of the narrow band
+    m_calving_rate.set(0.0);
+  }
+
   IceModelVec::AccessList list{&ice_enthalpy, &ice_thickness, &m_cell_type, &ice_velocity,
                                &m_strain_rates, &m_calving_rate, &m_calving_threshold};
 
@@ -120,7 +127,7 @@ void vonMisesCalving::update(const IceModelVec2CellType &cell_type,
 
   double glen_exponent = m_flow_law->exponent();
 
-  for (Points pt(*m_grid); pt; pt.next()) {
+  for (BandPoints pt(*m_grid, band); pt; pt.next()) {
     const int i = pt.i(), j = pt.j();
 
     // Find partially filled or empty grid boxes on the icefree ocean, which
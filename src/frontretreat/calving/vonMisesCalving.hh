@@ -25,6 +25,7 @@
 namespace pism {
 
 class Geometry;
+class FrontBand;
 
 namespace rheology {
 class FlowLaw;
@@ -42,7 +43,8 @@ public:
   void update(const IceModelVec2CellType &cell_type,
               const IceModelVec2S &ice_thickness,
               const IceModelVec2V &ice_velocity,
-              const IceModelVec3 &ice_enthalpy);
+              const IceModelVec3 &ice_enthalpy,
+              const FrontBand *band = nullptr);
   const IceModelVec2S& threshold() const;
 
 protected:
@@ -0,0 +1,159 @@
+/* Copyright (C) 2020 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <algorithm>            // std::min, std::max
+
+#include "FrontBand.hh"
+
+#include "pism/util/IceGrid.hh"
+#include "pism/util/IceModelVec2CellType.hh"
+#include "pism/util/error_handling.hh"
+
+namespace pism {
+
+FrontBand::FrontBand(IceGrid::ConstPtr grid, int width, int rebuild_interval)
+  : m_grid(grid),
+    m_width(width),
+    m_rebuild_interval(rebuild_interval),
+    m_n_updates(0) {
+
+  if (m_width < 2) {
+    // The band is updated before calving, but it is also used by max_timestep() in the
+    // next time step. In between the front may move by one cell due to calving and by
+    // one cell due to flow, so the band has to be at least two cells wide to contain
+    // the front after it moves.
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "narrow band width has to be at least 2 (got %d)",
+                                  m_width);
+  }
+
+  if (m_rebuild_interval < 1) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "narrow band rebuild interval has to be at least 1 (got %d)",
+                                  m_rebuild_interval);
+  }
+
+  m_front.create(m_grid, "front_cells", WITH_GHOSTS, m_width);
+  m_front.set_attrs("internal", "1 at front cells, 0 elsewhere", "", "", "", 0);
+  m_front.set(0.0);
+
+  m_in_band.resize(m_grid->xm() * m_grid->ym(), 0);
+}
+
+unsigned int FrontBand::size() const {
+  return m_band.size();
+}
+
+static bool front_p(const IceModelVec2CellType &cell_type, int i, int j) {
+  return (cell_type.ice_margin(i, j) or
+          (cell_type.ice_free(i, j) and cell_type.next_to_ice(i, j)));
+}
+
+/*!
+ * Add cells owned by this process and within `m_width` cells of `(i, j)` to the band.
+ */
+void FrontBand::mark(int i, int j) {
+  const int
+    xs = m_grid->xs(),
+    xm = m_grid->xm(),
+    ys = m_grid->ys(),
+    ym = m_grid->ym();
+
+  for (int J = std::max(j - m_width, ys); J <= std::min(j + m_width, ys + ym - 1); ++J) {
+    for (int I = std::max(i - m_width, xs); I <= std::min(i + m_width, xs + xm - 1); ++I) {
+      const int k = (J - ys) * xm + (I - xs);
+      if (not m_in_band[k]) {
+        m_in_band[k] = 1;
+        m_band.push_back(k);
+      }
+    }
+  }
+}
+
+/*!
+ * Update the band using the current cell type mask. The mask has to have valid ghosts.
+ */
+void FrontBand::update(const IceModelVec2CellType &cell_type) {
+  const bool rebuild = (m_n_updates % m_rebuild_interval == 0);
+  m_n_updates += 1;
+
+  const int
+    xs = m_grid->xs(),
+    xm = m_grid->xm(),
+    ys = m_grid->ys(),
+    ym = m_grid->ym(),
+    w  = m_width;
+
+  // Cells that have to be re-examined. Front cells outside of the old band are 0 in
+  // m_front, so in the incremental mode it is enough to update m_front in the band.
+  std::vector<int> candidates;
+  if (rebuild) {
+    m_front.set(0.0);
+
+    candidates.resize(xm * ym);
+    for (int k = 0; k < xm * ym; ++k) {
+      candidates[k] = k;
+    }
+  } else {
+    candidates = m_band;
+  }
+
+  {
+    IceModelVec::AccessList list{&cell_type, &m_front};
+
+    for (auto k : candidates) {
+      const int i = xs + k % xm, j = ys + k / xm;
+      m_front(i, j) = front_p(cell_type, i, j) ? 1.0 : 0.0;
+    }
+  }
+  m_front.update_ghosts();
+
+  // clear the old band
+  for (auto k : m_band) {
+    m_in_band[k] = 0;
+  }
+  m_band.clear();
+
+  IceModelVec::AccessList list{&m_front};
+
+  // cells near front cells owned by this process
+  for (auto k : candidates) {
+    const int i = xs + k % xm, j = ys + k / xm;
+    if (m_front.as_int(i, j) == 1) {
+      mark(i, j);
+    }
+  }
+
+  // cells near front cells owned by neighbors (the strip of ghosts of width w)
+  for (int j = ys - w; j < ys + ym + w; ++j) {
+    const bool interior_row = (j >= ys and j < ys + ym);
+    for (int i = xs - w; i < xs + xm + w; ++i) {
+      if (interior_row and i == xs) {
+        // skip cells owned by this process
+        i = xs + xm - 1;
+        continue;
+      }
+      if (m_front.as_int(i, j) == 1) {
+        mark(i, j);
+      }
+    }
+  }
+}
+
+} // end of namespace pism
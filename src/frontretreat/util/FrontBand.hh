@@ -0,0 +1,130 @@
+/* Copyright (C) 2020 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef FRONTBAND_H
+#define FRONTBAND_H
+
+#include <vector>
+
+#include "pism/util/iceModelVec.hh"
+#include "pism/util/IceGrid.hh"
+
+namespace pism {
+
+class IceModelVec2CellType;
+
+//! Narrow band of grid cells near ice margins.
+/*!
+ * The band contains all the cells (owned by this process) within `width` cells
+ * (measured along grid lines and diagonals) of a "front" cell, i.e. an icy cell next to
+ * an ice-free cell or an ice-free cell next to an icy cell.
+ *
+ * Calving and front retreat code acts at front cells only, so it can skip the rest of
+ * the grid.
+ *
+ * The band is updated incrementally: assuming that the front moves by at most one cell
+ * between updates, it remains inside the band, so only cells in the band have to be
+ * re-examined. Processes other than mass transport and calving (for example: the
+ * surface mass balance creating ice away from existing margins) may violate this
+ * assumption, so the band is re-built from scratch every `rebuild_interval` updates.
+ */
+class FrontBand {
+public:
+  FrontBand(IceGrid::ConstPtr grid, int width, int rebuild_interval);
+
+  void update(const IceModelVec2CellType &cell_type);
+
+  //! Number of cells in the band owned by this process.
+  unsigned int size() const;
+
+  //! Local index (`(j - ys) * xm + (i - xs)`) of the `k`-th cell in the band.
+  int index(unsigned int k) const {
+    return m_band[k];
+  }
+private:
+  void mark(int i, int j);
+
+  IceGrid::ConstPtr m_grid;
+
+  int m_width;
+  int m_rebuild_interval;
+  int m_n_updates;
+
+  //! 1 at front cells, 0 elsewhere
+  IceModelVec2Int m_front;
+
+  //! local indexes of cells in the band
+  std::vector<int> m_band;
+  //! m_in_band[k] is 1 if the cell with the local index `k` is in the band
+  std::vector<char> m_in_band;
+};
+
+/*!
+ * Iterator traversing cells in a narrow band or (if `band` is NULL) all the cells
+ * owned by this process.
+ *
+ * Usage:
+ *
+ * `for (BandPoints p(grid, band); p; p.next()) { int i = p.i(), j = p.j(); ... }`
+ */
+class BandPoints {
+public:
+  BandPoints(const IceGrid &grid, const FrontBand *band)
+    : m_band(band), m_k(0), m_i(0), m_j(0) {
+    m_xs = grid.xs();
+    m_ys = grid.ys();
+    m_xm = grid.xm();
+    m_size = band ? band->size() : grid.xm() * grid.ym();
+    set_indexes();
+  }
+
+  int i() const {
+    return m_i;
+  }
+
+  int j() const {
+    return m_j;
+  }
+
+  void next() {
+    m_k += 1;
+    set_indexes();
+  }
+
+  operator bool() const {
+    return m_k < m_size;
+  }
+private:
+  void set_indexes() {
+    if (m_k < m_size) {
+      const int k = m_band ? m_band->index(m_k) : m_k;
+      m_i = m_xs + k % m_xm;
+      m_j = m_ys + k / m_xm;
+    }
+  }
+
+  const FrontBand *m_band;
+  unsigned int m_k, m_size;
+  int m_xs, m_ys, m_xm;
+  int m_i, m_j;
+};
+
+} // end of namespace pism
+
+#endif /* FRONTBAND_H */
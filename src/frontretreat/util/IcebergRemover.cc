@@ -18,7 +18,7 @@
  */
 
 #include "IcebergRemover.hh"
-#include "pism/util/connected_components.hh"
+#include "pism/util/label_components.hh"
 #include "pism/util/Mask.hh"
 #include "pism/util/Vars.hh"
 #include "pism/util/error_handling.hh"
@@ -30,9 +30,8 @@ namespace calving {
 
 IcebergRemover::IcebergRemover(IceGrid::ConstPtr g)
   : Component(g),
-    m_iceberg_mask(m_grid, "iceberg_mask", WITHOUT_GHOSTS){
-
-  m_mask_p0 = m_iceberg_mask.allocate_proc0_copy();
+    m_iceberg_mask(m_grid, "iceberg_mask", WITHOUT_GHOSTS) {
+  // empty
 }
 
 IcebergRemover::~IcebergRemover() {
@@ -82,23 +81,8 @@ void IcebergRemover::update(const IceModelVec2Int &bc_mask,
     }
   }
 
-  // identify icebergs using serial code on processor 0:
-  {
-    m_iceberg_mask.put_on_proc0(*m_mask_p0);
-
-    ParallelSection rank0(m_grid->com);
-    try {
-      if (m_grid->rank() == 0) {
-        petsc::VecArray mask_p0(*m_mask_p0);
-        label_connected_components(mask_p0.get(), m_grid->My(), m_grid->Mx(), true, mask_grounded_ice);
-      }
-    } catch (...) {
-      rank0.failed();
-    }
-    rank0.check();
-
-    m_iceberg_mask.get_from_proc0(*m_mask_p0);
-  }
+  // identify icebergs:
+  label_components(m_iceberg_mask, true, mask_grounded_ice);
 
   // correct ice thickness and the cell type mask using the resulting
   // "iceberg" mask:
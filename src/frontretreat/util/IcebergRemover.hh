@@ -57,8 +57,7 @@ public:
               IceModelVec2CellType &pism_mask,
               IceModelVec2S &ice_thickness);
 protected:
-  IceModelVec2S m_iceberg_mask;
-  petsc::Vec::Ptr m_mask_p0;
+  IceModelVec2Int m_iceberg_mask;
 };
 
 } // end of namespace calving
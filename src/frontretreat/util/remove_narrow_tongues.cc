@@ -21,6 +21,7 @@
 
 #include "pism/util/IceGrid.hh"
 #include "pism/geometry/Geometry.hh"
+#include "FrontBand.hh"
 
 namespace pism {
 
@@ -54,11 +55,13 @@ namespace pism {
  *
  * @param[in,out] mask cell type mask
  * @param[in,out] ice_thickness modeled ice thickness
+ * @param[in] band narrow band containing the ice margin (NULL: check all cells)
  *
  * @return 0 on success
  */
 void remove_narrow_tongues(const Geometry &geometry,
-                           IceModelVec2S &ice_thickness) {
+                           IceModelVec2S &ice_thickness,
+                           const FrontBand *band) {
 
   auto &mask      = geometry.cell_type;
   auto &bed       = geometry.bed_elevation;
@@ -68,7 +71,7 @@ void remove_narrow_tongues(const Geometry &geometry,
 
   IceModelVec::AccessList list{&mask, &bed, &sea_level, &ice_thickness};
 
-  for (Points p(*grid); p; p.next()) {
+  for (BandPoints p(*grid, band); p; p.next()) {
     const int i = p.i(), j = p.j();
     if (mask.ice_free(i,j) or
         (mask.grounded_ice(i,j) and bed(i,j) >= sea_level(i, j))) {
@@ -24,8 +24,10 @@ namespace pism {
 
 class IceModelVec2S;
 class Geometry;
+class FrontBand;
 
-void remove_narrow_tongues(const Geometry &geometry, IceModelVec2S &ice_thickness);
+void remove_narrow_tongues(const Geometry &geometry, IceModelVec2S &ice_thickness,
+                           const FrontBand *band = nullptr);
 
 } // end of namespace pism
 
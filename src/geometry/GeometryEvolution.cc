@@ -17,6 +17,11 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
+#include <set>
+#include <map>
+#include <vector>
+#include <utility>              // std::pair
+
 #include "GeometryEvolution.hh"
 
 #include "pism/util/iceModelVec.hh"
@@ -52,6 +57,13 @@ struct GeometryEvolution::Impl {
   //! True if the part-grid scheme is enabled.
   bool use_part_grid;
 
+  //! True if flow_step() may use the fused kernel (see fused_flow_step()).
+  bool use_fused_kernel;
+
+  //! True if residual redistribution should use the front-local work list (see
+  //! redistribute_residual()).
+  bool use_front_local_redistribution;
+
   //! Flux divergence (used to track thickness changes due to flow).
   IceModelVec2S flux_divergence;
 
@@ -116,6 +128,10 @@ GeometryEvolution::Impl::Impl(IceGrid::ConstPtr grid)
     ice_density   = config->get_number("constants.ice.density");
     use_bmr       = config->get_flag("geometry.update.use_basal_melt_rate");
     use_part_grid = config->get_flag("geometry.part_grid.enabled");
+
+    use_fused_kernel = config->get_flag("geometry.update.fused_kernel");
+
+    use_front_local_redistribution = config->get_flag("geometry.part_grid.front_local_redistribution");
   }
 
   // reported quantities
@@ -263,6 +279,15 @@ void GeometryEvolution::flow_step(const Geometry &geometry, double dt,
   }
   m_impl->profile.end("ge.update_ghosted_copies");
 
+  if (m_impl->use_fused_kernel and
+      not m_impl->use_part_grid and
+      diffusive_flux.stencil_width() > 0) {
+    m_impl->profile.begin("ge.fused_flow_step");
+    fused_flow_step(geometry, dt, diffusive_flux, thickness_bc_mask);
+    m_impl->profile.end("ge.fused_flow_step");
+    return;
+  }
+
   // Derived classes can include modifications for regional runs.
   m_impl->profile.begin("ge.interface_fluxes");
   compute_interface_fluxes(m_impl->cell_type,          // in (uses ghosts)
@@ -525,110 +550,126 @@ static double limit_diffusive_flux(int current, int neighbor, double flux) {
 }
 
 /*!
- * Combine advective velocity and the diffusive flux on the staggered grid with the ice thickness to
- * compute the total flux through cell interfaces.
+ * Compute the total flux through the interface between cells (i,j) and (i+1,j) (if `n ==
+ * 0`) or (i,j) and (i,j+1) (if `n == 1`).
  *
  * Uses first-order upwinding to compute the advective flux.
  *
  * Limits the diffusive flux to prevent SIA-driven flow in the ocean and ice-free areas.
  */
-void GeometryEvolution::compute_interface_fluxes(const IceModelVec2CellType &cell_type,
-                                                 const IceModelVec2S        &ice_thickness,
-                                                 const IceModelVec2V        &velocity,
-                                                 const IceModelVec2Int      &velocity_bc_mask,
-                                                 const IceModelVec2Stag     &diffusive_flux,
-                                                 IceModelVec2Stag           &output) {
+static inline double interface_flux(const IceModelVec2CellType &cell_type,
+                                    const IceModelVec2S        &ice_thickness,
+                                    const IceModelVec2V        &velocity,
+                                    const IceModelVec2Int      &velocity_bc_mask,
+                                    const IceModelVec2Stag     &diffusive_flux,
+                                    int i, int j, int n) {
+  const int
+    M  = cell_type(i, j),
+    BC = velocity_bc_mask.as_int(i, j);
+
+  const double H = ice_thickness(i, j);
+  const Vector2 V  = velocity(i, j);
+
+  const int
+    oi  = 1 - n,               // offset in the i direction
+    oj  = n,                   // offset in the j direction
+    i_n = i + oi,              // i index of a neighbor
+    j_n = j + oj;              // j index of a neighbor
+
+  const int M_n = cell_type(i_n, j_n);
+
+  // advective velocity at the current interface
+  double v = 0.0;
+  {
+    const Vector2 V_n  = velocity(i_n, j_n);
 
-  IceModelVec::AccessList list{&cell_type, &velocity, &velocity_bc_mask, &ice_thickness,
-      &diffusive_flux, &output};
+    // Regular case
+    {
+      if (icy(M) and icy(M_n)) {
+        // Case 1: both sides of the interface are icy
+        v = (n == 0 ? 0.5 * (V.u + V_n.u) : 0.5 * (V.v + V_n.v));
 
-  ParallelSection loop(m_grid->com);
-  try {
-    for (Points p(*m_grid); p; p.next()) {
-      const int
-        i  = p.i(),
-        j  = p.j(),
-        M  = cell_type(i, j),
-        BC = velocity_bc_mask.as_int(i, j);
+      } else if (icy(M) and ice_free(M_n)) {
+        // Case 2: icy cell next to an ice-free cell
+        v = (n == 0 ? V.u : V.v);
 
-      const double H = ice_thickness(i, j);
-      const Vector2 V  = velocity(i, j);
+      } else if (ice_free(M) and icy(M_n)) {
+        // Case 3: ice-free cell next to icy cell
+        v = (n == 0 ? V_n.u : V_n.v);
 
-      for (int n = 0; n < 2; ++n) {
-        const int
-          oi  = 1 - n,               // offset in the i direction
-          oj  = n,                   // offset in the j direction
-          i_n = i + oi,              // i index of a neighbor
-          j_n = j + oj;              // j index of a neighbor
+      } else if (ice_free(M) and ice_free(M_n)) {
+        // Case 4: both sides of the interface are ice-free
+        v = 0.0;
 
-        const int M_n = cell_type(i_n, j_n);
-
-        // advective velocity at the current interface
-        double v = 0.0;
-        {
-          const Vector2 V_n  = velocity(i_n, j_n);
-
-          // Regular case
-          {
-            if (icy(M) and icy(M_n)) {
-              // Case 1: both sides of the interface are icy
-              v = (n == 0 ? 0.5 * (V.u + V_n.u) : 0.5 * (V.v + V_n.v));
+      }
+    }
 
-            } else if (icy(M) and ice_free(M_n)) {
-              // Case 2: icy cell next to an ice-free cell
-              v = (n == 0 ? V.u : V.v);
+    // The Dirichlet B.C. case:
+    {
+      const int BC_n = velocity_bc_mask.as_int(i_n, j_n);
 
-            } else if (ice_free(M) and icy(M_n)) {
-              // Case 3: ice-free cell next to icy cell
-              v = (n == 0 ? V_n.u : V_n.v);
+      if (BC == 1 and BC_n == 1) {
+        // Case 1: both sides of the interface are B.C. locations: average from
+        // the regular grid onto the staggered grid.
+        v = (n == 0 ? 0.5 * (V.u + V_n.u) : 0.5 * (V.v + V_n.v));
 
-            } else if (ice_free(M) and ice_free(M_n)) {
-              // Case 4: both sides of the interface are ice-free
-              v = 0.0;
+      } else if (BC == 1 and BC_n == 0) {
+        // Case 2: at a Dirichlet B.C. location next to a regular location
+        v = (n == 0 ? V.u : V.v);
 
-            }
-          }
+      } else if (BC == 0 and BC_n == 1) {
 
-          // The Dirichlet B.C. case:
-          {
-            const int BC_n = velocity_bc_mask.as_int(i_n, j_n);
+        // Case 3: at a regular location next to a Dirichlet B.C. location
+        v = (n == 0 ? V_n.u : V_n.v);
 
-            if (BC == 1 and BC_n == 1) {
-              // Case 1: both sides of the interface are B.C. locations: average from
-              // the regular grid onto the staggered grid.
-              v = (n == 0 ? 0.5 * (V.u + V_n.u) : 0.5 * (V.v + V_n.v));
+      } else {
+        // Case 4: elsewhere.
+        // No Dirichlet B.C. adjustment here.
+      }
 
-            } else if (BC == 1 and BC_n == 0) {
-              // Case 2: at a Dirichlet B.C. location next to a regular location
-              v = (n == 0 ? V.u : V.v);
+    } // end of the Dirichlet B.C. case
 
-            } else if (BC == 0 and BC_n == 1) {
+    // finally, limit advective velocities
+    v = limit_advective_velocity(M, M_n, v);
+  }
 
-              // Case 3: at a regular location next to a Dirichlet B.C. location
-              v = (n == 0 ? V_n.u : V_n.v);
+  // advective flux
+  const double
+    H_n         = ice_thickness(i_n, j_n),
+    Q_advective = v * (v > 0.0 ? H : H_n); // first order upwinding
 
-            } else {
-              // Case 4: elsewhere.
-              // No Dirichlet B.C. adjustment here.
-            }
+  // diffusive flux
+  const double
+    Q_diffusive = limit_diffusive_flux(M, M_n, diffusive_flux(i, j, n));
 
-          } // end of the Dirichlet B.C. case
+  return Q_diffusive + Q_advective;
+}
 
-          // finally, limit advective velocities
-          v = limit_advective_velocity(M, M_n, v);
-        }
+/*!
+ * Combine advective velocity and the diffusive flux on the staggered grid with the ice thickness to
+ * compute the total flux through cell interfaces.
+ *
+ * See interface_flux().
+ */
+void GeometryEvolution::compute_interface_fluxes(const IceModelVec2CellType &cell_type,
+                                                 const IceModelVec2S        &ice_thickness,
+                                                 const IceModelVec2V        &velocity,
+                                                 const IceModelVec2Int      &velocity_bc_mask,
+                                                 const IceModelVec2Stag     &diffusive_flux,
+                                                 IceModelVec2Stag           &output) {
 
-        // advective flux
-        const double
-          H_n         = ice_thickness(i_n, j_n),
-          Q_advective = v * (v > 0.0 ? H : H_n); // first order upwinding
+  IceModelVec::AccessList list{&cell_type, &velocity, &velocity_bc_mask, &ice_thickness,
+      &diffusive_flux, &output};
 
-        // diffusive flux
-        const double
-          Q_diffusive = limit_diffusive_flux(M, M_n, diffusive_flux(i, j, n));
+  ParallelSection loop(m_grid->com);
+  try {
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
 
-        output(i, j, n) = Q_diffusive + Q_advective;
-      } // end of the loop over neighbors (n)
+      for (int n = 0; n < 2; ++n) {
+        output(i, j, n) = interface_flux(cell_type, ice_thickness, velocity, velocity_bc_mask,
+                                         diffusive_flux, i, j, n);
+      }
     }
   } catch (...) {
     loop.failed();
@@ -778,18 +819,27 @@ void GeometryEvolution::update_in_place(double dt,
     const int max_n_iterations = m_config->get_number("geometry.part_grid.max_iterations");
 
     bool done = false;
-    for (int i = 0; i < max_n_iterations and not done; ++i) {
-      m_log->message(4, "redistribution iteration %d\n", i);
-
-      // this call may set done to true
-      residual_redistribution_iteration(bed_topography,
-                                        sea_level,
-                                        m_impl->surface_elevation,
-                                        ice_thickness,
-                                        m_impl->cell_type,
-                                        area_specific_volume,
-                                        m_impl->residual,
-                                        done);
+    if (m_impl->use_front_local_redistribution) {
+      done = redistribute_residual(bed_topography,
+                                   sea_level,
+                                   ice_thickness,
+                                   area_specific_volume,
+                                   m_impl->residual,
+                                   max_n_iterations);
+    } else {
+      for (int i = 0; i < max_n_iterations and not done; ++i) {
+        m_log->message(4, "redistribution iteration %d\n", i);
+
+        // this call may set done to true
+        residual_redistribution_iteration(bed_topography,
+                                          sea_level,
+                                          m_impl->surface_elevation,
+                                          ice_thickness,
+                                          m_impl->cell_type,
+                                          area_specific_volume,
+                                          m_impl->residual,
+                                          done);
+      }
     }
 
     if (not done) {
@@ -797,6 +847,11 @@ void GeometryEvolution::update_in_place(double dt,
                      "WARNING: not done redistributing mass after %d iterations, remaining residual: %f m^3.\n",
                      max_n_iterations, m_impl->residual.sum() * m_grid->cell_area());
 
+      // Ghosts of the residual may contain values left over from the last iteration
+      // (redistribute_residual() updates only owned values of cells it processes).
+      // add() modifies ghosts of ice_thickness, too, so they have to be up to date.
+      m_impl->residual.update_ghosts();
+
       // Add residual to ice thickness, preserving total ice mass. (This is not great, but
       // better than losing mass.)
       ice_thickness.add(1.0, m_impl->residual);
@@ -805,7 +860,307 @@ void GeometryEvolution::update_in_place(double dt,
   }
 }
 
+/*!
+ * Compute cell types and surface elevations in the star stencil around (i,j).
+ *
+ * Both depend on sea level, bed elevation and ice thickness at a given location only, so
+ * there is no need to re-compute them everywhere after a local change in ice thickness.
+ */
+static void geometry_star(const GeometryCalculator &gc,
+                          const IceModelVec2S &sea_level,
+                          const IceModelVec2S &bed_topography,
+                          const IceModelVec2S &ice_thickness,
+                          int i, int j,
+                          StarStencil<int> &cell_type,
+                          StarStencil<double> &surface_elevation) {
+  const StarStencil<double>
+    z_s = sea_level.star(i, j),
+    b   = bed_topography.star(i, j),
+    H   = ice_thickness.star(i, j);
+
+  gc.compute(z_s.ij, b.ij, H.ij, &cell_type.ij, &surface_elevation.ij);
+  gc.compute(z_s.e,  b.e,  H.e,  &cell_type.e,  &surface_elevation.e);
+  gc.compute(z_s.w,  b.w,  H.w,  &cell_type.w,  &surface_elevation.w);
+  gc.compute(z_s.n,  b.n,  H.n,  &cell_type.n,  &surface_elevation.n);
+  gc.compute(z_s.s,  b.s,  H.s,  &cell_type.s,  &surface_elevation.s);
+}
+
+//! Returns true if (i,j) is in the sub-domain owned by this process.
+static inline bool owned(const IceGrid &grid, int i, int j) {
+  return (i >= grid.xs() and i < grid.xs() + grid.xm() and
+          j >= grid.ys() and j < grid.ys() + grid.ym());
+}
+
+//! Returns true if a ghost neighbor of (i,j) has positive residual.
+static bool next_to_ghost_residual(const IceGrid &grid, const IceModelVec2S &residual,
+                                   int i, int j) {
+  const int
+    di[4] = {0, 1, 0, -1},
+    dj[4] = {1, 0, -1, 0};
+
+  for (unsigned int n = 0; n < 4; ++n) {
+    const int
+      i_n = i + di[n],
+      j_n = j + dj[n];
+
+    if (not owned(grid, i_n, j_n) and residual(i_n, j_n) > 0.0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//! @brief Redistribute residual ice mass produced by the part-grid scheme.
+/*!
+  Residual ice volume in a cell is distributed equally among adjacent ice-free ocean cells,
+  adding to their area specific volume. Partially filled cells that become full are
+  converted to ice thickness, possibly producing new residual. This is repeated until no
+  residual remains or `max_iterations` is reached.
+
+  Residual and partially filled cells live along the calving front, so this code keeps a
+  list of owned cells with positive residual or area specific volume (the "front") and
+  processes only these cells and their neighbors. Each iteration costs O(front length)
+  plus two ghost exchanges and one global reduction instead of several sweeps over the
+  whole grid.
+
+  @param[in] bed_topography bed elevation (ghosted)
+  @param[in] sea_level sea level elevation (ghosted)
+  @param[in,out] ice_thickness ice thickness (ghosted); updated
+  @param[in,out] area_specific_volume area specific volume; updated
+  @param[in,out] residual ice volume that still needs to be distributed (ghosted); updated
+  @param[in] max_iterations maximum number of iterations
+
+  @return true if all residual ice volume was redistributed
+ */
+bool GeometryEvolution::redistribute_residual(const IceModelVec2S &bed_topography,
+                                              const IceModelVec2S &sea_level,
+                                              IceModelVec2S       &ice_thickness,
+                                              IceModelVec2S       &area_specific_volume,
+                                              IceModelVec2S       &residual,
+                                              int max_iterations) {
+  typedef std::pair<int, int> Cell;
+
+  const GeometryCalculator &gc = m_impl->gc;
+
+  const Direction directions[4] = {North, East, South, West};
+  // offsets corresponding to directions above
+  const int
+    di[4] = {0, 1, 0, -1},
+    dj[4] = {1, 0, -1, 0};
+
+  const int
+    xs = m_grid->xs(),
+    xm = m_grid->xm(),
+    ys = m_grid->ys(),
+    ym = m_grid->ym();
+
+  IceModelVec::AccessList list{&bed_topography, &sea_level, &ice_thickness,
+                               &area_specific_volume, &residual};
+
+  // Owned cells with positive residual or area specific volume. Residual ice can only
+  // appear in these cells and is moved to them.
+  std::set<Cell> front;
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    if (residual(i, j) > 0.0 or area_specific_volume(i, j) > 0.0) {
+      front.insert(Cell(i, j));
+    }
+  }
+
+  for (int iteration = 0; iteration < max_iterations; ++iteration) {
+    m_log->message(4, "redistribution iteration %d\n", iteration);
+
+    // First step: distribute residual mass
+    //
+    // Note: cell types used here correspond to ice thickness at the beginning of this
+    // step.
+    {
+      // cells with residual and the number of their empty or partially filled neighbors
+      std::vector<std::pair<Cell, int> > sources;
+      // cell types of sources (their thickness may change below)
+      std::map<Cell, int> source_cell_type;
+      // owned ice-free ocean cells next to sources
+      std::set<Cell> receivers;
+
+      StarStencil<int> m;
+      StarStencil<double> unused;
+
+      for (const auto &c : front) {
+        const int i = c.first, j = c.second;
+
+        if (residual(i, j) <= 0.0) {
+          continue;
+        }
+
+        geometry_star(gc, sea_level, bed_topography, ice_thickness, i, j, m, unused);
+
+        int N = 0; // number of empty or partially filled neighbors
+        for (unsigned int n = 0; n < 4; ++n) {
+          if (ice_free_ocean(m[directions[n]])) {
+            N++;
+
+            const int
+              i_n = i + di[n],
+              j_n = j + dj[n];
+
+            if (owned(*m_grid, i_n, j_n)) {
+              receivers.insert(Cell(i_n, j_n));
+            }
+          }
+        }
+
+        sources.push_back(std::make_pair(c, N));
+        source_cell_type[c] = m.ij;
+      }
+
+      for (const auto &s : sources) {
+        const int
+          i = s.first.first,
+          j = s.first.second,
+          N = s.second;
+
+        if (N > 0)  {
+          // Remaining ice mass will be redistributed equally among all adjacent
+          // ice-free-ocean cells (is there a more physical way?)
+          residual(i, j) /= N;
+        } else {
+          // Conserve mass, but (possibly) create a "ridge" at the shelf
+          // front
+          ice_thickness(i, j) += residual(i, j);
+          residual(i, j) = 0.0;
+        }
+      }
+
+      residual.update_ghosts();
+
+      // Owned cells next to ghosts with residual (i.e. residual distributed by
+      // neighboring sub-domains) may receive residual, too. Check the boundary of the
+      // sub-domain.
+      {
+        const int
+          rows[2]    = {ys, ys + ym - 1},
+          columns[2] = {xs, xs + xm - 1};
+
+        for (int k = 0; k < 2; ++k) {
+          for (int i = xs; i < xs + xm; ++i) {
+            if (next_to_ghost_residual(*m_grid, residual, i, rows[k])) {
+              receivers.insert(Cell(i, rows[k]));
+            }
+          }
+          for (int j = ys; j < ys + ym; ++j) {
+            if (next_to_ghost_residual(*m_grid, residual, columns[k], j)) {
+              receivers.insert(Cell(columns[k], j));
+            }
+          }
+        }
+      }
+
+      // update area_specific_volume using adjusted residuals
+      for (const auto &c : receivers) {
+        const int i = c.first, j = c.second;
+
+        auto it = source_cell_type.find(c);
+        const int cell_type = (it != source_cell_type.end() ?
+                               it->second :
+                               gc.mask(sea_level(i, j), bed_topography(i, j), ice_thickness(i, j)));
+
+        if (ice_free_ocean(cell_type)) {
+          area_specific_volume(i, j) += (residual(i + 1, j) +
+                                         residual(i - 1, j) +
+                                         residual(i, j + 1) +
+                                         residual(i, j - 1));
+          front.insert(c);
+        }
+      }
+
+      for (const auto &s : sources) {
+        residual(s.first.first, s.first.second) = 0.0;
+      }
+    }
+
+    ice_thickness.update_ghosts();
+
+    double remaining_residual = 0.0;
+
+    // Second step: we need to redistribute residual ice volume if
+    // neighbors which gained redistributed ice also become full.
+    {
+      // Compute all thresholds before modifying ice thickness. (Note that
+      // part_grid_threshold_thickness uses neighboring values of the mask, ice thickness,
+      // and surface elevation.)
+      std::vector<std::pair<Cell, double> > full;
+
+      StarStencil<int> m;
+      StarStencil<double> surface_elevation;
+
+      for (const auto &c : front) {
+        const int i = c.first, j = c.second;
+
+        if (area_specific_volume(i, j) <= 0.0) {
+          continue;
+        }
+
+        geometry_star(gc, sea_level, bed_topography, ice_thickness, i, j, m, surface_elevation);
+
+        double threshold = part_grid_threshold_thickness(m,
+                                                         ice_thickness.star(i, j),
+                                                         surface_elevation,
+                                                         bed_topography(i, j));
+
+        // if threshold is zero, turn all the area specific volume into ice thickness, with zero
+        // residual
+        if (threshold == 0.0) {
+          threshold = area_specific_volume(i, j);
+        }
+
+        if (area_specific_volume(i, j) >= threshold) {
+          full.push_back(std::make_pair(c, threshold));
+        }
+      }
+
+      for (const auto &f : full) {
+        const int
+          i = f.first.first,
+          j = f.first.second;
+        const double threshold = f.second;
+
+        ice_thickness(i, j)        += threshold;
+        residual(i, j)              = area_specific_volume(i, j) - threshold;
+        area_specific_volume(i, j)  = 0.0;
+
+        remaining_residual += residual(i, j);
+      }
+    }
+
+    // remove cells that no longer have residual or area specific volume from the front
+    for (auto it = front.begin(); it != front.end(); ) {
+      const int i = it->first, j = it->second;
+
+      if (residual(i, j) > 0.0 or area_specific_volume(i, j) > 0.0) {
+        ++it;
+      } else {
+        it = front.erase(it);
+      }
+    }
+
+    // check if redistribution should be run once more
+    remaining_residual = GlobalSum(m_grid->com, remaining_residual);
+
+    ice_thickness.update_ghosts();
+
+    if (not (remaining_residual > 0.0)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 //! @brief Perform one iteration of the residual mass redistribution.
+//!
+//! This is the full-grid version of redistribute_residual(), used if
+//! `geometry.part_grid.front_local_redistribution` is not set.
 /*!
   @param[in] bed_topography bed elevation
   @param[in] sea_level sea level elevation
@@ -942,6 +1297,27 @@ void GeometryEvolution::residual_redistribution_iteration(const IceModelVec2S  &
   ice_thickness.update_ghosts();
 }
 
+/*!
+ * Correct changes `dH` and `dV` of ice thickness `H` and area specific volume `V` in one
+ * grid cell so that applying them does not result in negative values. Sets `error` to the
+ * amount of ice added to preserve non-negativity.
+ */
+static inline void preserve_nonnegativity(double H, double V,
+                                          double &dH, double &dV, double &error) {
+  error = 0.0;
+
+  // applying thickness_change will lead to negative thickness
+  if (H + dH < 0.0) {
+    error += - (H + dH);
+    dH     = H;
+  }
+
+  if (V + dV < 0.0) {
+    error += - (V + dV);
+    dV     = V;
+  }
+}
+
 /*!
  * Correct `thickness_change` and `area_specific_volume_change` so that applying them will not
  * result in negative `ice_thickness` and `area_specific_volume`.
@@ -971,31 +1347,110 @@ void GeometryEvolution::ensure_nonnegativity(const IceModelVec2S &ice_thickness,
     for (Points p(*m_grid); p; p.next()) {
       const int i = p.i(), j = p.j();
 
-      conservation_error(i, j) = 0.0;
+      preserve_nonnegativity(ice_thickness(i, j), area_specific_volume(i, j),
+                             thickness_change(i, j), area_specific_volume_change(i, j),
+                             conservation_error(i, j));
+    }
+  } catch (...) {
+    loop.failed();
+  }
+  loop.check();
+}
 
-      const double
-        H  = ice_thickness(i, j),
-        dH = thickness_change(i, j);
+/*!
+ * Compute fluxes, flux divergence, thickness changes due to flow and the conservation
+ * error in one sweep over the grid.
+ *
+ * This is equivalent to compute_interface_fluxes(), compute_flux_divergence(),
+ * update_in_place() and ensure_nonnegativity() in runs that do not use the part-grid
+ * scheme and produces identical results. Each cell computes fluxes through all four of
+ * its interfaces (using the same code as compute_interface_fluxes()), so there is no need
+ * to store fluxes and update their ghosts before computing the divergence. Ice thickness
+ * is not updated in place, which removes the copy of the old thickness, the cell type mask
+ * re-computation and the ice thickness ghost update.
+ *
+ * Uses ghosts of `diffusive_flux` and of the ghosted copies of inputs prepared in
+ * flow_step().
+ */
+void GeometryEvolution::fused_flow_step(const Geometry &geometry, double dt,
+                                        const IceModelVec2Stag &diffusive_flux,
+                                        const IceModelVec2Int &thickness_bc_mask) {
+  const double
+    dx = m_grid->dx(),
+    dy = m_grid->dy();
+
+  const IceModelVec2CellType &cell_type        = m_impl->cell_type;
+  const IceModelVec2S        &ice_thickness    = m_impl->ice_thickness;
+  const IceModelVec2V        &velocity         = m_impl->input_velocity;
+  const IceModelVec2Int      &velocity_bc_mask = m_impl->velocity_bc_mask;
+
+  IceModelVec2Stag &flux            = m_impl->flux_staggered;
+  IceModelVec2S    &flux_divergence = m_impl->flux_divergence;
+
+  IceModelVec::AccessList list{&cell_type, &ice_thickness, &velocity, &velocity_bc_mask,
+                               &diffusive_flux, &thickness_bc_mask,
+                               &geometry.ice_area_specific_volume,
+                               &flux, &flux_divergence, &m_impl->thickness_change,
+                               &m_impl->ice_area_specific_volume_change,
+                               &m_impl->conservation_error};
+
+#if (Pism_DEBUG==1)
+  const double Lz = m_grid->Lz();
+#endif
+
+  ParallelSection loop(m_grid->com);
+  try {
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
 
-      // applying thickness_change will lead to negative thickness
-      if (H + dH < 0.0) {
-        thickness_change(i, j)    = H;
-        conservation_error(i, j) += - (H + dH);
+      const double
+        Q_e = interface_flux(cell_type, ice_thickness, velocity, velocity_bc_mask,
+                             diffusive_flux, i, j, 0),
+        Q_n = interface_flux(cell_type, ice_thickness, velocity, velocity_bc_mask,
+                             diffusive_flux, i, j, 1),
+        Q_w = interface_flux(cell_type, ice_thickness, velocity, velocity_bc_mask,
+                             diffusive_flux, i - 1, j, 0),
+        Q_s = interface_flux(cell_type, ice_thickness, velocity, velocity_bc_mask,
+                             diffusive_flux, i, j - 1, 1);
+
+      flux(i, j, 0) = Q_e;
+      flux(i, j, 1) = Q_n;
+
+      double divQ = 0.0;
+      if (thickness_bc_mask(i, j) <= 0.5) {
+        divQ = (Q_e - Q_w) / dx + (Q_n - Q_s) / dy;
       }
+      flux_divergence(i, j) = divQ;
 
       const double
-        V  = area_specific_volume(i, j),
-        dV = area_specific_volume_change(i, j);
+        H     = ice_thickness(i, j),
+        H_new = H + (- dt * divQ);
 
-      if (V + dV < 0.0) {
-        area_specific_volume_change(i, j)  = V;
-        conservation_error(i, j)          += - (V + dV);
+#if (Pism_DEBUG==1)
+      if (H_new > Lz) {
+        throw RuntimeError::formatted(PISM_ERROR_LOCATION, "ice thickness exceeds Lz at i=%d, j=%d (H=%f, Lz=%f)",
+                                      i, j, H_new, Lz);
       }
+#endif
+
+      // area specific volume does not change without the part-grid scheme
+      double
+        dH = H_new - H,
+        dV = 0.0;
+
+      preserve_nonnegativity(H, geometry.ice_area_specific_volume(i, j),
+                             dH, dV, m_impl->conservation_error(i, j));
+
+      m_impl->thickness_change(i, j)                = dH;
+      m_impl->ice_area_specific_volume_change(i, j) = dV;
     }
   } catch (...) {
     loop.failed();
   }
   loop.check();
+
+  // flux_staggered() is documented as ghosted
+  flux.update_ghosts();
 }
 
 /*!
@@ -1150,6 +1605,9 @@ RegionalGeometryEvolution::RegionalGeometryEvolution(IceGrid::ConstPtr grid)
 
   m_no_model_mask.create(m_grid, "no_model_mask", WITH_GHOSTS);
   m_no_model_mask.set_attrs("model_mask", "'no model' mask", "", "", "", 0);
+
+  // fused_flow_step() does not support the "no model" mask
+  m_impl->use_fused_kernel = false;
 }
 
 void RegionalGeometryEvolution::set_no_model_mask_impl(const IceModelVec2Int &mask) {
@@ -82,6 +82,13 @@ protected:
                        IceModelVec2S& ice_thickness,
                        IceModelVec2S& area_specific_volume);
 
+  bool redistribute_residual(const IceModelVec2S &bed_topography,
+                             const IceModelVec2S &sea_level,
+                             IceModelVec2S &ice_thickness,
+                             IceModelVec2S &area_specific_volume,
+                             IceModelVec2S &residual,
+                             int max_iterations);
+
   void residual_redistribution_iteration(const IceModelVec2S& bed_topography,
                                          const IceModelVec2S& sea_level,
                                          IceModelVec2S& ice_surface_elevation,
@@ -108,6 +115,10 @@ protected:
                                     IceModelVec2S &area_specific_volume_change,
                                     IceModelVec2S &conservation_error);
 
+  void fused_flow_step(const Geometry &geometry, double dt,
+                       const IceModelVec2Stag &diffusive_flux,
+                       const IceModelVec2Int &thickness_bc_mask);
+
   virtual void set_no_model_mask_impl(const IceModelVec2Int &mask);
 
   // note: cells with area_specific_volume > 0 do not experience changes due to surface and basal
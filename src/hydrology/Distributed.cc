@@ -34,7 +34,9 @@ namespace hydrology {
 Distributed::Distributed(IceGrid::ConstPtr g)
   : Routing(g),
     m_P(m_grid, "bwp", WITH_GHOSTS, 1),
-    m_Pnew(m_grid, "Pnew_internal", WITHOUT_GHOSTS) {
+    m_Pnew(m_grid, "Pnew_internal", WITHOUT_GHOSTS),
+    m_implicit_dt(0.0),
+    m_implicit_inputs(NULL) {
 
   // additional variables beyond hydrology::Routing
   m_P.set_attrs("model_state",
@@ -46,6 +48,17 @@ Distributed::Distributed(IceGrid::ConstPtr g)
                    "new transportable subglacial water pressure during update",
                    "Pa", "Pa", "", 0);
   m_Pnew.metadata().set_number("valid_min", 0.0);
+
+  m_residual_constants.n    = m_config->get_number("stress_balance.sia.Glen_exponent");
+  m_residual_constants.A    = m_config->get_number("flow_law.isothermal_Glen.ice_softness");
+  m_residual_constants.c1   = m_config->get_number("hydrology.cavitation_opening_coefficient");
+  m_residual_constants.c2   = m_config->get_number("hydrology.creep_closure_coefficient");
+  m_residual_constants.Wr   = m_config->get_number("hydrology.roughness_scale");
+  m_residual_constants.phi0 = m_config->get_number("hydrology.regularizing_porosity");
+
+  if (m_implicit) {
+    m_P_iterate.create(m_grid, "P_iterate", WITH_GHOSTS, 1);
+  }
 }
 
 Distributed::~Distributed() {
@@ -55,6 +68,11 @@ Distributed::~Distributed() {
 void Distributed::initialization_message() const {
   m_log->message(2,
                  "* Initializing the distributed, linked-cavities subglacial hydrology model...\n");
+
+  if (m_implicit) {
+    m_log->message(2,
+                   "  ... using implicit (backward Euler) time stepping for W and P.\n");
+  }
 }
 
 void Distributed::restart_impl(const File &input_file, int record) {
@@ -303,6 +321,327 @@ void Distributed::update_P(double dt,
 }
 
 
+//! Allocate the nonlinear solver used by the implicit time stepping method.
+void Distributed::create_WP_solver() {
+  PetscErrorCode ierr;
+
+  // Create a DM with two degrees of freedom per grid point (W and P) and the same domain
+  // decomposition as the grid. We don't use m_grid->get_dm() because DMs owned by the grid
+  // are shared and the SNES callback would be attached to a shared DM.
+  {
+    petsc::DM::Ptr da = m_W_rhs.dm();
+
+    PetscInt m = 0, n = 0;
+    ierr = DMDAGetInfo(*da, NULL, NULL, NULL, NULL, &m, &n,
+                       NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    PISM_CHK(ierr, "DMDAGetInfo");
+
+    const PetscInt *lx = NULL, *ly = NULL;
+    ierr = DMDAGetOwnershipRanges(*da, &lx, &ly, NULL);
+    PISM_CHK(ierr, "DMDAGetOwnershipRanges");
+
+    DM dm;
+    ierr = DMDACreate2d(m_grid->com,
+                        DM_BOUNDARY_PERIODIC, DM_BOUNDARY_PERIODIC,
+                        DMDA_STENCIL_BOX,
+                        m_grid->Mx(), m_grid->My(),
+                        m, n,
+                        2, 1,     // dof, stencil width
+                        lx, ly,
+                        &dm);
+    PISM_CHK(ierr, "DMDACreate2d");
+
+#if PETSC_VERSION_GE(3,8,0)
+    ierr = DMSetUp(dm); PISM_CHK(ierr, "DMSetUp");
+#endif
+
+    m_WP_dm.reset(new petsc::DM(dm));
+  }
+
+  ierr = DMSetMatType(*m_WP_dm, MATAIJ);
+  PISM_CHK(ierr, "DMSetMatType");
+
+  ierr = DMCreateMatrix(*m_WP_dm, m_J.rawptr());
+  PISM_CHK(ierr, "DMCreateMatrix");
+
+  ierr = DMCreateGlobalVector(*m_WP_dm, m_X.rawptr());
+  PISM_CHK(ierr, "DMCreateGlobalVector");
+
+  ierr = VecDuplicate(m_X, m_X_lower.rawptr());
+  PISM_CHK(ierr, "VecDuplicate");
+
+  ierr = VecDuplicate(m_X, m_X_upper.rawptr());
+  PISM_CHK(ierr, "VecDuplicate");
+
+  ierr = SNESCreate(m_grid->com, m_snes.rawptr());
+  PISM_CHK(ierr, "SNESCreate");
+
+  ierr = SNESSetOptionsPrefix(m_snes, "hydrology_");
+  PISM_CHK(ierr, "SNESSetOptionsPrefix");
+
+  m_callback_data.da = *m_WP_dm;
+  m_callback_data.model = this;
+
+  ierr = DMDASNESSetFunctionLocal(*m_WP_dm, INSERT_VALUES,
+                                  (DMDASNESFunction)function_callback,
+                                  &m_callback_data);
+  PISM_CHK(ierr, "DMDASNESSetFunctionLocal");
+
+  ierr = SNESSetDM(m_snes, *m_WP_dm);
+  PISM_CHK(ierr, "SNESSetDM");
+
+  // Approximate the Jacobian using finite differences and coloring (the residual at a
+  // grid point depends on W and P in the box stencil of width 1 around it).
+  ierr = SNESSetJacobian(m_snes, m_J, m_J, SNESComputeJacobianDefaultColor, NULL);
+  PISM_CHK(ierr, "SNESSetJacobian");
+
+  // Use a variational inequality solver to enforce W >= 0 and 0 <= P <= P_overburden.
+  ierr = SNESSetType(m_snes, SNESVINEWTONRSLS);
+  PISM_CHK(ierr, "SNESSetType");
+
+  ierr = SNESSetFromOptions(m_snes);
+  PISM_CHK(ierr, "SNESSetFromOptions");
+}
+
+//! Evaluate the residual of the coupled W-P system.
+/*!
+  The water thickness equation is the same as in Routing. The pressure equation is a
+  backward Euler discretization of the equation used in update_P(), scaled by
+  @f$ \phi_0 / (\rho_w g) @f$ so that both components of the residual are in meters.
+
+  Uses the same cell type rules as update_P(): P is zero in ice-free land areas and
+  equal to the overburden pressure in the ocean and where there was no water at the
+  beginning of the step.
+*/
+void Distributed::compute_WP_residual(const WP * const *x, WP **f) {
+  const Inputs &inputs = *m_implicit_inputs;
+  const double dt = m_implicit_dt;
+
+  const IceModelVec2CellType &cell_type = inputs.geometry->cell_type;
+  const IceModelVec2S &sliding_speed = *inputs.ice_sliding_speed;
+
+  // this is called once per residual evaluation, so we don't query the configuration here
+  const double
+    n    = m_residual_constants.n,
+    A    = m_residual_constants.A,
+    c1   = m_residual_constants.c1,
+    c2   = m_residual_constants.c2,
+    Wr   = m_residual_constants.Wr,
+    phi0 = m_residual_constants.phi0;
+
+  const double
+    C   = phi0 / m_rg,
+    wux = 1.0 / (m_dx * m_dx),
+    wuy = 1.0 / (m_dy * m_dy);
+
+  // copy the current iterate (including ghosts)
+  {
+    IceModelVec::AccessList list{&m_W_iterate, &m_P_iterate};
+
+    for (PointsWithGhosts p(*m_grid, 1); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      m_W_iterate(i, j) = x[j][i].W;
+      m_P_iterate(i, j) = x[j][i].P;
+    }
+  }
+
+  // re-use the computation of fluxes from the explicit code (updates ghosts)
+  water_thickness_staggered(m_W_iterate, cell_type, m_Wstag);
+
+  double maxKW = 0.0;
+  compute_conductivity(m_Wstag, m_P_iterate, m_bottom_surface, m_Kstag, maxKW);
+
+  compute_velocity(m_Wstag, m_P_iterate, m_bottom_surface, m_Kstag,
+                   inputs.no_model_mask, m_V_ghosted);
+  m_V_ghosted.update_ghosts();
+
+  advective_fluxes(m_V_ghosted, m_W_iterate, m_Qstag);
+
+  IceModelVec::AccessList list{&m_W, &m_P, &m_Wtill, &m_Wtillnew, &sliding_speed, &m_Wstag,
+                               &m_Kstag, &m_Qstag, &m_W_iterate, &m_surface_input_rate,
+                               &m_basal_melt_rate, &cell_type, &m_Pover};
+
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    auto w  = m_W_iterate.star(i, j);
+    auto q  = m_Qstag.star(i, j);
+    auto k  = m_Kstag.star(i, j);
+    auto ws = m_Wstag.star(i, j);
+
+    // compute the flux divergence the same way as in update_W()
+    const double divadflux = (q.e - q.w) / m_dx + (q.n - q.s) / m_dy;
+    const double
+      De = m_rg * k.e * ws.e,
+      Dw = m_rg * k.w * ws.w,
+      Dn = m_rg * k.n * ws.n,
+      Ds = m_rg * k.s * ws.s;
+
+    double diffW = (wux * (De * (w.e - w.ij) - Dw * (w.ij - w.w)) +
+                    wuy * (Dn * (w.n - w.ij) - Ds * (w.ij - w.s)));
+
+    double divflux = -divadflux + diffW;
+
+    double
+      Wtill_change = m_Wtillnew(i, j) - m_Wtill(i, j),
+      total_input  = m_surface_input_rate(i, j) + m_basal_melt_rate(i, j);
+
+    f[j][i].W = w.ij - m_W(i, j) - dt * (divflux + total_input) + Wtill_change;
+
+    const double
+      P   = x[j][i].P,
+      P_o = m_Pover(i, j);
+
+    if (cell_type.ice_free_land(i, j)) {
+      f[j][i].P = C * P;
+    } else if (cell_type.ocean(i, j) or m_W(i, j) <= 0.0) {
+      f[j][i].P = C * (P - P_o);
+    } else {
+      double
+        Open  = c1 * sliding_speed(i, j) * std::max(0.0, Wr - w.ij),
+        Close = c2 * A * pow(std::max(P_o - P, 0.0), n) * w.ij;
+
+      f[j][i].P = C * (P - m_P(i, j)) - dt * (divflux + Close - Open + total_input) + Wtill_change;
+    }
+  }
+}
+
+PetscErrorCode Distributed::function_callback(DMDALocalInfo *info,
+                                              const WP * const *x,
+                                              WP **f,
+                                              CallbackData *data) {
+  try {
+    (void) info;
+    data->model->compute_WP_residual(x, f);
+  } catch (...) {
+    MPI_Comm com = MPI_COMM_SELF;
+    PetscErrorCode ierr = PetscObjectGetComm((PetscObject)data->da, &com); CHKERRQ(ierr);
+    handle_fatal_errors(com);
+    SETERRQ(com, 1, "A PISM callback failed");
+  }
+  return 0;
+}
+
+//! Take one backward Euler step for the coupled W-P system.
+/*!
+  Solves the system using SNES (Newton's method with a finite difference Jacobian),
+  re-using the computation of the staggered grid water thickness, conductivity, velocity
+  and advective flux from Routing. Enforces @f$ W \ge 0 @f$ and @f$ 0 \le P \le P_o @f$
+  by solving a variational inequality.
+
+  Puts the result in `m_Wnew` and updates `m_P` if the solver converged.
+*/
+bool Distributed::implicit_step(double dt, const Inputs &inputs) {
+  PetscErrorCode ierr;
+
+  if (m_snes.get() == NULL) {
+    create_WP_solver();
+  }
+
+  m_implicit_dt     = dt;
+  m_implicit_inputs = &inputs;
+
+  // initial guess and bounds
+  {
+    petsc::DMDAVecArray
+      X(m_WP_dm, m_X),
+      X_lower(m_WP_dm, m_X_lower),
+      X_upper(m_WP_dm, m_X_upper);
+
+    WP
+      **x       = (WP**)X.get(),
+      **x_lower = (WP**)X_lower.get(),
+      **x_upper = (WP**)X_upper.get();
+
+    IceModelVec::AccessList list{&m_W, &m_P, &m_Pover};
+
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      x[j][i].W = m_W(i, j);
+      x[j][i].P = clip(m_P(i, j), 0.0, m_Pover(i, j));
+
+      x_lower[j][i].W = 0.0;
+      x_lower[j][i].P = 0.0;
+
+      x_upper[j][i].W = PETSC_INFINITY;
+      x_upper[j][i].P = m_Pover(i, j);
+    }
+  }
+
+  ierr = SNESVISetVariableBounds(m_snes, m_X_lower, m_X_upper);
+  PISM_CHK(ierr, "SNESVISetVariableBounds");
+
+  ierr = SNESSolve(m_snes, NULL, m_X);
+  PISM_CHK(ierr, "SNESSolve");
+
+  SNESConvergedReason reason;
+  ierr = SNESGetConvergedReason(m_snes, &reason);
+  PISM_CHK(ierr, "SNESGetConvergedReason");
+
+  if (reason < 0) {
+    m_log->message(2,
+                   "  SNES failed while computing water thickness and pressure: %s\n",
+                   SNESConvergedReasons[reason]);
+    return false;
+  }
+
+  PetscInt iterations = 0;
+  ierr = SNESGetIterationNumber(m_snes, &iterations);
+  PISM_CHK(ierr, "SNESGetIterationNumber");
+  m_log->message(4, "    SNES converged in %d iterations\n", (int)iterations);
+
+  // extract the solution
+  {
+    petsc::DMDAVecArray X(m_WP_dm, m_X);
+    WP **x = (WP**)X.get();
+
+    IceModelVec::AccessList list{&m_Wnew, &m_Pnew};
+
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      m_Wnew(i, j) = x[j][i].W;
+      m_Pnew(i, j) = x[j][i].P;
+    }
+  }
+
+  // water thickness at the end of the step if there was no flow (used to compute the
+  // change due to flow)
+  {
+    IceModelVec::AccessList list{&m_W, &m_Wtill, &m_Wtillnew, &m_surface_input_rate,
+                                 &m_basal_melt_rate, &m_W_rhs};
+
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      double input_rate = m_surface_input_rate(i, j) + m_basal_melt_rate(i, j);
+
+      double Wtill_change = m_Wtillnew(i, j) - m_Wtill(i, j);
+      m_W_rhs(i, j) = m_W(i, j) + (dt * input_rate - Wtill_change);
+    }
+  }
+
+  // velocity corresponding to the solution (used to compute the advective flux)
+  m_W_iterate.copy_from(m_Wnew);
+  m_P_iterate.copy_from(m_Pnew);
+
+  water_thickness_staggered(m_W_iterate, inputs.geometry->cell_type, m_Wstag);
+
+  double maxKW = 0.0;
+  compute_conductivity(m_Wstag, m_P_iterate, m_bottom_surface, m_Kstag, maxKW);
+
+  compute_velocity(m_Wstag, m_P_iterate, m_bottom_surface, m_Kstag,
+                   inputs.no_model_mask, m_V_ghosted);
+  m_V_ghosted.update_ghosts();
+
+  // the step is accepted: update P (updates ghosts)
+  m_P.copy_from(m_Pnew);
+
+  return true;
+}
+
 //! Update the model state variables W,P by running the subglacial hydrology model.
 /*!
   Runs the hydrology model from time t to time t + dt.  Here [t,dt]
@@ -311,6 +650,15 @@ void Distributed::update_P(double dt,
 */
 void Distributed::update_impl(double t, double dt, const Inputs& inputs) {
 
+  if (m_implicit) {
+    // ice dynamics can change overburden pressure
+    check_P_bounds(m_P, m_Pover, true);
+    m_P.update_ghosts();
+
+    update_implicit(t, dt, inputs);
+    return;
+  }
+
   ice_bottom_surface(*inputs.geometry, m_bottom_surface);
 
   double
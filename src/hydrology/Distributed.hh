@@ -20,6 +20,8 @@
 #define _DISTRIBUTED_H_
 
 #include "Routing.hh"
+#include "pism/util/petscwrappers/SNES.hh"
+#include "pism/util/petscwrappers/Vec.hh"
 
 namespace pism {
 
@@ -89,9 +91,53 @@ protected:
                 const IceModelVec2Stag &K,
                 const IceModelVec2Stag &Q,
                 IceModelVec2S &P_new) const;
+
+  bool implicit_step(double dt, const Inputs &inputs);
 protected:
   IceModelVec2S m_P;
   IceModelVec2S m_Pnew;
+
+  // implicit solver for the coupled W-P system
+
+  //! Unknowns at a grid point.
+  struct WP {
+    double W, P;
+  };
+
+  struct CallbackData {
+    DM da;
+    Distributed *model;
+  };
+
+  CallbackData m_callback_data;
+
+  petsc::DM::Ptr m_WP_dm;
+  petsc::SNES m_snes;
+  petsc::Mat m_J;
+  petsc::Vec m_X, m_X_lower, m_X_upper;
+
+  // ghosted pressure iterate (allocated in implicit mode only)
+  IceModelVec2S m_P_iterate;
+
+  //! Constants used by compute_WP_residual() (read from the configuration once).
+  struct ResidualConstants {
+    double n, A, c1, c2, Wr, phi0;
+  };
+
+  ResidualConstants m_residual_constants;
+
+  // the time step length and inputs used by the residual evaluation
+  double m_implicit_dt;
+  const Inputs *m_implicit_inputs;
+
+  void create_WP_solver();
+
+  void compute_WP_residual(const WP * const *x, WP **f);
+
+  static PetscErrorCode function_callback(DMDALocalInfo *info,
+                                          const WP * const *x,
+                                          WP **f,
+                                          CallbackData *data);
 private:
   void initialization_message() const;
 };
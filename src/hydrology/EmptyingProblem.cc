@@ -17,6 +17,13 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <queue>                // std::priority_queue
+#include <vector>
+#include <utility>              // std::pair
+#include <functional>           // std::greater
+#include <algorithm>            // std::sort
+#include <limits>               // std::numeric_limits
+
 #include "EmptyingProblem.hh"
 
 #include "pism/geometry/Geometry.hh"
@@ -162,6 +169,16 @@ EmptyingProblem::EmptyingProblem(IceGrid::ConstPtr grid)
   m_dx  = m_grid->dx();
   m_dy  = m_grid->dy();
   m_tau = m_config->get_number("hydrology.steady.input_rate_scaling");
+
+  m_priority_flood = m_config->get_string("hydrology.steady.method") == "priority_flood";
+
+  if (m_priority_flood) {
+    m_volume_flux_ratio.create(grid, "volume_flux_ratio", WITH_GHOSTS, 1);
+    m_volume_flux_ratio.set_attrs("internal",
+                                  "ratio of the water volume in a cell to the volume flux"
+                                  " through its outflow faces",
+                                  "m s", "m s", "", 0);
+  }
 }
 
 EmptyingProblem::~EmptyingProblem() {
@@ -243,6 +260,23 @@ void EmptyingProblem::update(const Geometry &geometry,
     return;
   }
 
+  if (m_priority_flood) {
+    // m_W contains the (scaled) water input; updates ghosts of m_Qsum
+    accumulate_flow(m_domain_mask, m_potential, m_Vstag, m_W, m_Qsum);
+
+    // all the water is routed to the boundary of the domain
+    m_W.set(0.0);
+
+    staggered_to_regular(geometry.cell_type, m_Qsum,
+                         true,    // include floating ice
+                         m_Q);
+    m_Q.scale(1.0 / m_tau);
+
+    diagnostics::effective_water_velocity(geometry, m_Q, m_q_sg);
+
+    return;
+  }
+
   double volume = 0.0;
   int step_counter = 0;
 
@@ -347,6 +381,12 @@ void EmptyingProblem::compute_potential(const IceModelVec2S &ice_thickness,
 
   compute_raw_potential(ice_thickness, ice_bottom_surface, result);
 
+  if (m_priority_flood) {
+    // updates ghosts of result
+    fill_depressions(domain_mask, result);
+    return;
+  }
+
   IceModelVec::AccessList list{&result, &psi_new, &domain_mask};
   for (step_counter = 0; step_counter < n_iterations; ++step_counter) {
 
@@ -397,6 +437,315 @@ void EmptyingProblem::compute_potential(const IceModelVec2S &ice_thickness,
 }
 
 
+/*!
+ * Fill depressions in the hydraulic potential, making sure that there are no sinks in the
+ * domain.
+ *
+ * This is a graph-based alternative to the iterative method in compute_potential() using
+ * the priority-flood algorithm (see Barnes, Lehman, and Mulla, 2014).
+ *
+ * Cells outside the domain (`domain_mask` is zero) and domain cells at the edge of the
+ * grid are outlets. Cells are visited in the order of increasing potential, starting from
+ * outlets. A cell that is not higher than the cell it was reached from is raised to the
+ * potential of that cell plus `delta`, so water can flow from every cell in the domain to
+ * an outlet.
+ *
+ * Each rank floods its subdomain, treating ghost cells as outlets with the potential
+ * computed by neighboring ranks during the previous pass (ghosts that were not reached yet
+ * are ignored). Passes are repeated until the potential stops changing. Filled values
+ * can only decrease from one pass to the next, so the number of passes is bounded by the
+ * number of times a path to an outlet crosses subdomain boundaries.
+ *
+ * Updates ghosts of `result`.
+ */
+void EmptyingProblem::fill_depressions(const IceModelVec2Int &domain_mask,
+                                       IceModelVec2S &result) const {
+  // (potential, index) pairs
+  typedef std::pair<double, int> Cell;
+
+  const double
+    delta    = m_config->get_number("hydrology.steady.potential_delta"),
+    infinity = std::numeric_limits<double>::infinity();
+
+  const int
+    Mx = m_grid->Mx(),
+    My = m_grid->My(),
+    xs = m_grid->xs(),
+    xm = m_grid->xm(),
+    ys = m_grid->ys(),
+    ym = m_grid->ym(),
+    // width of the local array (includes one row of ghosts on each side)
+    nx = xm + 2,
+    N  = nx * (ym + 2);
+
+  // index of a point in the local array
+  auto index = [=](int i, int j) { return (j - ys + 1) * nx + (i - xs + 1); };
+  auto owned = [=](int i, int j) {
+    return i >= xs and i < xs + xm and j >= ys and j < ys + ym;
+  };
+
+  std::vector<double> psi(N, 0.0), filled(N, infinity);
+  std::vector<bool> outlet(N, false), closed(N, false);
+
+  IceModelVec::AccessList list{&domain_mask, &result};
+
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j(), k = index(i, j);
+
+    psi[k] = result(i, j);
+
+    const bool edge = (i == 0 or i == Mx - 1 or j == 0 or j == My - 1);
+
+    outlet[k] = (domain_mask(i, j) < 0.5 or edge);
+
+    if (not outlet[k]) {
+      // not reached yet
+      result(i, j) = infinity;
+    }
+  }
+  result.update_ghosts();
+
+  const int
+    di[] = {1, -1, 0,  0},
+    dj[] = {0,  0, 1, -1};
+
+  int n_passes = 0;
+  while (true) {
+    ++n_passes;
+
+    std::priority_queue<Cell, std::vector<Cell>, std::greater<Cell> > queue;
+
+    for (PointsWithGhosts p(*m_grid, 1); p; p.next()) {
+      const int i = p.i(), j = p.j(), k = index(i, j);
+
+      closed[k] = false;
+      filled[k] = infinity;
+
+      if (owned(i, j)) {
+        if (outlet[k]) {
+          closed[k] = true;
+          filled[k] = psi[k];
+          queue.push(Cell(psi[k], k));
+        }
+      } else {
+        // ghosts are never modified here
+        closed[k] = true;
+
+        // skip periodic neighbors: edges of the grid are outlets
+        const bool in_grid = (i >= 0 and i < Mx and j >= 0 and j < My);
+
+        if (in_grid and result(i, j) < infinity) {
+          queue.push(Cell(result(i, j), k));
+        }
+      }
+    }
+
+    while (not queue.empty()) {
+      const double psi_k = queue.top().first;
+      const int k = queue.top().second;
+      queue.pop();
+
+      const int i = xs - 1 + k % nx, j = ys - 1 + k / nx;
+
+      for (int n = 0; n < 4; ++n) {
+        const int ii = i + di[n], jj = j + dj[n];
+
+        if (not owned(ii, jj)) {
+          continue;
+        }
+
+        const int m = index(ii, jj);
+
+        if (closed[m]) {
+          continue;
+        }
+        closed[m] = true;
+
+        filled[m] = psi[m] <= psi_k ? psi_k + delta : psi[m];
+
+        queue.push(Cell(filled[m], m));
+      }
+    }
+
+    int n_changed = 0;
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j(), k = index(i, j);
+
+      if (filled[k] != result(i, j)) {
+        result(i, j) = filled[k];
+        ++n_changed;
+      }
+    }
+    result.update_ghosts();
+
+    n_changed = GlobalSum(m_grid->com, n_changed);
+
+    if (n_changed == 0) {
+      break;
+    }
+  }
+
+  int n_filled = 0;
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    if (result(i, j) != psi[index(i, j)]) {
+      ++n_filled;
+    }
+  }
+  n_filled = GlobalSum(m_grid->com, n_filled);
+
+  m_log->message(3, "Emptying problem: priority-flood modified %d cells in %d passes.\n",
+                 n_filled, n_passes);
+}
+
+/*!
+ * Compute the steady state water flux (times `hydrology.steady.input_rate_scaling`) by
+ * accumulating water input `water_input` (in meters) along flow paths. The result is the
+ * water flux through cell faces (in m^2).
+ *
+ * The velocity on a face is directed from the cell with the higher hydraulic potential to
+ * the one with the lower, so processing cells in the order of decreasing potential visits
+ * a cell only after all the cells upstream of it. Each cell sends the water it collected
+ * through outflow faces; the fraction going through a face is proportional to the volume
+ * flux through it (as in the first-order upwind scheme used in update()). Water reaching a
+ * cell outside the domain or leaving the grid is removed.
+ *
+ * Let @f$ T @f$ be the volume of water collected in a cell divided by the total volume
+ * flux through its outflow faces. Then the water sent through a face is the volume flux
+ * through it times @f$ T @f$ in the upwind cell, so neighboring ranks need to exchange
+ * @f$ T @f$ only. Each rank processes its subdomain using @f$ T @f$ in ghost cells
+ * computed during the previous pass and passes are repeated until @f$ T @f$ stops
+ * changing (the number of passes is bounded by the number of times a flow path crosses
+ * subdomain boundaries).
+ *
+ * Requires a hydraulic potential without sinks (see fill_depressions()). Updates ghosts
+ * of `result`.
+ */
+void EmptyingProblem::accumulate_flow(const IceModelVec2Int &domain_mask,
+                                      const IceModelVec2S &hydraulic_potential,
+                                      const IceModelVec2Stag &velocity,
+                                      const IceModelVec2S &water_input,
+                                      IceModelVec2Stag &result) {
+  // (potential, index) pairs
+  typedef std::pair<double, int> Cell;
+
+  const int
+    Mx = m_grid->Mx(),
+    My = m_grid->My(),
+    xs = m_grid->xs(),
+    xm = m_grid->xm(),
+    ys = m_grid->ys(),
+    ym = m_grid->ym();
+
+  const double
+    dx = m_dx,
+    dy = m_dy;
+
+  // index of a point in this subdomain
+  auto index = [=](int i, int j) { return (j - ys) * xm + (i - xs); };
+  auto owned = [=](int i, int j) {
+    return i >= xs and i < xs + xm and j >= ys and j < ys + ym;
+  };
+
+  IceModelVec2S &T = m_volume_flux_ratio;
+  T.set(0.0);
+
+  std::vector<double> T_new(xm * ym, 0.0);
+  std::vector<Cell> cells;
+
+  IceModelVec::AccessList list{&domain_mask, &hydraulic_potential, &velocity,
+                               &water_input, &T, &result};
+
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    if (domain_mask(i, j) > 0.5) {
+      cells.push_back(Cell(hydraulic_potential(i, j), index(i, j)));
+    }
+  }
+
+  std::sort(cells.begin(), cells.end(), std::greater<Cell>());
+
+  int n_passes = 0;
+  while (true) {
+    ++n_passes;
+
+    std::fill(T_new.begin(), T_new.end(), 0.0);
+
+    // T in a neighbor: computed during this pass if it is in this subdomain, during the
+    // previous pass otherwise
+    auto T_n = [&](int i, int j) {
+      return owned(i, j) ? T_new[index(i, j)] : T(i, j);
+    };
+
+    for (unsigned int n = 0; n < cells.size(); ++n) {
+      const int
+        k = cells[n].second,
+        i = xs + k % xm,
+        j = ys + k / xm;
+
+      double volume = water_input(i, j) * dx * dy;
+
+      // water coming from neighbors in the grid
+      if (i + 1 < Mx) {
+        volume += T_n(i + 1, j) * std::max(-velocity(i, j, 0), 0.0) * dy;
+      }
+      if (i > 0) {
+        volume += T_n(i - 1, j) * std::max(velocity(i - 1, j, 0), 0.0) * dy;
+      }
+      if (j + 1 < My) {
+        volume += T_n(i, j + 1) * std::max(-velocity(i, j, 1), 0.0) * dx;
+      }
+      if (j > 0) {
+        volume += T_n(i, j - 1) * std::max(velocity(i, j - 1, 1), 0.0) * dx;
+      }
+
+      // volume flux through outflow faces
+      const double F = (std::max(velocity(i, j, 0), 0.0) * dy +
+                        std::max(-velocity(i - 1, j, 0), 0.0) * dy +
+                        std::max(velocity(i, j, 1), 0.0) * dx +
+                        std::max(-velocity(i, j - 1, 1), 0.0) * dx);
+
+      if (F > 0.0 and volume > 0.0) {
+        T_new[k] = volume / F;
+      }
+    }
+
+    int n_changed = 0;
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j(), k = index(i, j);
+
+      if (T_new[k] != T(i, j)) {
+        T(i, j) = T_new[k];
+        ++n_changed;
+      }
+    }
+    T.update_ghosts();
+
+    n_changed = GlobalSum(m_grid->com, n_changed);
+
+    if (n_changed == 0) {
+      break;
+    }
+  }
+
+  m_log->message(3, "Emptying problem: accumulated flow in %d passes.\n", n_passes);
+
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    const double
+      v_e = velocity(i, j, 0),
+      v_n = velocity(i, j, 1);
+
+    result(i, j, 0) = v_e * (v_e >= 0.0 ? T(i, j) : T(i + 1, j));
+    result(i, j, 1) = v_n * (v_n >= 0.0 ? T(i, j) : T(i, j + 1));
+  }
+
+  result.update_ghosts();
+}
+
 static double K(double psi_x, double psi_y, double speed, double epsilon) {
   return speed / std::max(Vector2(psi_x, psi_y).magnitude(), epsilon);
 }
@@ -71,6 +71,15 @@ protected:
                     const IceModelVec2Int *no_model_mask,
                     IceModelVec2Int &result) const;
 
+  void fill_depressions(const IceModelVec2Int &domain_mask,
+                        IceModelVec2S &result) const;
+
+  void accumulate_flow(const IceModelVec2Int &domain_mask,
+                       const IceModelVec2S &hydraulic_potential,
+                       const IceModelVec2Stag &velocity,
+                       const IceModelVec2S &water_input,
+                       IceModelVec2Stag &result);
+
   IceModelVec2S m_potential;
   IceModelVec2S m_tmp;
   IceModelVec2S m_bottom_surface;
@@ -84,12 +93,19 @@ protected:
   IceModelVec2S m_adjustment;
   IceModelVec2Int m_sinks;
 
+  // ratio of the volume of water collected in a cell to the volume flux through its
+  // outflow faces (used by accumulate_flow(); allocated only if m_priority_flood is true)
+  IceModelVec2S m_volume_flux_ratio;
+
   double m_dx;
   double m_dy;
 
   double m_eps_gradient;
   double m_speed;
   double m_tau;
+
+  // true if using priority-flood filling and flow accumulation instead of iterations
+  bool m_priority_flood;
 };
 
 } // end of namespace hydrology
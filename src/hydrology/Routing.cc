@@ -17,6 +17,8 @@
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <cassert>
+#include <cmath>                // std::abs
+#include <algorithm>            // std::min, std::max
 
 #include "Routing.hh"
 #include "pism/util/IceModelVec2CellType.hh"
@@ -314,6 +316,15 @@ Routing::Routing(IceGrid::ConstPtr grid)
                        "m", "m", "", 0);
   m_Wtillnew.metadata().set_number("valid_min", 0.0);
 
+  m_implicit = m_config->get_string("hydrology.routing.time_stepping") == "implicit";
+
+  if (m_implicit) {
+    // fields used by the implicit time stepping method only
+    m_V_ghosted.create(grid, "water_velocity_ghosted", WITH_GHOSTS, 1);
+    m_W_iterate.create(grid, "W_iterate", WITH_GHOSTS, 1);
+    m_W_rhs.create(grid, "W_rhs", WITHOUT_GHOSTS);
+  }
+
   {
     double alpha = m_config->get_number("hydrology.thickness_power_in_flux");
     if (alpha < 1.0) {
@@ -337,6 +348,11 @@ void Routing::initialization_message() const {
   m_log->message(2,
                  "* Initializing the routing subglacial hydrology model ...\n");
 
+  if (m_implicit) {
+    m_log->message(2,
+                   "  ... using implicit (backward Euler) time stepping.\n");
+  }
+
   if (m_config->get_flag("hydrology.routing.include_floating_ice")) {
     m_log->message(2, "  ... routing subglacial water under grounded and floating ice.\n");
   } else {
@@ -843,6 +859,386 @@ void Routing::update_W(double dt,
   m_input_change.add(dt, basal_melt_rate);
 }
 
+//! Allocate the linear solver used by the implicit time stepping method.
+void Routing::create_W_solver() {
+  PetscErrorCode ierr;
+
+  petsc::DM::Ptr da = m_W_rhs.dm();
+
+  ierr = DMSetMatType(*da, MATAIJ);
+  PISM_CHK(ierr, "DMSetMatType");
+
+  ierr = DMCreateMatrix(*da, m_A.rawptr());
+  PISM_CHK(ierr, "DMCreateMatrix");
+
+  ierr = KSPCreate(m_grid->com, m_KSP.rawptr());
+  PISM_CHK(ierr, "KSPCreate");
+
+  ierr = KSPSetOptionsPrefix(m_KSP, "hydrology_");
+  PISM_CHK(ierr, "KSPSetOptionsPrefix");
+
+  // use the previous iterate as the initial guess
+  ierr = KSPSetInitialGuessNonzero(m_KSP, PETSC_TRUE);
+  PISM_CHK(ierr, "KSPSetInitialGuessNonzero");
+
+  // Process options:
+  ierr = KSPSetFromOptions(m_KSP);
+  PISM_CHK(ierr, "KSPSetFromOptions");
+}
+
+//! Assemble the matrix of the linear system solved during a Picard iteration in implicit_W_step().
+/*!
+  Uses first-order upwinding for the advective flux (as in advective_fluxes()) and the
+  same five-point discretization of the diffusive term as W_change_due_to_flow(). The
+  resulting matrix is an M-matrix.
+
+  Requires ghosts of `Wstag`, `K` and `V`.
+*/
+void Routing::assemble_W_matrix(double dt,
+                                const IceModelVec2Stag &Wstag,
+                                const IceModelVec2Stag &K,
+                                const IceModelVec2Stag &V,
+                                Mat A) {
+  PetscErrorCode ierr = 0;
+
+  const double
+    C_x = dt / m_dx,
+    C_y = dt / m_dy,
+    D_x = dt / (m_dx * m_dx),
+    D_y = dt / (m_dy * m_dy);
+
+  const int
+    nrow = 1,
+    ncol = 5;
+
+  ierr = MatZeroEntries(A); PISM_CHK(ierr, "MatZeroEntries");
+
+  IceModelVec::AccessList list{&Wstag, &K, &V};
+
+  ParallelSection loop(m_grid->com);
+  try {
+    MatStencil row, col[ncol];
+    row.c = 0;
+
+    for (int m = 0; m < ncol; m++) {
+      col[m].c = 0;
+    }
+
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      /* i indices */
+      const int I[] = {i, i - 1,  i,  i + 1, i};
+
+      /* j indices */
+      const int J[] = {j + 1, j,  j,  j, j - 1};
+
+      row.i = i;
+      row.j = j;
+
+      for (int m = 0; m < ncol; m++) {
+        col[m].i = I[m];
+        col[m].j = J[m];
+      }
+
+      auto v  = V.star(i, j);
+      auto k  = K.star(i, j);
+      auto ws = Wstag.star(i, j);
+
+      const double
+        De = m_rg * k.e * ws.e,
+        Dw = m_rg * k.w * ws.w,
+        Dn = m_rg * k.n * ws.n,
+        Ds = m_rg * k.s * ws.s;
+
+      // upwinded advective fluxes: Q_e = max(V_e, 0) W(i, j) + min(V_e, 0) W(i + 1, j), etc
+      const double
+        diagonal = (1.0 +
+                    C_x * (std::max(v.e, 0.0) - std::min(v.w, 0.0)) +
+                    C_y * (std::max(v.n, 0.0) - std::min(v.s, 0.0)) +
+                    D_x * (De + Dw) + D_y * (Dn + Ds)),
+        east  = C_x * std::min(v.e, 0.0) - D_x * De,
+        west  = - C_x * std::max(v.w, 0.0) - D_x * Dw,
+        north = C_y * std::min(v.n, 0.0) - D_y * Dn,
+        south = - C_y * std::max(v.s, 0.0) - D_y * Ds;
+
+      double L[ncol] = {north,
+                        west, diagonal, east,
+                        south};
+
+      ierr = MatSetValuesStencil(A, nrow, &row, ncol, col, L, INSERT_VALUES);
+      PISM_CHK(ierr, "MatSetValuesStencil");
+    }
+  } catch (...) {
+    loop.failed();
+  }
+  loop.check();
+
+  ierr = MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY); PISM_CHK(ierr, "MatAssemblyBegin");
+  ierr = MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY); PISM_CHK(ierr, "MatAssemblyEnd");
+
+#if (Pism_DEBUG==1)
+  ierr = MatSetOption(A, MAT_NEW_NONZERO_LOCATION_ERR, PETSC_TRUE);
+  PISM_CHK(ierr, "MatSetOption");
+#endif
+}
+
+//! Take one backward Euler step for the transportable water thickness.
+/*!
+  Solves
+
+  @f[ \frac{W - W_{\text{old}}}{\Delta t} = - \nabla \cdot (\mathbf{V} W) + \nabla \cdot (D \nabla W) + \frac{m}{\rho_w} - \frac{\Delta W_{till}}{\Delta t} @f]
+
+  for @f$ W @f$ using Picard iteration: the conductivity @f$ K @f$ (see
+  compute_conductivity()), the velocity @f$ \mathbf{V} @f$ and the diffusivity @f$ D =
+  \rho_w g K W @f$ are computed using the previous iterate. Each iteration requires
+  solving a linear system with an M-matrix, so iterates are non-negative if the right
+  hand side is.
+
+  Puts the result in `W_new`. Returns false if the linear solver or the Picard iteration
+  failed to converge.
+*/
+bool Routing::implicit_W_step(double dt,
+                              const IceModelVec2S        &surface_input_rate,
+                              const IceModelVec2S        &basal_melt_rate,
+                              const IceModelVec2S        &W,
+                              const IceModelVec2S        &Wtill,
+                              const IceModelVec2S        &Wtill_new,
+                              const IceModelVec2CellType &cell_type,
+                              const IceModelVec2Int      *no_model_mask,
+                              IceModelVec2S &W_new) {
+  PetscErrorCode ierr;
+
+  const int max_iterations = m_config->get_number("hydrology.routing.implicit.max_iterations");
+  const double tolerance = m_config->get_number("hydrology.routing.implicit.tolerance");
+
+  // right hand side
+  {
+    IceModelVec::AccessList list{&W, &Wtill, &Wtill_new, &surface_input_rate,
+                                 &basal_melt_rate, &m_W_rhs};
+
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      double input_rate = surface_input_rate(i, j) + basal_melt_rate(i, j);
+
+      double Wtill_change = Wtill_new(i, j) - Wtill(i, j);
+      m_W_rhs(i, j) = W(i, j) + (dt * input_rate - Wtill_change);
+    }
+  }
+
+  // the initial guess (updates ghosts)
+  m_W_iterate.copy_from(W);
+  W_new.copy_from(W);
+
+  for (int iteration = 0; iteration < max_iterations; ++iteration) {
+    // updates ghosts of m_Wstag
+    water_thickness_staggered(m_W_iterate, cell_type, m_Wstag);
+
+    double maxKW = 0.0;
+    // updates ghosts of m_Kstag
+    compute_conductivity(m_Wstag,
+                         subglacial_water_pressure(),
+                         m_bottom_surface,
+                         m_Kstag, maxKW);
+
+    compute_velocity(m_Wstag,
+                     subglacial_water_pressure(),
+                     m_bottom_surface,
+                     m_Kstag,
+                     no_model_mask,
+                     m_V_ghosted);
+    m_V_ghosted.update_ghosts();
+
+    assemble_W_matrix(dt, m_Wstag, m_Kstag, m_V_ghosted, m_A);
+
+    ierr = KSPSetOperators(m_KSP, m_A, m_A);
+    PISM_CHK(ierr, "KSPSetOperators");
+
+    ierr = KSPSolve(m_KSP, m_W_rhs.vec(), W_new.vec());
+    PISM_CHK(ierr, "KSPSolve");
+
+    KSPConvergedReason reason;
+    ierr = KSPGetConvergedReason(m_KSP, &reason);
+    PISM_CHK(ierr, "KSPGetConvergedReason");
+
+    if (reason < 0) {
+      m_log->message(2,
+                     "  KSP iteration failed while computing the water thickness: %s\n",
+                     KSPConvergedReasons[reason]);
+      return false;
+    }
+
+    // check convergence of the Picard iteration
+    double change = 0.0, size = 0.0;
+    {
+      IceModelVec::AccessList list{&W_new, &m_W_iterate};
+
+      for (Points p(*m_grid); p; p.next()) {
+        const int i = p.i(), j = p.j();
+
+        change = std::max(change, std::abs(W_new(i, j) - m_W_iterate(i, j)));
+        size   = std::max(size, std::abs(W_new(i, j)));
+      }
+
+      change = GlobalMax(m_grid->com, change);
+      size   = GlobalMax(m_grid->com, size);
+    }
+
+    // updates ghosts
+    m_W_iterate.copy_from(W_new);
+
+    m_log->message(4, "    Picard iteration %d: max. change in W = %e m\n",
+                   iteration + 1, change);
+
+    if (change <= tolerance * size) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+//! Take one implicit step of length `dt`, putting new water thickness in `m_Wnew`.
+/*!
+  Has to set `m_W_rhs` (water thickness at the end of the step if there was no flow),
+  ghosted `m_V_ghosted` and `m_W_iterate` (velocity and water thickness used to compute
+  the advective flux during the step).
+
+  Returns false if the solver failed to converge. The step is accepted otherwise.
+*/
+bool Routing::implicit_step(double dt, const Inputs &inputs) {
+  if (m_KSP.get() == NULL) {
+    create_W_solver();
+  }
+
+  return implicit_W_step(dt,
+                         m_surface_input_rate,
+                         m_basal_melt_rate,
+                         m_W,
+                         m_Wtill, m_Wtillnew,
+                         inputs.geometry->cell_type,
+                         inputs.no_model_mask,
+                         m_Wnew);
+}
+
+//! Update W and Wtill using implicit time stepping.
+/*!
+  Takes time steps of length `hydrology.maximum_time_step` (or the whole interval, if
+  shorter). A step is halved if the implicit solver fails to converge.
+
+  The water velocity and the advective flux are computed using the water thickness at
+  the end of each step.
+*/
+void Routing::update_implicit(double t, double dt, const Inputs& inputs) {
+
+  ice_bottom_surface(*inputs.geometry, m_bottom_surface);
+
+  const double
+    t_final = t + dt,
+    dt_max  = m_config->get_number("hydrology.maximum_time_step", "seconds"),
+    dt_min  = 1.0;              // one second
+
+  m_Qstag_average.set(0.0);
+
+  double
+    ht  = t,
+    hdt = dt_max;
+
+  unsigned int step_counter = 0;
+  while (ht < t_final) {
+    hdt = std::min(hdt, t_final - ht);
+
+    m_grid->ctx()->profiling().begin("routing_Wtill");
+    update_Wtill(hdt,
+                 m_Wtill,
+                 m_surface_input_rate,
+                 m_basal_melt_rate,
+                 m_Wtillnew);
+    m_grid->ctx()->profiling().end("routing_Wtill");
+
+    m_grid->ctx()->profiling().begin("routing_W");
+    bool success = implicit_step(hdt, inputs);
+    m_grid->ctx()->profiling().end("routing_W");
+
+    if (not success) {
+      if (hdt <= dt_min) {
+        throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                      "hydrology::Routing: implicit solver failed to converge"
+                                      " with dt = %f s", hdt);
+      }
+      m_log->message(2, "  implicit hydrology step failed; reducing dt from %f s to %f s\n",
+                     hdt, 0.5 * hdt);
+      hdt *= 0.5;
+      continue;
+    }
+
+    step_counter++;
+
+    m_log->message(3, "  hydrology step %05d, dt = %f s\n", step_counter, hdt);
+
+    // the flux during this step
+    {
+      IceModelVec::AccessList list{&m_V_ghosted, &m_Vstag};
+
+      for (Points p(*m_grid); p; p.next()) {
+        const int i = p.i(), j = p.j();
+
+        m_Vstag(i, j, 0) = m_V_ghosted(i, j, 0);
+        m_Vstag(i, j, 1) = m_V_ghosted(i, j, 1);
+      }
+    }
+    advective_fluxes(m_Vstag, m_W_iterate, m_Qstag);
+    m_Qstag_average.add(hdt, m_Qstag);
+
+    // record changes due to flow and input
+    m_flow_change_incremental.copy_from(m_Wnew);
+    m_flow_change_incremental.add(-1.0, m_W_rhs);
+    m_flow_change.add(1.0, m_flow_change_incremental);
+    m_input_change.add(hdt, m_surface_input_rate);
+    m_input_change.add(hdt, m_basal_melt_rate);
+
+    // remove water in ice-free areas and account for changes
+    enforce_bounds(inputs.geometry->cell_type,
+                   inputs.no_model_mask,
+                   0.0,        // do not limit maximum thickness
+                   m_Wtillnew,
+                   m_grounded_margin_change,
+                   m_grounding_line_change,
+                   m_conservation_error_change,
+                   m_no_model_mask_change);
+
+    enforce_bounds(inputs.geometry->cell_type,
+                   inputs.no_model_mask,
+                   0.0,        // do not limit maximum thickness
+                   m_Wnew,
+                   m_grounded_margin_change,
+                   m_grounding_line_change,
+                   m_conservation_error_change,
+                   m_no_model_mask_change);
+
+    // transfer new into old (updates ghosts of m_W)
+    m_W.copy_from(m_Wnew);
+    m_Wtill.copy_from(m_Wtillnew);
+
+    ht += hdt;
+    // try a longer step next time
+    hdt = std::min(2.0 * hdt, dt_max);
+  }
+
+  staggered_to_regular(inputs.geometry->cell_type, m_Qstag_average,
+                       m_config->get_flag("hydrology.routing.include_floating_ice"),
+                       m_Q);
+  m_Q.scale(1.0 / dt);
+
+  m_log->message(2,
+                 "  took %d implicit hydrology steps with average dt = %.6f years (%.3f s or %.3f hours)\n",
+                 step_counter,
+                 units::convert(m_sys, dt / step_counter, "seconds", "years"),
+                 dt / step_counter,
+                 (dt / step_counter) / 3600.0);
+}
+
 //! Update the model state variables W and Wtill by applying the subglacial hydrology model equations.
 /*!
   Runs the hydrology model from time t to time t + dt.  Here [t, dt]
@@ -854,6 +1250,11 @@ void Routing::update_W(double dt,
 */
 void Routing::update_impl(double t, double dt, const Inputs& inputs) {
 
+  if (m_implicit) {
+    update_implicit(t, dt, inputs);
+    return;
+  }
+
   ice_bottom_surface(*inputs.geometry, m_bottom_surface);
 
   double
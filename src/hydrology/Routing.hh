@@ -20,6 +20,8 @@
 #define _ROUTING_H_
 
 #include "Hydrology.hh"
+#include "pism/util/petscwrappers/KSP.hh"
+#include "pism/util/petscwrappers/Mat.hh"
 
 namespace pism {
 
@@ -134,6 +136,17 @@ protected:
 
   IceModelVec2S m_bottom_surface;
 
+  // implicit time stepping (fields below are allocated in implicit mode only)
+  bool m_implicit;
+  petsc::KSP m_KSP;
+  petsc::Mat m_A;
+  // ghosted copy of the water velocity
+  IceModelVec2Stag m_V_ghosted;
+  // ghosted current Picard iterate
+  IceModelVec2S m_W_iterate;
+  // right hand side of the linear system
+  IceModelVec2S m_W_rhs;
+
   void water_thickness_staggered(const IceModelVec2S &W,
                                  const IceModelVec2CellType &mask,
                                  IceModelVec2Stag &result);
@@ -178,6 +191,28 @@ protected:
                     const IceModelVec2S &basal_melt_rate,
                     IceModelVec2S &Wtill_new);
 
+  void create_W_solver();
+
+  void update_implicit(double t, double dt, const Inputs& inputs);
+
+  virtual bool implicit_step(double dt, const Inputs &inputs);
+
+  bool implicit_W_step(double dt,
+                       const IceModelVec2S        &surface_input_rate,
+                       const IceModelVec2S        &basal_melt_rate,
+                       const IceModelVec2S        &W,
+                       const IceModelVec2S        &Wtill,
+                       const IceModelVec2S        &Wtill_new,
+                       const IceModelVec2CellType &cell_type,
+                       const IceModelVec2Int      *no_model_mask,
+                       IceModelVec2S &W_new);
+
+  void assemble_W_matrix(double dt,
+                         const IceModelVec2Stag &Wstag,
+                         const IceModelVec2Stag &K,
+                         const IceModelVec2Stag &V,
+                         Mat A);
+
 private:
   virtual void initialization_message() const;
 };
@@ -54,6 +54,7 @@
 #include "pism/age/AgeModel.hh"
 #include "pism/energy/EnergyModel.hh"
 #include "pism/util/io/File.hh"
+#include "pism/util/io/AsyncWriter.hh"
 #include "pism/util/iceModelVec2T.hh"
 #include "pism/fracturedensity/FractureDensity.hh"
 #include "pism/coupler/util/options.hh" // ForcingOptions
@@ -109,6 +110,11 @@ IceModel::IceModel(IceGrid::Ptr g, Context::Ptr context)
 
   m_fracture = nullptr;
 
+  m_multirate.enabled            = m_config->get_flag("time_stepping.multirate.enabled");
+  m_multirate.interval           = m_config->get_number("time_stepping.multirate.interval", "seconds");
+  m_multirate.velocity_tolerance = m_config->get_number("time_stepping.multirate.velocity_tolerance");
+  m_multirate.sampling_interval  = m_config->get_number("time_stepping.multirate.sampling_interval", "seconds");
+
   reset_counters();
 
   // allocate temporary storage
@@ -155,6 +161,15 @@ void IceModel::reset_counters() {
   m_dt             = 0.0;
   m_skip_countdown = 0;
 
+  m_multirate.updated               = false;
+  m_multirate.velocity_changed      = false;
+  m_multirate.mass_steps            = 0;
+  m_multirate.samples               = 0;
+  m_multirate.last_sample           = m_time->current();
+  m_multirate.held_time             = 0.0;
+  m_multirate.averaged_time         = 0.0;
+  m_multirate.strain_heating_defect = 0.0;
+
   m_timestep_hit_multiples_last_time = m_time->current();
 }
 
@@ -273,6 +288,10 @@ void IceModel::allocate_storage() {
   m_model_state.insert(&m_geometry.longitude);
   m_model_state.insert(&m_geometry.ice_thickness);
   m_model_state.insert(&m_geometry.ice_area_specific_volume);
+
+  if (m_multirate.enabled) {
+    allocate_multirate();
+  }
 }
 
 //! Update the surface elevation and the flow-type mask when the geometry has changed.
@@ -367,6 +386,15 @@ energy::Inputs IceModel::energy_model_inputs() {
   result.v3                       = &m_stress_balance->velocity_v();
   result.w3                       = &m_stress_balance->velocity_w();
 
+  if (m_multirate.enabled) {
+    // use inputs averaged over mass continuity steps since the last energy step
+    result.basal_frictional_heating = &m_basal_frictional_heating_average;
+    result.volumetric_heating_rate  = &m_strain_heating_average;
+    result.u3                       = &m_u3_average;
+    result.v3                       = &m_v3_average;
+    result.w3                       = &m_w3_average;
+  }
+
   result.check();             // make sure all data members were set
 
   return result;
@@ -405,7 +433,21 @@ void IceModel::step(bool do_mass_continuity,
   // stability criterion; note *lots* of communication is avoided by skipping
   // SSA (and temp/age)
 
-  const bool updateAtDepth  = (m_skip_countdown == 0);
+  // With multirate coupling the three-dimensional velocity field is sampled every
+  // `time_stepping.multirate.sampling_interval` years: energy and age models use its time
+  // average.
+  const bool updateAtDepth  = (m_multirate.enabled ?
+                               multirate_sample_due(current_time) :
+                               m_skip_countdown == 0);
+
+  if (m_multirate.enabled and updateAtDepth) {
+    // add the contribution of the previous sample before it is replaced
+    profiling.begin("multirate");
+    multirate_accumulate();
+    profiling.end("multirate");
+
+    m_multirate.last_sample = current_time;
+  }
 
   // Combine basal melt rate in grounded (computed during the energy
   // step) and floating (provided by an ocean model) areas.
@@ -470,32 +512,53 @@ void IceModel::step(bool do_mass_continuity,
 
   dt_TempAge += m_dt;
 
-  //! \li update the age of the ice (if appropriate)
-  if (m_age_model and updateAtDepth) {
-    AgeModelInputs inputs;
-    inputs.ice_thickness = &m_geometry.ice_thickness;
-    inputs.u3            = &m_stress_balance->velocity_u();
-    inputs.v3            = &m_stress_balance->velocity_v();
-    inputs.w3            = &m_stress_balance->velocity_w();
-
-    profiling.begin("age");
-    m_age_model->update(current_time, dt_TempAge, inputs);
-    profiling.end("age");
-    m_stdout_flags += "a";
+  if (m_multirate.enabled) {
+    //! \li with multirate coupling, accumulate time-averaged inputs of the energy and age
+    //! models and update them once their (longer) time step is complete; see
+    //! multirate_energy_age_step()
+    m_multirate.held_time  += m_dt;
+    m_multirate.mass_steps += 1;
+
+    m_multirate.updated = multirate_step_due(current_time + m_dt);
+    if (m_multirate.updated) {
+      profiling.begin("multirate");
+      multirate_accumulate();
+      profiling.end("multirate");
+
+      multirate_energy_age_step();
+      m_stdout_flags += m_age_model ? "a" : "$";
+      m_stdout_flags += "E";
+    } else {
+      m_stdout_flags += "$$";
+    }
   } else {
-    m_stdout_flags += "$";
-  }
+    //! \li update the age of the ice (if appropriate)
+    if (m_age_model and updateAtDepth) {
+      AgeModelInputs inputs;
+      inputs.ice_thickness = &m_geometry.ice_thickness;
+      inputs.u3            = &m_stress_balance->velocity_u();
+      inputs.v3            = &m_stress_balance->velocity_v();
+      inputs.w3            = &m_stress_balance->velocity_w();
+
+      profiling.begin("age");
+      m_age_model->update(current_time, dt_TempAge, inputs);
+      profiling.end("age");
+      m_stdout_flags += "a";
+    } else {
+      m_stdout_flags += "$";
+    }
 
-  //! \li update the enthalpy (or temperature) field according to the conservation of
-  //!  energy model based (especially) on the new velocity field; see
-  //!  energy_step()
-  if (updateAtDepth) { // do the energy step
-    profiling.begin("energy");
-    energy_step();
-    profiling.end("energy");
-    m_stdout_flags += "E";
-  } else {
-    m_stdout_flags += "$";
+    //! \li update the enthalpy (or temperature) field according to the conservation of
+    //!  energy model based (especially) on the new velocity field; see
+    //!  energy_step()
+    if (updateAtDepth) { // do the energy step
+      profiling.begin("energy");
+      energy_step();
+      profiling.end("energy");
+      m_stdout_flags += "E";
+    } else {
+      m_stdout_flags += "$";
+    }
   }
 
   //! \li update the fracture density field; see update_fracture_density()
@@ -641,7 +704,7 @@ void IceModel::step(bool do_mass_continuity,
   // Done with the step; now adopt the new time.
   m_time->step(m_dt);
 
-  if (updateAtDepth) {
+  if (m_multirate.enabled ? m_multirate.updated : updateAtDepth) {
     t_TempAge  = m_time->current();
     dt_TempAge = 0.0;
   }
@@ -800,7 +863,7 @@ void IceModel::run() {
     update_diagnostics(m_dt);
 
     // report a summary for major steps or the last one
-    bool updateAtDepth = m_skip_countdown == 0;
+    bool updateAtDepth = m_multirate.enabled ? m_multirate.updated : m_skip_countdown == 0;
     bool tempAgeStep   = updateAtDepth and (m_age_model or do_energy);
 
     const bool show_step = tempAgeStep or m_adaptive_timestep_reason == "end of the run";
@@ -826,6 +889,9 @@ void IceModel::run() {
 
   profiling.stage_end("time-stepping loop");
 
+  // make sure all snapshots, spatially-varying time-series and backups are written
+  flush_async_output();
+
   if (stepcount >= 0) {
     m_log->message(1,
                "count_time_steps:  run() took %d steps\n"
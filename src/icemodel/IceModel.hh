@@ -47,6 +47,8 @@
 #include "pism/util/Logger.hh"
 #include "pism/util/Time.hh"
 #include "pism/util/Diagnostic.hh"
+#include "pism/util/io/BackupIndex.hh"
+#include "pism/util/io/Coarsening.hh"
 #include "pism/util/MaxTimestep.hh"
 #include "pism/geometry/Geometry.hh"
 #include "pism/geometry/GeometryEvolution.hh"
@@ -81,6 +83,10 @@ class IcebergRemover;
 
 class FractureDensity;
 
+namespace io {
+class AsyncWriter;
+}
+
 namespace energy {
 class BedThermalUnit;
 class Inputs;
@@ -102,6 +108,7 @@ class IceModelVec2CellType;
 class IceModelVec2T;
 class Component;
 class FrontRetreat;
+class FrontBand;
 class PrescribedRetreat;
 
 //! The base class for PISM. Contains all essential variables, parameters, and flags for modelling
@@ -152,6 +159,8 @@ public:
 
   double dt() const;
 
+  double multirate_strain_heating_defect() const;
+
 protected:
   virtual void allocate_submodels();
   virtual void allocate_stressbalance();
@@ -267,6 +276,8 @@ protected:
   std::shared_ptr<PrescribedRetreat>           m_prescribed_retreat;
 
   std::shared_ptr<FrontRetreat> m_front_retreat;
+  //! narrow band near ice margins used by calving and front retreat code (may be NULL)
+  std::shared_ptr<FrontBand> m_front_band;
 
   std::shared_ptr<surface::SurfaceModel>      m_surface;
   std::shared_ptr<ocean::OceanModel>          m_ocean;
@@ -305,6 +316,42 @@ protected:
 
   unsigned int m_skip_countdown;
 
+  //! Multirate coupling: the energy and age models use their own (longer) time step
+  struct {
+    bool enabled;
+    //! maximum length of an energy and age step, seconds
+    double interval;
+    //! relative change in ice velocity that triggers an early energy and age step
+    double velocity_tolerance;
+    //! true if the energy and age models were updated during the last step
+    bool updated;
+    //! true if the velocity changed by more than `velocity_tolerance` since the last update
+    bool velocity_changed;
+    //! interval between updates of the three-dimensional velocity field, seconds
+    double sampling_interval;
+    //! number of mass continuity steps since the last update
+    unsigned int mass_steps;
+    //! number of velocity samples used by the current averages
+    unsigned int samples;
+    //! time of the last update of the three-dimensional velocity field
+    double last_sample;
+    //! time since the last sample was added to the averages, seconds
+    double held_time;
+    //! length of the time interval covered by the averages, seconds
+    double averaged_time;
+    //! strain heating that could not be applied during the last update, J
+    double strain_heating_defect;
+  } m_multirate;
+
+  //! time-averaged inputs of energy and age models (multirate coupling)
+  IceModelVec3 m_u3_average;
+  IceModelVec3 m_v3_average;
+  IceModelVec3 m_w3_average;
+  IceModelVec3 m_strain_heating_average;
+  IceModelVec2S m_basal_frictional_heating_average;
+  //! column-integrated strain heating accumulated since the last energy step, J m-2
+  IceModelVec2S m_strain_heating_accumulated;
+
   std::string m_adaptive_timestep_reason;
 
   std::string m_stdout_flags;
@@ -320,6 +367,14 @@ protected:
   virtual void bedrock_thermal_model_step();
   virtual void energy_step();
 
+  // see multirate.cc
+  virtual void allocate_multirate();
+  virtual void multirate_accumulate();
+  virtual bool multirate_sample_due(double t) const;
+  virtual bool multirate_step_due(double t_next) const;
+  virtual double multirate_conserve_strain_heating(double dt);
+  virtual void multirate_energy_age_step();
+
   virtual void hydrology_step();
 
   virtual void combine_basal_melt_rate(const Geometry &geometry,
@@ -331,6 +386,7 @@ protected:
   void enforce_consistency_of_geometry(ConsistencyFlag flag);
 
   virtual void front_retreat_step();
+  void update_front_band();
 
   void compute_geometry_change(const IceModelVec2S &thickness,
                                const IceModelVec2S &Href,
@@ -412,6 +468,13 @@ protected:
   void flush_timeseries();
   MaxTimestep ts_max_timestep(double my_t);
 
+  // asynchronous output of snapshots, spatially-varying time-series and backups
+  std::unique_ptr<io::AsyncWriter> m_async_writer;
+  void init_async_output();
+  void flush_async_output();
+  void wait_for_async_output(const std::string &filename);
+  void use_async_output(File &file);
+
   // spatially-varying time-series
   bool m_save_extra, m_extra_file_is_ready, m_split_extra;
   std::string m_extra_filename;
@@ -421,6 +484,8 @@ protected:
   std::set<std::string> m_extra_vars;
   TimeBoundsMetadata m_extra_bounds;
   std::unique_ptr<File> m_extra_file;
+  //! coarsens spatial fields written to extra files (if requested)
+  std::unique_ptr<io::Coarsening> m_extra_coarsening;
   void init_extras();
   void write_extras();
   MaxTimestep extras_max_timestep(double my_t);
@@ -429,6 +494,10 @@ protected:
   std::string m_backup_filename;
   double m_last_backup_time;
   std::set<std::string> m_backup_vars;
+  //! spatial variables written to the last full backup and following delta files
+  io::BackupIndex m_backup_index;
+  //! number of delta files written since the last full backup (-1 before the first backup)
+  int m_backup_delta;
   void init_backups();
   void write_backup();
 
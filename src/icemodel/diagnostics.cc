@@ -1493,6 +1493,24 @@ public:
   }
 };
 
+//! \brief Reports strain heating the multirate coupling could not apply.
+class MultirateStrainHeatingDefect : public TSDiag<TSSnapshotDiagnostic, IceModel>
+{
+public:
+  MultirateStrainHeatingDefect(const IceModel *m)
+    : TSDiag<TSSnapshotDiagnostic, IceModel>(m, "multirate_strain_heating_defect") {
+
+    set_units("J", "J");
+    m_ts.variable().set_string("long_name",
+                               "strain heating accumulated over mass continuity steps"
+                               " that could not be applied during the last energy step");
+  }
+
+  double compute() {
+    return model->multirate_strain_heating_defect();
+  }
+};
+
 //! \brief Reports maximum diffusivity.
 class MaxDiffusivity : public TSDiag<TSSnapshotDiagnostic, IceModel>
 {
@@ -2837,6 +2855,10 @@ void IceModel::init_diagnostics() {
     {"grounding_line_flux",      s(new scalar::IceMassFluxAtGroundingLine(this))},
   };
 
+  if (m_multirate.enabled) {
+    m_ts_diagnostics["multirate_strain_heating_defect"] = s(new scalar::MultirateStrainHeatingDefect(this));
+  }
+
   // add ISMIP6 variable names
   if (m_config->get_flag("output.ISMIP6")) {
     m_ts_diagnostics["iareafl"]         = m_ts_diagnostics["ice_area_glacierized_floating"];
@@ -22,9 +22,11 @@
 #include "pism/util/Mask.hh"
 #include "pism/util/ConfigInterface.hh"
 #include "pism/util/pism_utilities.hh"
+#include "pism/util/Profiling.hh"
 
 #include "pism/frontretreat/FrontRetreat.hh"
 #include "pism/frontretreat/util/IcebergRemover.hh"
+#include "pism/frontretreat/util/FrontBand.hh"
 #include "pism/frontretreat/calving/CalvingAtThickness.hh"
 #include "pism/frontretreat/calving/EigenCalving.hh"
 #include "pism/frontretreat/calving/FloatKill.hh"
@@ -40,21 +42,49 @@
 
 namespace pism {
 
+/*!
+ * Update the narrow band near ice margins used by calving and front retreat code.
+ */
+void IceModel::update_front_band() {
+  if (not m_front_band) {
+    return;
+  }
+
+  const Profiling &profiling = m_ctx->profiling();
+
+  profiling.begin("front_retreat.band");
+  m_front_band->update(m_geometry.cell_type);
+  profiling.end("front_retreat.band");
+
+  const int
+    band_size = GlobalSum(m_grid->com, (int)m_front_band->size()),
+    N         = m_grid->Mx() * m_grid->My();
+
+  m_log->message(3, "  front retreat: narrow band contains %d cells (%.2f%% of the grid)\n",
+                 band_size, 100.0 * band_size / N);
+}
+
 void IceModel::front_retreat_step() {
+  update_front_band();
+
+  const FrontBand *band = m_front_band.get();
+
   // compute retreat rates due to eigencalving, von Mises calving, Hayhurst calving,
   // and frontal melt.
   // We do this first to make sure that all three mechanisms use the same ice geometry.
   {
     if (m_eigen_calving) {
       m_eigen_calving->update(m_geometry.cell_type,
-                              m_stress_balance->shallow()->velocity());
+                              m_stress_balance->shallow()->velocity(),
+                              band);
     }
 
     if (m_hayhurst_calving) {
       m_hayhurst_calving->update(m_geometry.cell_type,
                                  m_geometry.ice_thickness,
                                  m_geometry.sea_level_elevation,
-                                 m_geometry.bed_elevation);
+                                 m_geometry.bed_elevation,
+                                 band);
     }
 
     if (m_vonmises_calving) {
@@ -63,7 +93,8 @@ void IceModel::front_retreat_step() {
       m_vonmises_calving->update(m_geometry.cell_type,
                                  m_geometry.ice_thickness,
                                  m_stress_balance->shallow()->velocity(),
-                                 m_energy_model->enthalpy());
+                                 m_energy_model->enthalpy(),
+                                 band);
     }
 
     if (m_frontal_melt) {
@@ -95,7 +126,8 @@ void IceModel::front_retreat_step() {
     m_front_retreat->update_geometry(m_dt, m_geometry, m_ssa_dirichlet_bc_mask,
                                      m_frontal_melt->retreat_rate(),
                                      m_geometry.ice_area_specific_volume,
-                                     m_geometry.ice_thickness);
+                                     m_geometry.ice_thickness,
+                                     band);
 
     compute_geometry_change(m_geometry.ice_thickness,
                             m_geometry.ice_area_specific_volume,
@@ -132,14 +164,15 @@ void IceModel::front_retreat_step() {
       m_front_retreat->update_geometry(m_dt, m_geometry, m_ssa_dirichlet_bc_mask,
                                        retreat_rate,
                                        m_geometry.ice_area_specific_volume,
-                                       m_geometry.ice_thickness);
+                                       m_geometry.ice_thickness,
+                                       band);
 
       auto thickness_threshold = m_config->get_number("stress_balance.ice_free_thickness_standard");
 
       m_geometry.ensure_consistency(thickness_threshold);
 
       if (m_eigen_calving or m_vonmises_calving or m_hayhurst_calving) {
-        remove_narrow_tongues(m_geometry, m_geometry.ice_thickness);
+        remove_narrow_tongues(m_geometry, m_geometry.ice_thickness, band);
 
         m_geometry.ensure_consistency(thickness_threshold);
       }
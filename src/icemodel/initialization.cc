@@ -23,6 +23,7 @@
 #include "pism/basalstrength/ConstantYieldStress.hh"
 #include "pism/basalstrength/MohrCoulombYieldStress.hh"
 #include "pism/basalstrength/basal_resistance.hh"
+#include "pism/frontretreat/util/FrontBand.hh"
 #include "pism/frontretreat/util/IcebergRemover.hh"
 #include "pism/frontretreat/calving/CalvingAtThickness.hh"
 #include "pism/frontretreat/calving/EigenCalving.hh"
@@ -780,6 +781,7 @@ void IceModel::misc_setup() {
   init_frontal_melt();
   init_front_retreat();
   init_diagnostics();
+  init_async_output();
   init_snapshots();
   init_backups();
   init_timeseries();
@@ -874,6 +876,20 @@ void IceModel::init_front_retreat() {
 
     m_submodels["prescribed front retreat"] = m_prescribed_retreat.get();
   }
+
+  if (m_front_retreat and m_config->get_flag("geometry.front_retreat.narrow_band.enabled")) {
+    int
+      width            = m_config->get_number("geometry.front_retreat.narrow_band.width"),
+      rebuild_interval = m_config->get_number("geometry.front_retreat.narrow_band.rebuild_interval");
+
+    m_log->message(2,
+                   "* Calving and front retreat code will use a narrow band of width %d"
+                   " near ice margins...\n", width);
+
+    m_front_band.reset(new FrontBand(m_grid, width, rebuild_interval));
+
+    update_front_band();
+  }
 }
 
 //! \brief Initialize calving mechanisms.
@@ -1005,6 +1021,14 @@ void IceModel::process_options() {
                "              -skip only makes sense in runs updating ice geometry.\n");
   }
 
+  if (m_config->get_flag("time_stepping.multirate.enabled") and
+      m_config->get_flag("time_stepping.skip.enabled")) {
+    m_log->message(2,
+               "PISM WARNING: Both -skip and -multirate are set.\n"
+               "              -skip is ignored: the multirate scheme updates energy and age\n"
+               "              using its own time step.\n");
+  }
+
   if (m_config->get_string("calving.methods").find("thickness_calving") != std::string::npos &&
       not m_config->get_flag("geometry.part_grid.enabled")) {
     m_log->message(2,
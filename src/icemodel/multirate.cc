@@ -0,0 +1,348 @@
+/* Copyright (C) 2019 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cmath>                // std::ceil
+#include <algorithm>            // std::min, std::max
+
+#include "IceModel.hh"
+
+#include "pism/age/AgeModel.hh"
+#include "pism/energy/EnergyModel.hh"
+#include "pism/stressbalance/StressBalance.hh"
+#include "pism/stressbalance/timestepping.hh"
+#include "pism/util/IceGrid.hh"
+#include "pism/util/ConfigInterface.hh"
+#include "pism/util/error_handling.hh"
+#include "pism/util/pism_utilities.hh"
+#include "pism/util/Profiling.hh"
+
+namespace pism {
+
+//! \file multirate.cc Multirate coupling of the mass continuity step and the energy and age models.
+
+/*!
+ * Integrate `f` over the ice column of thickness `H`, using the trapezoid rule on the
+ * storage grid `z`.
+ */
+static double column_integral(const double *f, const std::vector<double> &z, double H) {
+  double result = 0.0;
+  for (unsigned int k = 0; k + 1 < z.size() and z[k] < H; ++k) {
+    const double dz = std::min(z[k + 1], H) - z[k];
+    result += 0.5 * (f[k] + f[k + 1]) * dz;
+  }
+  return result;
+}
+
+double IceModel::multirate_strain_heating_defect() const {
+  return m_multirate.strain_heating_defect;
+}
+
+//! Allocate storage for time-averaged inputs of the energy and age models.
+void IceModel::allocate_multirate() {
+  m_u3_average.create(m_grid, "uvel_average", WITHOUT_GHOSTS);
+  m_u3_average.set_attrs("internal", "time-averaged x-component of the ice velocity",
+                         "m s-1", "m year-1", "", 0);
+
+  m_v3_average.create(m_grid, "vvel_average", WITHOUT_GHOSTS);
+  m_v3_average.set_attrs("internal", "time-averaged y-component of the ice velocity",
+                         "m s-1", "m year-1", "", 0);
+
+  m_w3_average.create(m_grid, "wvel_rel_average", WITHOUT_GHOSTS);
+  m_w3_average.set_attrs("internal",
+                         "time-averaged vertical velocity of ice, relative to base of ice directly below",
+                         "m s-1", "m year-1", "", 0);
+
+  m_strain_heating_average.create(m_grid, "strain_heating_average", WITHOUT_GHOSTS);
+  m_strain_heating_average.set_attrs("internal", "time-averaged rate of strain heating in ice",
+                                     "W m-3", "mW m-3", "", 0);
+
+  m_basal_frictional_heating_average.create(m_grid, "bfrict_average", WITHOUT_GHOSTS);
+  m_basal_frictional_heating_average.set_attrs("internal",
+                                               "time-averaged basal frictional heating",
+                                               "W m-2", "mW m-2", "", 0);
+
+  m_strain_heating_accumulated.create(m_grid, "strain_heating_accumulated", WITHOUT_GHOSTS);
+  m_strain_heating_accumulated.set_attrs("internal",
+                                         "column-integrated strain heating accumulated"
+                                         " since the last energy step",
+                                         "J m-2", "J m-2", "", 0);
+
+  m_u3_average.set(0.0);
+  m_v3_average.set(0.0);
+  m_w3_average.set(0.0);
+  m_strain_heating_average.set(0.0);
+  m_basal_frictional_heating_average.set(0.0);
+  m_strain_heating_accumulated.set(0.0);
+}
+
+/*!
+ * Returns true if the three-dimensional velocity field should be updated during the step
+ * starting at time `t`.
+ *
+ * The velocity is sampled at the beginning of each energy and age step and then every
+ * `time_stepping.multirate.sampling_interval` years.
+ */
+bool IceModel::multirate_sample_due(double t) const {
+  const double epsilon = 1.0; // 1 second tolerance
+
+  return (dt_TempAge <= 0.0 or
+          t - m_multirate.last_sample + epsilon >= m_multirate.sampling_interval);
+}
+
+/*!
+ * Add the current sample of the ice velocity, strain heating and basal frictional
+ * heating to time averages.
+ *
+ * The sample is weighted by the time it was "held", i.e. the time since it was added to
+ * averages (see `m_multirate.held_time`). This has to be called before the stress
+ * balance model replaces the sample and before an energy and age step.
+ *
+ * Also accumulates column-integrated strain heating (used to make the time-averaged
+ * strain heating conserve energy; see multirate_energy_age_step()) and checks if the
+ * velocity field differs from the current average by more than
+ * `time_stepping.multirate.velocity_tolerance`, in which case the energy and age models
+ * are updated early.
+ */
+void IceModel::multirate_accumulate() {
+  const double dt = m_multirate.held_time;
+
+  if (dt <= 0.0) {
+    return;
+  }
+
+  const double
+    total = m_multirate.averaged_time + dt,
+    alpha = m_multirate.averaged_time / total, // weight of the current average
+    beta  = dt / total;                        // weight of the new value
+
+  const IceModelVec3
+    &u3             = m_stress_balance->velocity_u(),
+    &v3             = m_stress_balance->velocity_v(),
+    &w3             = m_stress_balance->velocity_w(),
+    &strain_heating = m_stress_balance->volumetric_strain_heating();
+
+  const IceModelVec2S
+    &friction      = m_stress_balance->basal_frictional_heating(),
+    &ice_thickness = m_geometry.ice_thickness;
+
+  IceModelVec::AccessList list{&u3, &v3, &w3, &strain_heating, &friction, &ice_thickness,
+                               &m_u3_average, &m_v3_average, &m_w3_average,
+                               &m_strain_heating_average, &m_basal_frictional_heating_average,
+                               &m_strain_heating_accumulated};
+
+  const unsigned int Mz = m_grid->Mz();
+  const std::vector<double> &z = m_grid->z();
+
+  double
+    max_change = 0.0,           // max. change in horizontal velocity
+    max_speed  = 0.0;           // max. time-averaged horizontal speed
+
+  ParallelSection loop(m_grid->com);
+  try {
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      const double
+        *u     = u3.get_column(i, j),
+        *v     = v3.get_column(i, j),
+        *w     = w3.get_column(i, j),
+        *sigma = strain_heating.get_column(i, j),
+        H      = ice_thickness(i, j);
+
+      double
+        *u_avg     = m_u3_average.get_column(i, j),
+        *v_avg     = m_v3_average.get_column(i, j),
+        *w_avg     = m_w3_average.get_column(i, j),
+        *sigma_avg = m_strain_heating_average.get_column(i, j);
+
+      if (H > 0.0) {
+        if (m_multirate.samples > 0) {
+          const unsigned int ks = m_grid->kBelowHeight(H);
+          for (unsigned int k = 0; k <= ks; ++k) {
+            max_change = std::max(max_change,
+                                  std::max(std::abs(u[k] - u_avg[k]), std::abs(v[k] - v_avg[k])));
+            max_speed = std::max(max_speed,
+                                 std::max(std::abs(u_avg[k]), std::abs(v_avg[k])));
+          }
+        }
+
+        m_strain_heating_accumulated(i, j) += column_integral(sigma, z, H) * dt;
+      }
+
+      for (unsigned int k = 0; k < Mz; ++k) {
+        u_avg[k]     = alpha * u_avg[k] + beta * u[k];
+        v_avg[k]     = alpha * v_avg[k] + beta * v[k];
+        w_avg[k]     = alpha * w_avg[k] + beta * w[k];
+        sigma_avg[k] = alpha * sigma_avg[k] + beta * sigma[k];
+      }
+
+      m_basal_frictional_heating_average(i, j) =
+        alpha * m_basal_frictional_heating_average(i, j) + beta * friction(i, j);
+    }
+  } catch (...) {
+    loop.failed();
+  }
+  loop.check();
+
+  m_multirate.averaged_time = total;
+  m_multirate.held_time     = 0.0;
+  m_multirate.samples      += 1;
+
+  max_change = GlobalMax(m_grid->com, max_change);
+  max_speed  = GlobalMax(m_grid->com, max_speed);
+
+  const double tolerance = m_multirate.velocity_tolerance;
+  if (tolerance > 0.0 and max_speed > 0.0 and max_change > tolerance * max_speed) {
+    m_multirate.velocity_changed = true;
+  }
+}
+
+/*!
+ * Returns true if the energy and age models should be updated at the end of the current
+ * mass continuity step (i.e. at time `t_next`).
+ */
+bool IceModel::multirate_step_due(double t_next) const {
+  const double epsilon = 1.0; // 1 second tolerance
+
+  return (dt_TempAge + epsilon >= m_multirate.interval or
+          m_multirate.velocity_changed or
+          t_next + epsilon >= m_time->end());
+}
+
+/*!
+ * Scale the time-averaged strain heating in each column so that the energy model applies
+ * the strain heating accumulated over mass continuity steps.
+ *
+ * The ice thickness changes during an energy and age step, so the column integral of the
+ * time-averaged strain heating over the current ice column differs from the accumulated
+ * one. Heating accumulated in columns that are ice-free now (or have no strain heating in
+ * the current column) cannot be applied.
+ *
+ * Returns the total strain heating that could not be applied, in Joules.
+ */
+double IceModel::multirate_conserve_strain_heating(double dt) {
+  const IceModelVec2S &ice_thickness = m_geometry.ice_thickness;
+
+  IceModelVec::AccessList list{&ice_thickness, &m_strain_heating_average,
+                               &m_strain_heating_accumulated};
+
+  const unsigned int Mz = m_grid->Mz();
+  const std::vector<double> &z = m_grid->z();
+
+  double defect = 0.0;
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    const double
+      H           = ice_thickness(i, j),
+      accumulated = m_strain_heating_accumulated(i, j);
+
+    double *sigma = m_strain_heating_average.get_column(i, j);
+
+    const double applied = H > 0.0 ? column_integral(sigma, z, H) * dt : 0.0;
+
+    if (applied > 0.0) {
+      const double C = accumulated / applied;
+      for (unsigned int k = 0; k < Mz; ++k) {
+        sigma[k] *= C;
+      }
+    } else {
+      defect += accumulated;
+    }
+  }
+
+  return GlobalSum(m_grid->com, defect) * m_grid->cell_area();
+}
+
+/*!
+ * Update the energy and age models over the time interval [t_TempAge, t_TempAge +
+ * dt_TempAge] using velocity and strain heating averaged over mass continuity steps.
+ *
+ * Sub-cycles as needed to satisfy the 3D CFL condition for the *time-averaged* velocity
+ * field. (The semi-Lagrangian age model is updated once.)
+ */
+void IceModel::multirate_energy_age_step() {
+  const Profiling &profiling = m_ctx->profiling();
+
+  const double
+    t0       = t_TempAge,
+    dt_total = dt_TempAge;
+
+  m_multirate.strain_heating_defect = multirate_conserve_strain_heating(dt_total);
+
+  CFLData cfl = max_timestep_cfl_3d(m_geometry.ice_thickness, m_geometry.cell_type,
+                                    m_u3_average, m_v3_average, m_w3_average);
+
+  unsigned int N = 1;
+  if (cfl.dt_max.finite() and cfl.dt_max.value() < dt_total) {
+    N = static_cast<unsigned int>(std::ceil(dt_total / cfl.dt_max.value()));
+  }
+  const double dt = dt_total / N;
+
+  const bool semi_lagrangian_age = (m_age_model and
+                                    m_config->get_string("age.method") == "semi_lagrangian");
+
+  AgeModelInputs age_inputs(&m_geometry.ice_thickness,
+                            &m_u3_average, &m_v3_average, &m_w3_average);
+
+  const std::string flags = m_stdout_flags;
+  for (unsigned int n = 0; n < N; ++n) {
+    t_TempAge  = t0 + n * dt;
+    dt_TempAge = dt;
+
+    if (m_age_model and not semi_lagrangian_age) {
+      profiling.begin("age");
+      m_age_model->update(t_TempAge, dt_TempAge, age_inputs);
+      profiling.end("age");
+    }
+
+    // report energy model flags from the last sub-step only
+    m_stdout_flags = flags;
+
+    profiling.begin("energy");
+    energy_step();
+    profiling.end("energy");
+  }
+
+  if (semi_lagrangian_age) {
+    profiling.begin("age");
+    m_age_model->update(t0, dt_total, age_inputs);
+    profiling.end("age");
+  }
+
+  t_TempAge  = t0;
+  dt_TempAge = dt_total;
+
+  m_log->message(3,
+                 "  multirate: %d mass continuity steps, %d velocity samples,"
+                 " energy and age step of %.3f years (%d sub-steps)%s\n"
+                 "  multirate: strain heating that could not be applied: %.3e J\n",
+                 m_multirate.mass_steps, m_multirate.samples,
+                 units::convert(m_sys, dt_total, "seconds", "years"), N,
+                 m_multirate.velocity_changed ? ", triggered by velocity change" : "",
+                 m_multirate.strain_heating_defect);
+
+  m_multirate.velocity_changed = false;
+  m_multirate.mass_steps       = 0;
+  m_multirate.samples          = 0;
+  m_multirate.averaged_time    = 0.0;
+  m_strain_heating_accumulated.set(0.0);
+}
+
+} // end of namespace pism
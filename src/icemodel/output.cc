@@ -30,6 +30,7 @@
 #include "pism/util/Time.hh"
 #include "pism/util/error_handling.hh"
 #include "pism/util/io/File.hh"
+#include "pism/util/io/AsyncWriter.hh"
 #include "pism/util/pism_options.hh"
 
 #include "pism/util/Vars.hh"
@@ -96,6 +97,77 @@ void IceModel::write_metadata(const File &file, MappingTreatment mapping_flag,
   }
 }
 
+//! Initialize the asynchronous output of snapshots, spatially-varying time-series and backups.
+void IceModel::init_async_output() {
+  if (not m_config->get_flag("output.async.enabled")) {
+    return;
+  }
+
+  std::string format = m_config->get_string("output.format");
+  if (format != "netcdf3") {
+    m_log->message(2,
+                   "PISM WARNING: asynchronous output requires -o_format netcdf3 (got '%s').\n"
+                   "              Writing all files synchronously.\n",
+                   format.c_str());
+    return;
+  }
+
+  if (not io::AsyncWriter::supported()) {
+    m_log->message(2,
+                   "PISM WARNING: asynchronous output requires MPI_THREAD_FUNNELED support.\n"
+                   "              Writing all files synchronously.\n");
+    return;
+  }
+
+  // convert from MiB to bytes
+  size_t queue_size = m_config->get_number("output.async.queue_size") * 1024 * 1024;
+
+  m_async_writer.reset(new io::AsyncWriter(m_grid->com, queue_size));
+
+  m_log->message(2, "* Writing snapshots, spatially-varying time-series and backups asynchronously.\n");
+}
+
+/*!
+ * Wait for pending asynchronous writes to `filename` to complete. Has to be called before
+ * `filename` is opened.
+ */
+void IceModel::wait_for_async_output(const std::string &filename) {
+  if (m_async_writer) {
+    m_async_writer->wait(filename);
+  }
+}
+
+/*!
+ * Use the asynchronous writer (if enabled) to write distributed arrays to `file`. Arrays
+ * are written after `file` is closed.
+ */
+void IceModel::use_async_output(File &file) {
+  if (m_async_writer) {
+    file.set_async_writer(m_async_writer.get());
+  }
+}
+
+//! Wait for all asynchronous writes to complete and report I/O statistics.
+void IceModel::flush_async_output() {
+  if (not m_async_writer) {
+    return;
+  }
+
+  const Profiling &profiling = m_ctx->profiling();
+
+  profiling.begin("io.async_flush");
+  m_async_writer->flush();
+  profiling.end("io.async_flush");
+
+  io::AsyncWriter::Stats stats = m_async_writer->stats();
+
+  m_log->message(3,
+                 "Asynchronous output: wrote %d arrays (%.1f MiB) in %.3f seconds,"
+                 " waited for the writer for %.3f seconds\n",
+                 stats.n_arrays, stats.bytes / (1024.0 * 1024.0),
+                 stats.write_time, stats.wait_time);
+}
+
 //! Save model state in NetCDF format.
 /*!
 Calls save_variables() to do the actual work.
@@ -136,6 +208,10 @@ void IceModel::save_results() {
               PISM_READWRITE_MOVE,
               m_ctx->pio_iosys_id());
 
+    if (m_config->get_flag("output.binary_checkpoint")) {
+      file.start_binary_checkpoint(*m_grid);
+    }
+
     write_metadata(file, WRITE_MAPPING, PREPEND_HISTORY);
 
     write_run_stats(file);
@@ -186,6 +262,18 @@ void IceModel::save_variables(const File &file,
   // append to the time dimension
   io::append_time(file, *m_config, time);
 
+  const Profiling &profiling = m_ctx->profiling();
+
+  // Keep the file in the define mode until all variables are defined and all attributes
+  // are written: switching back and forth between define and data modes is expensive
+  // (see File::begin_define_batch()).
+  if (m_config->get_flag("output.define_batch.enabled")) {
+    // convert from MiB to bytes
+    size_t buffer_size = m_config->get_number("output.define_batch.buffer_size") * 1024 * 1024;
+    file.begin_define_batch(buffer_size);
+  }
+
+  profiling.begin("io.define");
   // Write metadata *before* everything else:
   //
   // FIXME: we should write this to variables instead of attributes because NetCDF-4 crashes after
@@ -195,6 +283,8 @@ void IceModel::save_variables(const File &file,
   if (kind == INCLUDE_MODEL_STATE) {
     define_model_state(file);
   }
+  // diagnostics are not a part of a binary checkpoint (see start_binary_checkpoint())
+  file.stop_binary_checkpoint();
   define_diagnostics(file, variables, default_diagnostics_type);
 
   // Done defining variables
@@ -235,10 +325,19 @@ void IceModel::save_variables(const File &file,
     }
   }
 
+  profiling.end("io.define");
+
+  profiling.begin("io.write");
   if (kind == INCLUDE_MODEL_STATE) {
     write_model_state(file);
   }
   write_diagnostics(file, variables);
+  profiling.end("io.write");
+
+  // end the define phase and write deferred data
+  profiling.begin("io.commit");
+  file.commit_define_batch();
+  profiling.end("io.commit");
 
   // find out how much time passed since the beginning of the run and save it to the output file
   {
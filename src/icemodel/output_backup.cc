@@ -21,6 +21,8 @@
 
 #include "pism/util/pism_utilities.hh"
 #include "pism/util/Profiling.hh"
+#include "pism/util/io/File.hh"
+#include "pism/util/io/io_helpers.hh"
 
 namespace pism {
 
@@ -36,6 +38,14 @@ void IceModel::init_backups() {
 
   m_backup_vars = output_variables(m_config->get_string("output.backup_size"));
   m_last_backup_time = 0.0;
+
+  m_backup_index.clear();
+  m_backup_delta = -1;
+}
+
+//! Name of the `n`-th delta file following the full backup `filename`.
+static std::string backup_delta_filename(const std::string &filename, int n) {
+  return filename_add_suffix(filename, pism::printf("_delta_%d", n), "");
 }
 
   //! Write a backup (i.e. an intermediate result of a run).
@@ -53,21 +63,54 @@ void IceModel::write_backup() {
 
   m_last_backup_time = wall_clock_hours;
 
+  // Incremental backups: a full backup is followed by up to max_deltas delta files
+  // containing spatial variables that changed since they were last written. Use the most
+  // recent delta file to restart.
+  int max_deltas = m_config->get_number("output.backup_deltas");
+
+  std::string filename = m_backup_filename;
+  if (max_deltas > 0) {
+    if (m_backup_delta >= 0 and m_backup_delta < max_deltas) {
+      m_backup_delta += 1;
+      filename = backup_delta_filename(m_backup_filename, m_backup_delta);
+    } else {
+      // start over with a full backup and remove delta files that would refer to the
+      // old one
+      m_backup_delta = 0;
+      m_backup_index.clear();
+      for (int k = 1; k <= max_deltas; ++k) {
+        io::remove_if_exists(m_grid->com, backup_delta_filename(m_backup_filename, k));
+      }
+    }
+  }
+
   // create a history string:
 
   m_log->message(2,
                  "  [%s] Saving an automatic backup to '%s' (%1.3f hours after the beginning of the run)\n",
-                 timestamp(m_grid->com).c_str(), m_backup_filename.c_str(), wall_clock_hours);
+                 timestamp(m_grid->com).c_str(), filename.c_str(), wall_clock_hours);
 
   double backup_start_time = get_time();
   profiling.begin("io.backup");
   {
+    wait_for_async_output(filename);
+
     File file(m_grid->com,
-              m_backup_filename,
+              filename,
               string_to_backend(m_config->get_string("output.format")),
               PISM_READWRITE_MOVE,
               m_ctx->pio_iosys_id());
 
+    use_async_output(file);
+
+    if (max_deltas > 0) {
+      file.set_backup_index(&m_backup_index);
+    }
+
+    if (m_config->get_flag("output.binary_checkpoint")) {
+      file.start_binary_checkpoint(*m_grid);
+    }
+
     write_metadata(file, WRITE_MAPPING, PREPEND_HISTORY);
     write_run_stats(file);
 
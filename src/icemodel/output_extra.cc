@@ -220,13 +220,55 @@ void IceModel::init_extras() {
   }
 #endif
 
+  // entries of output.extra.vars can have the form "name:method" to override
+  // output.extra.coarsening.method
+  std::map<std::string, io::Coarsening::Method> coarsening_methods;
+
   if (not vars.empty()) {
-    m_extra_vars = process_extra_shortcuts(*m_config, set_split(vars, ','));
+    std::set<std::string> names;
+    for (const auto &entry : set_split(vars, ',')) {
+      std::vector<std::string> parts = split(entry, ':');
+      if (parts.empty()) {
+        continue;
+      }
+      names.insert(parts[0]);
+
+      if (parts.size() > 1) {
+        coarsening_methods[parts[0]] = io::string_to_coarsening_method(parts[1]);
+      }
+    }
+
+    m_extra_vars = process_extra_shortcuts(*m_config, names);
     m_log->message(2, "variables requested: %s\n", vars.c_str());
   } else {
     m_log->message(2,
                    "PISM WARNING: output.extra.vars was not set. Writing the model state...\n");
   } // end of the else clause after "if (extra_vars_set)"
+
+  int coarsening_factor = m_config->get_number("output.extra.coarsening.factor");
+  if (coarsening_factor > 1) {
+    std::string method = m_config->get_string("output.extra.coarsening.method");
+
+    m_extra_coarsening.reset(new io::Coarsening(m_grid, coarsening_factor,
+                                                io::string_to_coarsening_method(method)));
+
+    for (const auto &m : coarsening_methods) {
+      auto d = m_diagnostics.find(m.first);
+      if (d != m_diagnostics.end()) {
+        // a diagnostic can correspond to more than one variable
+        for (unsigned int k = 0; k < d->second->n_variables(); ++k) {
+          m_extra_coarsening->set_method(d->second->metadata(k).get_name(), m.second);
+        }
+      } else {
+        m_extra_coarsening->set_method(m.first, m.second);
+      }
+    }
+
+    m_log->message(2, "coarsening spatial fields by the factor of %d (method: %s)\n",
+                   coarsening_factor, method.c_str());
+  } else {
+    m_extra_coarsening.reset();
+  }
 }
 
 //! Write spatially-variable diagnostic quantities.
@@ -314,11 +356,17 @@ void IceModel::write_extras() {
   profiling.begin("io.extra_file");
   {
     if (not m_extra_file) {
+      wait_for_async_output(filename);
+
       m_extra_file.reset(new File(m_grid->com,
                                   filename,
                                   string_to_backend(m_config->get_string("output.format")),
                                   mode,
                                   m_ctx->pio_iosys_id()));
+
+      use_async_output(*m_extra_file);
+
+      m_extra_file->set_coarsening(m_extra_coarsening.get());
     }
 
     std::string time_name = m_config->get_string("time.dimension_name");
@@ -357,8 +405,10 @@ void IceModel::write_extras() {
 
   flush_timeseries();
 
-  if (m_split_extra) {
+  if (m_split_extra or m_async_writer) {
     // each record is saved to a new file, so we can close this one
+    //
+    // in the asynchronous mode spatial fields are written after the file is closed
     m_extra_file.reset(nullptr);
   }
 
@@ -153,12 +153,16 @@ void IceModel::write_snapshot() {
   profiling.begin("io.snapshots");
   IO_Mode mode = m_snapshots_file_is_ready ? PISM_READWRITE : PISM_READWRITE_MOVE;
   {
+    wait_for_async_output(filename);
+
     File file(m_grid->com,
               filename,
               string_to_backend(m_config->get_string("output.format")),
               mode,
               m_ctx->pio_iosys_id());
 
+    use_async_output(file);
+
     if (not m_snapshots_file_is_ready) {
       write_metadata(file, WRITE_MAPPING, PREPEND_HISTORY);
 
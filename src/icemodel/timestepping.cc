@@ -34,6 +34,7 @@
 #include "pism/frontretreat/FrontRetreat.hh"
 
 #include "pism/energy/EnergyModel.hh"
+#include "pism/age/AgeModel.hh"
 #include "pism/coupler/OceanModel.hh"
 #include "pism/coupler/FrontalMelt.hh"
 
@@ -116,6 +117,13 @@ void IceModel::max_timestep(double &dt_result, unsigned int &skip_counter_result
 
   // get time-stepping restrictions from sub-models
   for (auto m : m_submodels) {
+    if (m_multirate.enabled and
+        (m.second == m_energy_model or m.second == m_age_model.get())) {
+      // with multirate coupling energy and age models sub-cycle using their own time
+      // step (see multirate_energy_age_step()) and do not restrict the mass continuity
+      // step
+      continue;
+    }
     restrictions.push_back(m.second->max_timestep(current_time));
   }
 
@@ -147,7 +155,8 @@ void IceModel::max_timestep(double &dt_result, unsigned int &skip_counter_result
 
     restrictions.push_back(m_front_retreat->max_timestep(m_geometry.cell_type,
                                                          m_ssa_dirichlet_bc_mask,
-                                                         retreat_rate));
+                                                         retreat_rate,
+                                                         m_front_band.get()));
   }
 
   // Always consider the maximum allowed time-step length.
@@ -157,6 +166,14 @@ void IceModel::max_timestep(double &dt_result, unsigned int &skip_counter_result
                                        "max"));
   }
 
+  // Sliding windows used to buffer forcing fields in the streaming mode cover time steps
+  // of at most this length (see IceModelVec2T::streaming_window()).
+  if (m_config->get_flag("input.forcing.streaming.enabled")) {
+    restrictions.push_back(MaxTimestep(m_config->get_number("input.forcing.streaming.max_time_step",
+                                                            "seconds"),
+                                       "forcing streaming"));
+  }
+
   // Never go past the end of a run.
   const double time_to_end = m_time->end() - current_time;
   if (time_to_end > 0.0) {
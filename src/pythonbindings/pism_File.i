@@ -1,14 +1,22 @@
 %{
 #include "util/io/File.hh"
 #include "util/io/io_helpers.hh"
+#include "util/io/BackupIndex.hh"
+#include "util/io/Coarsening.hh"
+#include "util/io/AsyncWriter.hh"
 %}
 
 %ignore pism::File::read_variable(const std::string &, const std::vector<unsigned int> &, const std::vector<unsigned int> &, double *) const;
 %ignore pism::File::write_variable(const std::string &, const std::vector<unsigned int> &, const std::vector<unsigned int> &, const double *) const;
+%ignore pism::io::Coarsening::coarsen;
+%ignore pism::io::AsyncWriter::write_array;
 
 %include "util/io/IO_Flags.hh"
 %include "util/io/File.hh"
 %include "util/io/io_helpers.hh"
+%include "util/io/BackupIndex.hh"
+%include "util/io/Coarsening.hh"
+%include "util/io/AsyncWriter.hh"
 
 %extend pism::File
 {
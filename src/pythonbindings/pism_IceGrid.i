@@ -22,4 +22,6 @@
 }
 
 %shared_ptr(pism::IceGrid);
+// LocalInterpCtx is an implementation detail of regridding
+%ignore pism::IceGrid::interpolation_context;
 %include "util/IceGrid.hh"
@@ -4,8 +4,12 @@
 #include "frontretreat/calving/FloatKill.hh"
 #include "frontretreat/calving/HayhurstCalving.hh"
 #include "frontretreat/calving/vonMisesCalving.hh"
+#include "frontretreat/util/FrontBand.hh"
 %}
 
+%ignore pism::BandPoints;
+%include "frontretreat/util/FrontBand.hh"
+
 %shared_ptr(pism::calving::CalvingAtThickness)
 %rename(CalvingAtThickness) pism::calving::CalvingAtThickness;
 %include "frontretreat/calving/CalvingAtThickness.hh"
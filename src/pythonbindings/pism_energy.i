@@ -38,4 +38,5 @@ using pism::MaskValue;
 %include "regional/EnthalpyModel_Regional.hh"
 
 %ignore pism::energy::BedrockColumn::solve(double, double, double, const double *, double *);
+%ignore pism::energy::BedrockColumn::steady_state(double, double, double *) const;
 %include "energy/BedrockColumn.hh"
@@ -1,4 +1,4 @@
-/* Copyright (C) 2014, 2015 PISM Authors
+/* Copyright (C) 2014, 2015, 2019 PISM Authors
  *
  * This file is part of PISM.
  *
@@ -20,6 +20,7 @@
 #include "ColumnInterpolation.hh"
 
 #include <cmath>
+#include <algorithm>
 
 namespace pism {
 
@@ -37,86 +38,62 @@ std::vector<double> ColumnInterpolation::coarse_to_fine(const std::vector<double
 }
 
 void ColumnInterpolation::coarse_to_fine(const double *input, unsigned int ks, double *result) const {
-  if (m_use_linear_interpolation) {
-    coarse_to_fine_linear(input, ks, result);
-  } else {
-    coarse_to_fine_quadratic(input, ks, result);
+  const unsigned int
+    Mz = Mz_fine(),
+    N  = std::min(ks + 1, Mz);
+
+  const unsigned int
+    *k0 = m_c2f_k0.data(),
+    *k1 = m_c2f_k1.data(),
+    *k2 = m_c2f_k2.data();
+  const double
+    *w0 = m_c2f_w0.data(),
+    *w1 = m_c2f_w1.data(),
+    *w2 = m_c2f_w2.data();
+
+  for (unsigned int k = 0; k < N; ++k) {
+    result[k] = w0[k] * input[k0[k]] + w1[k] * input[k1[k]] + w2[k] * input[k2[k]];
   }
-}
-
-void ColumnInterpolation::coarse_to_fine_linear(const double *input, unsigned int ks,
-                                                double *result) const {
-  const unsigned int Mzfine = Mz_fine();
-  const unsigned int Mzcoarse = Mz_coarse();
-
-  for (unsigned int k = 0; k < Mzfine; ++k) {
-    if (k > ks) {
-      result[k] = input[m_coarse2fine[k]];
-      continue;
-    }
-
-    unsigned int m = m_coarse2fine[k];
-
-    // extrapolate (if necessary):
-    if (m == Mzcoarse - 1) {
-      result[k] = input[Mzcoarse - 1];
-      continue;
-    }
 
-    const double incr = (m_z_fine[k] - m_z_coarse[m]) / (m_z_coarse[m + 1] - m_z_coarse[m]);
-    result[k] = input[m] + incr * (input[m + 1] - input[m]);
+  // use constant extrapolation above the ice surface
+  for (unsigned int k = N; k < Mz; ++k) {
+    result[k] = input[m_coarse2fine[k]];
   }
 }
 
-void ColumnInterpolation::coarse_to_fine_quadratic(const double *input, unsigned int ks,
-                                                   double *result) const {
-  unsigned int k = 0, m = 0;
-  const unsigned int Mz = Mz_coarse();
-  for (m = 0; m < Mz - 2 and k <= ks; ++m) {
-
-    const double
-      z0      = m_z_coarse[m],
-      z1      = m_z_coarse[m + 1],
-      dz_inv  = m_constants[3 * m + 0], // = 1.0 / (z1 - z0)
-      dz1_inv = m_constants[3 * m + 1], // = 1.0 / (z2 - z0)
-      dz2_inv = m_constants[3 * m + 2], // = 1.0 / (z2 - z1)
-      f0      = input[m],
-      f1      = input[m + 1],
-      f2      = input[m + 2];
-
-    const double
-      d1 = (f1 - f0) * dz_inv,
-      d2 = (f2 - f0) * dz1_inv,
-      b  = (d2 - d1) * dz2_inv,
-      a  = d1 - b * (z1 - z0),
-      c  = f0;
-
-    for (; m_z_fine[k] < z1 and k <= ks; ++k) {
-      const double s = m_z_fine[k] - z0;
-
-      result[k] = s * (a + b * s) + c;
-    }
-  } // m-loop
-
-  // check if we got to the end of the m-loop and use linear
-  // interpolation between the remaining 2 coarse levels
-  if (m == Mz - 2) {
+/*!
+ * Interpolate `n_columns` columns at once.
+ *
+ * The loop over columns is the inner loop, so indexes and weights are loaded once for all
+ * columns in a batch.
+ */
+void ColumnInterpolation::coarse_to_fine(const double * const *input, unsigned int n_columns,
+                                         unsigned int ks, double * const *result) const {
+  const unsigned int
+    Mz = Mz_fine(),
+    N  = std::min(ks + 1, Mz);
+
+  for (unsigned int k = 0; k < N; ++k) {
+    const unsigned int
+      k0 = m_c2f_k0[k],
+      k1 = m_c2f_k1[k],
+      k2 = m_c2f_k2[k];
     const double
-      z0 = m_z_coarse[m],
-      z1 = m_z_coarse[m + 1],
-      f0 = input[m],
-      f1 = input[m + 1],
-      lambda = (f1 - f0) / (z1 - z0);
+      w0 = m_c2f_w0[k],
+      w1 = m_c2f_w1[k],
+      w2 = m_c2f_w2[k];
 
-    for (; m_z_fine[k] < z1; ++k) {
-      result[k] = f0 + lambda * (m_z_fine[k] - z0);
+    for (unsigned int c = 0; c < n_columns; ++c) {
+      const double *f = input[c];
+      result[c][k] = w0 * f[k0] + w1 * f[k1] + w2 * f[k2];
     }
   }
 
-  // fill the rest using constant extrapolation
-  const double f0 = input[Mz - 1];
-  for (; k <= ks; ++k) {
-    result[k] = f0;
+  for (unsigned int k = N; k < Mz; ++k) {
+    const unsigned int m = m_coarse2fine[k];
+    for (unsigned int c = 0; c < n_columns; ++c) {
+      result[c][k] = input[c][m];
+    }
   }
 }
 
@@ -129,14 +106,16 @@ std::vector<double> ColumnInterpolation::fine_to_coarse(const std::vector<double
 void ColumnInterpolation::fine_to_coarse(const double *input, double *result) const {
   const unsigned int N = Mz_coarse();
 
-  for (unsigned int k = 0; k < N - 1; ++k) {
-    const int m = m_fine2coarse[k];
+  const unsigned int
+    *k0 = m_f2c_k0.data(),
+    *k1 = m_f2c_k1.data();
+  const double
+    *w0 = m_f2c_w0.data(),
+    *w1 = m_f2c_w1.data();
 
-    const double increment = (m_z_coarse[k] - m_z_fine[m]) / (m_z_fine[m + 1] - m_z_fine[m]);
-    result[k] = input[m] + increment * (input[m + 1] - input[m]);
+  for (unsigned int k = 0; k < N; ++k) {
+    result[k] = w0[k] * input[k0[k]] + w1[k] * input[k1[k]];
   }
-
-  result[N - 1] = input[m_fine2coarse[N - 1]];
 }
 
 unsigned int ColumnInterpolation::Mz_coarse() const {
@@ -199,6 +178,125 @@ static std::vector<unsigned int> init_interpolation_indexes(const std::vector<do
   return result;
 }
 
+void ColumnInterpolation::set_coarse_to_fine_weights(unsigned int k,
+                                                     unsigned int k0, double w0,
+                                                     unsigned int k1, double w1,
+                                                     unsigned int k2, double w2) {
+  m_c2f_k0[k] = k0;
+  m_c2f_k1[k] = k1;
+  m_c2f_k2[k] = k2;
+  m_c2f_w0[k] = w0;
+  m_c2f_w1[k] = w1;
+  m_c2f_w2[k] = w2;
+}
+
+/*!
+ * Linear interpolation from the equally-spaced coarse grid.
+ */
+void ColumnInterpolation::init_coarse_to_fine_linear() {
+  const unsigned int Mz = Mz_coarse();
+
+  for (unsigned int k = 0; k < Mz_fine(); ++k) {
+    unsigned int m = m_coarse2fine[k];
+
+    // extrapolate (if necessary):
+    if (m == Mz - 1) {
+      set_coarse_to_fine_weights(k, m, 1.0, m, 0.0, m, 0.0);
+      continue;
+    }
+
+    const double incr = (m_z_fine[k] - m_z_coarse[m]) / (m_z_coarse[m + 1] - m_z_coarse[m]);
+    set_coarse_to_fine_weights(k, m, 1.0 - incr, m + 1, incr, m + 1, 0.0);
+  }
+}
+
+/*!
+ * Quadratic interpolation from a non-uniform coarse grid.
+ *
+ * Fine grid values in the interval `[z_coarse[m], z_coarse[m + 1])` are computed using the
+ * quadratic polynomial that interpolates values at `z_coarse[m]`, `z_coarse[m + 1]`, and
+ * `z_coarse[m + 2]`. We use linear interpolation in the last interval and constant
+ * extrapolation above `z_coarse.back()`.
+ *
+ * Writing this polynomial as `f0 + d1 * s + b * s * (s - (z1 - z0))` with `s = z - z0`,
+ * `d1 = (f1 - f0) / (z1 - z0)`, `d2 = (f2 - f0) / (z2 - z0)`, and `b = (d2 - d1) / (z2 - z1)`
+ * gives weights of `f0`, `f1`, and `f2` below.
+ */
+void ColumnInterpolation::init_coarse_to_fine_quadratic() {
+  const unsigned int
+    Mz     = Mz_coarse(),
+    Mzfine = Mz_fine();
+
+  unsigned int k = 0, m = 0;
+  for (m = 0; m < Mz - 2 and k < Mzfine; ++m) {
+    const double
+      z0     = m_z_coarse[m],
+      z1     = m_z_coarse[m + 1],
+      z2     = m_z_coarse[m + 2],
+      h01    = 1.0 / (z1 - z0),
+      h02    = 1.0 / (z2 - z0),
+      h12    = 1.0 / (z2 - z1);
+
+    for (; k < Mzfine and m_z_fine[k] < z1; ++k) {
+      const double
+        s  = m_z_fine[k] - z0,
+        t  = s * (s - (z1 - z0)) * h12,
+        w1 = h01 * (s - t),
+        w2 = h02 * t;
+
+      set_coarse_to_fine_weights(k, m, 1.0 - w1 - w2, m + 1, w1, m + 2, w2);
+    }
+  } // m-loop
+
+  // check if we got to the end of the m-loop and use linear
+  // interpolation between the remaining 2 coarse levels
+  if (m == Mz - 2) {
+    const double
+      z0 = m_z_coarse[m],
+      z1 = m_z_coarse[m + 1];
+
+    for (; k < Mzfine and m_z_fine[k] < z1; ++k) {
+      const double lambda = (m_z_fine[k] - z0) / (z1 - z0);
+
+      set_coarse_to_fine_weights(k, m, 1.0 - lambda, m + 1, lambda, m + 1, 0.0);
+    }
+  }
+
+  // fill the rest using constant extrapolation
+  for (; k < Mzfine; ++k) {
+    set_coarse_to_fine_weights(k, Mz - 1, 1.0, Mz - 1, 0.0, Mz - 1, 0.0);
+  }
+}
+
+void ColumnInterpolation::init_fine_to_coarse() {
+  const unsigned int
+    N      = Mz_coarse(),
+    Mzfine = Mz_fine();
+
+  m_f2c_k0.resize(N);
+  m_f2c_k1.resize(N);
+  m_f2c_w0.resize(N);
+  m_f2c_w1.resize(N);
+
+  for (unsigned int k = 0; k < N; ++k) {
+    const unsigned int m = m_fine2coarse[k];
+
+    if (k == N - 1 or m == Mzfine - 1) {
+      m_f2c_k0[k] = m;
+      m_f2c_k1[k] = m;
+      m_f2c_w0[k] = 1.0;
+      m_f2c_w1[k] = 0.0;
+      continue;
+    }
+
+    const double increment = (m_z_coarse[k] - m_z_fine[m]) / (m_z_fine[m + 1] - m_z_fine[m]);
+    m_f2c_k0[k] = m;
+    m_f2c_k1[k] = m + 1;
+    m_f2c_w0[k] = 1.0 - increment;
+    m_f2c_w1[k] = increment;
+  }
+}
+
 void ColumnInterpolation::init_interpolation() {
 
   // coarse -> fine
@@ -222,21 +320,24 @@ void ColumnInterpolation::init_interpolation() {
     m_use_linear_interpolation = false;
   }
 
-  // initialize quadratic interpolation constants
-  if (not m_use_linear_interpolation) {
-    const unsigned int N = Mz_coarse() - 2;
-    m_constants.resize(3 * N);
-    for (unsigned int m = 0; m < N; ++m) {
-      const double
-        z0 = m_z_coarse[m],
-        z1 = m_z_coarse[m + 1],
-        z2 = m_z_coarse[m + 2];
-      m_constants[3 * m + 0] = 1.0 / (z1 - z0);
-      m_constants[3 * m + 1] = 1.0 / (z2 - z0);
-      m_constants[3 * m + 2] = 1.0 / (z2 - z1);
+  // pre-compute interpolation weights
+  {
+    const unsigned int N = Mz_fine();
+    m_c2f_k0.resize(N);
+    m_c2f_k1.resize(N);
+    m_c2f_k2.resize(N);
+    m_c2f_w0.resize(N);
+    m_c2f_w1.resize(N);
+    m_c2f_w2.resize(N);
+
+    if (m_use_linear_interpolation) {
+      init_coarse_to_fine_linear();
+    } else {
+      init_coarse_to_fine_quadratic();
     }
-  }
 
+    init_fine_to_coarse();
+  }
 }
 
 } // end of namespace pism
@@ -1,4 +1,4 @@
-/* Copyright (C) 2014, 2015 PISM Authors
+/* Copyright (C) 2014, 2015, 2019 PISM Authors
  *
  * This file is part of PISM.
  *
@@ -24,6 +24,15 @@
 
 namespace pism {
 
+/*!
+ * Interpolation between the (possibly non-uniform) "coarse" storage grid and the
+ * equally-spaced "fine" grid used by column systems.
+ *
+ * Interpolation operators are pre-computed in the constructor and stored in a sparse form:
+ * each fine (coarse) grid value is a weighted sum of at most three coarse (two fine) grid
+ * values. Indexes and weights are stored in separate arrays so that the inner loops are
+ * branch-free and can be vectorized by the compiler.
+ */
 class ColumnInterpolation {
 public:
   ColumnInterpolation(const std::vector<double> &z_coarse,
@@ -32,6 +41,10 @@ public:
   void coarse_to_fine(const double *input, unsigned int ks, double *result) const;
   void fine_to_coarse(const double *input, double *result) const;
 
+  // Interpolate a batch of columns sharing the same index of the ice surface.
+  void coarse_to_fine(const double * const *input, unsigned int n_columns,
+                      unsigned int ks, double * const *result) const;
+
   // These two methods allocate fresh storage for the output.
   std::vector<double> coarse_to_fine(const std::vector<double> &input, unsigned int ks) const;
   std::vector<double> fine_to_coarse(const std::vector<double> &input) const;
@@ -44,7 +57,6 @@ public:
   const std::vector<double>& z_fine() const;
 private:
   std::vector<double> m_z_fine, m_z_coarse;
-  std::vector<double> m_constants;
 
   // Array m_coarse2fine contains indices of the ice coarse vertical grid
   // that are just below a level of the fine grid. I.e. m_coarse2fine[k] is
@@ -53,9 +65,26 @@ private:
   std::vector<unsigned int> m_coarse2fine, m_fine2coarse;
   bool m_use_linear_interpolation;
 
+  // Coarse-to-fine interpolation: the value at the fine grid level k is
+  //
+  // w0[k] * input[k0[k]] + w1[k] * input[k1[k]] + w2[k] * input[k2[k]].
+  std::vector<unsigned int> m_c2f_k0, m_c2f_k1, m_c2f_k2;
+  std::vector<double> m_c2f_w0, m_c2f_w1, m_c2f_w2;
+
+  // Fine-to-coarse interpolation: the value at the coarse grid level k is
+  //
+  // w0[k] * input[k0[k]] + w1[k] * input[k1[k]].
+  std::vector<unsigned int> m_f2c_k0, m_f2c_k1;
+  std::vector<double> m_f2c_w0, m_f2c_w1;
+
   void init_interpolation();
-  void coarse_to_fine_linear(const double *input, unsigned int ks, double *result) const;
-  void coarse_to_fine_quadratic(const double *input, unsigned int ks, double *result) const;
+  void init_coarse_to_fine_linear();
+  void init_coarse_to_fine_quadratic();
+  void init_fine_to_coarse();
+  void set_coarse_to_fine_weights(unsigned int k,
+                                  unsigned int k0, double w0,
+                                  unsigned int k1, double w1,
+                                  unsigned int k2, double w2);
 };
 
 } // end of namespace pism
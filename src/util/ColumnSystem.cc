@@ -292,6 +292,12 @@ void columnSystemCtx::coarse_to_fine(const IceModelVec3 &coarse, int i, int j,
   m_interp->coarse_to_fine(array, m_ks, fine);
 }
 
+//! Interpolate a batch of `n_columns` coarse grid columns onto the fine grid.
+void columnSystemCtx::coarse_to_fine(const double * const *coarse, unsigned int n_columns,
+                                     double * const *fine) const {
+  m_interp->coarse_to_fine(coarse, n_columns, m_ks, fine);
+}
+
 void columnSystemCtx::init_fine_grid(const std::vector<double>& storage_grid) {
   // Compute m_dz as the minimum vertical spacing in the coarse
   // grid:
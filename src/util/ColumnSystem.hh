@@ -184,6 +184,8 @@ protected:
   void init_fine_grid(const std::vector<double>& storage_grid);
 
   void coarse_to_fine(const IceModelVec3 &coarse, int i, int j, double* fine) const;
+  void coarse_to_fine(const double * const *coarse, unsigned int n_columns,
+                      double * const *fine) const;
 };
 
 } // end of namespace pism
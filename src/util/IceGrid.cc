@@ -18,6 +18,7 @@
 
 #include <cassert>
 
+#include <list>
 #include <map>
 #include <numeric>
 #include <petscsys.h>
@@ -31,6 +32,7 @@
 #include "pism_options.hh"
 #include "error_handling.hh"
 #include "pism/util/io/File.hh"
+#include "pism/util/io/LocalInterpCtx.hh"
 #include "pism/util/Vars.hh"
 #include "pism/util/Logger.hh"
 #include "pism/util/projection.hh"
@@ -117,11 +119,22 @@ struct IceGrid::Impl {
 
   //! ParallelIO I/O decompositions.
   std::map<int, int> io_decompositions;
+
+  //! Aggregation groups used by serial I/O backends (created on first use).
+  IceGrid::IOAggregation io_aggregation;
+
+  //! Interpolation contexts used to regrid from input files, most recently used first.
+  struct CachedInterpolation {
+    std::vector<double> x, y, z, z_output;
+    InterpolationType type;
+    std::shared_ptr<LocalInterpCtx> context;
+  };
+  std::list<CachedInterpolation> interpolation_contexts;
 };
 
 IceGrid::Impl::Impl(Context::ConstPtr context)
   : ctx(context), mapping_info("mapping", ctx->unit_system()) {
-  // empty
+  io_aggregation.group = MPI_COMM_NULL;
 }
 
 //! Convert a string to Periodicity.
@@ -359,6 +372,14 @@ IceGrid::~IceGrid() {
   }
 #endif
 
+  if (m_impl->io_aggregation.group != MPI_COMM_NULL) {
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (not finalized) {
+      MPI_Comm_free(&m_impl->io_aggregation.group);
+    }
+  }
+
   delete m_impl;
 }
 
@@ -1483,4 +1504,84 @@ int IceGrid::pio_io_decomposition(int dof, int output_datatype) const {
   return result;
 }
 
+/*!
+ * Split processes into groups, each covering a contiguous block of rows (`j`) of the grid.
+ *
+ * Serial I/O backends gather data within a group onto one process (an *aggregator*) and
+ * then write one large hyperslab per group. The number of groups is set by
+ * `output.aggregators` (one group per row of sub-domains if zero).
+ *
+ * This is a collective operation the first time it is called.
+ */
+const IceGrid::IOAggregation& IceGrid::io_aggregation() const {
+  IOAggregation &result = m_impl->io_aggregation;
+
+  if (result.group == MPI_COMM_NULL) {
+    const int
+      Nx = m_impl->procs_x.size(),
+      Ny = m_impl->procs_y.size();
+
+    int N = m_impl->ctx->config()->get_number("output.aggregators");
+    if (N <= 0 or N > Ny) {
+      N = Ny;
+    }
+
+    // PETSc's DMDA numbers processes in the x direction first, so processes
+    // [Nx * q, Nx * (q + 1)) own the row q of sub-domains
+    const int
+      rows_per_group = (Ny + N - 1) / N,
+      group_size     = rows_per_group * Nx;
+
+    int err = MPI_Comm_split(com, m_impl->rank / group_size, m_impl->rank, &result.group);
+    if (err != MPI_SUCCESS) {
+      throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                    "failed to create an I/O aggregation communicator");
+    }
+
+    result.aggregators.clear();
+    for (int r = 0; r < m_impl->size; r += group_size) {
+      result.aggregators.push_back(r);
+    }
+  }
+
+  return result;
+}
+
+/*!
+ * Return the interpolation context (indices, weights, the hyperslab to read and the read
+ * buffer) used to regrid from an input grid `input` to this grid and vertical levels
+ * `z_output`.
+ *
+ * Input files usually contain many variables on the same grid, so contexts are cached
+ * and re-used. This is a collective operation.
+ */
+std::shared_ptr<LocalInterpCtx> IceGrid::interpolation_context(const grid_info &input,
+                                                               const std::vector<double> &z_output,
+                                                               InterpolationType type) const {
+  // maximum number of cached contexts (each one holds a read buffer)
+  const size_t max_size = 4;
+
+  auto &cache = m_impl->interpolation_contexts;
+
+  for (auto c = cache.begin(); c != cache.end(); ++c) {
+    if (c->type == type and
+        c->x == input.x and c->y == input.y and c->z == input.z and
+        c->z_output == z_output) {
+      // move to the front
+      cache.splice(cache.begin(), cache, c);
+      return cache.front().context;
+    }
+  }
+
+  std::shared_ptr<LocalInterpCtx> result(new LocalInterpCtx(input, *this, z_output, type));
+
+  cache.push_front({input.x, input.y, input.z, z_output, type, result});
+
+  if (cache.size() > max_size) {
+    cache.pop_back();
+  }
+
+  return result;
+}
+
 } // end of namespace pism
@@ -27,6 +27,7 @@
 #include "pism/util/Context.hh"
 #include "pism/util/ConfigInterface.hh"
 #include "pism/util/petscwrappers/DM.hh"
+#include "pism/util/interpolation.hh"
 
 namespace pism {
 
@@ -38,6 +39,7 @@ class Vars;
 class Logger;
 
 class MappingInfo;
+class LocalInterpCtx;
 
 typedef enum {UNKNOWN = 0, EQUAL, QUADRATIC} SpacingType;
 typedef enum {NOT_PERIODIC = 0, X_PERIODIC = 1, Y_PERIODIC = 2, XY_PERIODIC = 3} Periodicity;
@@ -297,6 +299,22 @@ public:
 
   int pio_io_decomposition(int dof, int output_datatype) const;
 
+  //! Groups of processes used to aggregate data before writing it using a serial I/O
+  //! backend.
+  struct IOAggregation {
+    //! communicator containing processes in the group of this process
+    MPI_Comm group;
+    //! ranks (in `com`) of processes aggregating data in each group, in the order of
+    //! increasing `y`
+    std::vector<int> aggregators;
+  };
+
+  const IOAggregation& io_aggregation() const;
+
+  std::shared_ptr<LocalInterpCtx> interpolation_context(const grid_info &input,
+                                                        const std::vector<double> &z_output,
+                                                        InterpolationType type) const;
+
   //! Maximum number of degrees of freedom supported by PISM.
   /*!
    * This is also the maximum number of records an IceModelVec2T can hold.
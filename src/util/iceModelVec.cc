@@ -21,6 +21,7 @@
 #include "pism_utilities.hh"
 #include "iceModelVec.hh"
 #include "pism/util/io/File.hh"
+#include "pism/util/io/BackupIndex.hh"
 #include "Time.hh"
 #include "IceGrid.hh"
 #include "ConfigInterface.hh"
@@ -484,11 +485,43 @@ void IceModelVec::read_impl(const File &file, const unsigned int time) {
 }
 
 //! \brief Define variables corresponding to an IceModelVec in a file opened using `file`.
+/*!
+ * If `file` uses a backup index (see File::set_backup_index()), variables that did not
+ * change since they were written to an earlier backup file are defined but marked as
+ * stored in that file. write_spatial_variable() skips them.
+ */
 void IceModelVec::define(const File &file, IO_Type default_type) const {
+  io::BackupIndex *index = file.backup_index();
+
+  // backup files are in the same directory, so we record the file name only
+  std::string filename = file.filename();
+  filename = filename.substr(filename.rfind('/') + 1);
+
+  bool have_checksum = false;
+  uint64_t checksum = 0;
+
   for (unsigned int j = 0; j < m_dof; ++j) {
     IO_Type type = metadata(j).get_output_type();
     type = type == PISM_NAT ? default_type : type;
+
+    std::string name = metadata(j).get_name();
+    if (index == nullptr or file.find_variable(name)) {
+      io::define_spatial_variable(metadata(j), *m_grid, file, type);
+      continue;
+    }
+
+    if (not have_checksum) {
+      checksum = fletcher64();
+      have_checksum = true;
+    }
+
+    std::string source = index->update(name, checksum, filename);
+
     io::define_spatial_variable(metadata(j), *m_grid, file, type);
+
+    if (not source.empty()) {
+      file.write_attribute(name, "pism_backup_source", source);
+    }
   }
 }
 
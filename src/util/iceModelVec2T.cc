@@ -30,6 +30,7 @@
 #include "io/io_helpers.hh"
 #include "pism/util/Logger.hh"
 #include "pism/util/interpolation.hh"
+#include "pism/util/io/Prefetcher.hh"
 
 namespace pism {
 
@@ -59,13 +60,17 @@ IceModelVec2T::Ptr IceModelVec2T::ForcingField(IceGrid::ConstPtr grid,
                                                bool periodic,
                                                InterpolationType interpolation_type) {
 
+  bool streaming = (not periodic and
+                    grid->ctx()->config()->get_flag("input.forcing.streaming.enabled"));
+
   int n_records = file.nrecords(short_name, standard_name,
                                     grid->ctx()->unit_system());
 
-  if (not periodic) {
+  if (not periodic and not streaming) {
     n_records = std::min(n_records, max_buffer_size);
   }
-  // In the periodic case we try to keep all the records in RAM.
+  // In the periodic case we try to keep all the records in RAM. In the streaming mode
+  // the buffer size is computed in init(), once we know times of all the records.
 
   // Allocate storage for one record if the variable was not found. This is needed to be
   // able to cheaply allocate and then discard an "-atmosphere given" model
@@ -73,7 +78,7 @@ IceModelVec2T::Ptr IceModelVec2T::ForcingField(IceGrid::ConstPtr grid,
   n_records = std::max(n_records, 1);
 
   // LCOV_EXCL_START
-  if (n_records > IceGrid::max_dm_dof) {
+  if (not streaming and n_records > IceGrid::max_dm_dof) {
     throw RuntimeError::formatted(PISM_ERROR_LOCATION,
                                   "cannot allocate storage for %d records of %s (%s)"
                                   " (exceeds the maximum of %d)",
@@ -87,14 +92,16 @@ IceModelVec2T::Ptr IceModelVec2T::ForcingField(IceGrid::ConstPtr grid,
   }
 
   return IceModelVec2T::Ptr(new IceModelVec2T(grid, short_name, n_records,
-                                              evaluations_per_year, interpolation_type));
+                                              evaluations_per_year, interpolation_type,
+                                              streaming));
 }
 
 
 IceModelVec2T::IceModelVec2T(IceGrid::ConstPtr grid, const std::string &short_name,
                              unsigned int n_records,
                              unsigned int n_evaluations_per_year,
-                             InterpolationType interpolation_type)
+                             InterpolationType interpolation_type,
+                             bool streaming)
   : IceModelVec2S(grid, short_name, WITHOUT_GHOSTS, 1),
     m_array3(nullptr),
     m_n_records(n_records),
@@ -103,7 +110,11 @@ IceModelVec2T::IceModelVec2T(IceGrid::ConstPtr grid, const std::string &short_na
     m_first(-1),
     m_interp_type(interpolation_type),
     m_period(0),
-    m_reference_time(0.0)
+    m_reference_time(0.0),
+    m_streaming(streaming),
+    m_bytes_read(0),
+    m_bytes_reread(0),
+    m_bytes_prefetched(0)
 {
   m_report_range = false;
 
@@ -113,6 +124,11 @@ IceModelVec2T::IceModelVec2T(IceGrid::ConstPtr grid, const std::string &short_na
     throw RuntimeError(PISM_ERROR_LOCATION, "unsupported interpolation type");
   }
 
+  if (m_streaming) {
+    // storage for records is allocated in init() and init_constant()
+    return;
+  }
+
   // LCOV_EXCL_START
   if (n_records > IceGrid::max_dm_dof) {
     throw RuntimeError::formatted(PISM_ERROR_LOCATION,
@@ -138,13 +154,35 @@ unsigned int IceModelVec2T::n_records() {
   return m_n_records;
 }
 
+//! Total amount of forcing data read so far (in bytes, counting full records on the
+//! computational grid).
+size_t IceModelVec2T::bytes_read() const {
+  return m_bytes_read;
+}
+
+//! Amount of forcing data that had to be read more than once (in bytes).
+size_t IceModelVec2T::bytes_reread() const {
+  return m_bytes_reread;
+}
+
+//! Amount of forcing data taken from records read in the background (in bytes).
+size_t IceModelVec2T::bytes_prefetched() const {
+  return m_bytes_prefetched;
+}
+
+//! Records stored at the grid point (i, j) in the streaming mode.
+float* IceModelVec2T::column(int i, int j) {
+  size_t offset = (j - m_grid->ys()) * m_grid->xm() + (i - m_grid->xs());
+  return &m_records[offset * m_n_records];
+}
+
 double*** IceModelVec2T::get_array3() {
   begin_access();
   return reinterpret_cast<double***>(m_array3);
 }
 
 void IceModelVec2T::begin_access() const {
-  if (m_access_counter == 0) {
+  if (m_access_counter == 0 and not m_streaming) {
     PetscErrorCode ierr = DMDAVecGetArrayDOF(*m_da3, m_v3, &m_array3);
     PISM_CHK(ierr, "DMDAVecGetArrayDOF");
   }
@@ -158,7 +196,7 @@ void IceModelVec2T::end_access() const {
   // this call will decrement the m_access_counter
   IceModelVec2S::end_access();
 
-  if (m_access_counter == 0) {
+  if (m_access_counter == 0 and not m_streaming) {
     PetscErrorCode ierr = DMDAVecRestoreArrayDOF(*m_da3, m_v3, &m_array3);
     PISM_CHK(ierr, "DMDAVecRestoreArrayDOF");
     m_array3 = NULL;
@@ -256,6 +294,33 @@ void IceModelVec2T::init(const std::string &fname, unsigned int period, double r
                                   m_filename.c_str());
   }
 
+  if (m_streaming) {
+    m_n_records = streaming_window();
+    m_records.resize((size_t)m_grid->xm() * m_grid->ym() * m_n_records);
+    // the layout of the buffer depends on its size: discard records read earlier
+    m_N     = 0;
+    m_first = -1;
+
+    log.message(3,
+                "  %s: buffering at most %d of %d records (streaming mode)\n",
+                m_name.c_str(), m_n_records, (int)m_time.size());
+  }
+
+  m_was_read.assign(m_time.size(), false);
+
+  m_prefetcher.reset();
+  if (m_period == 0 and m_time.size() > m_n_records and
+      m_grid->ctx()->config()->get_flag("input.forcing.prefetch")) {
+    if (io::Prefetcher::supported()) {
+      m_prefetcher.reset(new io::Prefetcher(m_grid->com));
+    } else {
+      log.message(2,
+                  "PISM WARNING: %s: prefetching requires MPI_THREAD_FUNNELED support.\n"
+                  "              Reading records synchronously.\n",
+                  m_name.c_str());
+    }
+  }
+
   if (m_period != 0) {
     if ((size_t)m_n_records < m_time.size()) {
       throw RuntimeError(PISM_ERROR_LOCATION,
@@ -270,6 +335,11 @@ void IceModelVec2T::init(const std::string &fname, unsigned int period, double r
 //! Initialize as constant in time and space
 void IceModelVec2T::init_constant(double value) {
 
+  if (m_streaming) {
+    m_n_records = 1;
+    m_records.resize((size_t)m_grid->xm() * m_grid->ym());
+  }
+
   // set constant value everywhere
   set(value);
   set_record(0);
@@ -326,13 +396,51 @@ void IceModelVec2T::update(double t, double dt) {
   // buffer:
   if (N > m_n_records) {
     throw RuntimeError::formatted(PISM_ERROR_LOCATION,
-                                  "cannot read %d records of %s (buffer size: %d)",
-                                  N, m_name.c_str(), m_n_records);
+                                  "cannot read %d records of %s (buffer size: %d)%s",
+                                  N, m_name.c_str(), m_n_records,
+                                  m_streaming ?
+                                  "\nincrease input.forcing.streaming.max_time_step" : "");
   }
 
   update(first);
 }
 
+/*!
+ * Compute the number of records the sliding window (the buffer in the streaming mode) has
+ * to hold to cover the interpolation stencil and any time interval that is no longer than
+ * `input.forcing.streaming.max_time_step`.
+ */
+unsigned int IceModelVec2T::streaming_window() const {
+  const size_t N = m_time.size();
+
+  if (m_period != 0) {
+    // periodic data are read all at once
+    return N;
+  }
+
+  const double dt = m_grid->ctx()->config()->get_number("input.forcing.streaming.max_time_step",
+                                                        "seconds");
+
+  // linear interpolation needs one more record on the right
+  const size_t stencil = m_interp_type == PIECEWISE_CONSTANT ? 1 : 2;
+
+  size_t result = 1;
+  for (size_t k = 0, last = 0; k < N; ++k) {
+    // an interval (t, t + dt) with t in the k-th interval cannot reach records that start
+    // after t_max
+    double t_max = m_time_bounds[2 * k + 1] + dt;
+
+    last = std::max(last, k);
+    while (last + 1 < N and m_time[last + 1] <= t_max) {
+      last += 1;
+    }
+
+    result = std::max(result, last - k + stencil);
+  }
+
+  return std::min(result, N);
+}
+
 //! Update by reading at most n_records records from the file.
 void IceModelVec2T::update(unsigned int start) {
 
@@ -394,20 +502,74 @@ void IceModelVec2T::update(unsigned int start) {
 
   const bool allow_extrapolation = m_grid->ctx()->config()->get_flag("grid.allow_extrapolation");
 
-  for (unsigned int j = 0; j < missing; ++j) {
-    {
-      petsc::VecArray tmp_array(m_v);
-      io::regrid_spatial_variable(m_metadata[0], *m_grid, file, start + j, CRITICAL,
-                                  m_report_range, allow_extrapolation,
-                                  0.0, m_interpolation_type, tmp_array.get());
-    }
+  // read all missing records at once
+  const size_t record_size = m_grid->xm() * m_grid->ym();
+  std::vector<double> records(record_size * missing);
+  bool prefetched = io::regrid_records(m_metadata[0], *m_grid, file, start, missing,
+                                       m_report_range, allow_extrapolation,
+                                       m_interpolation_type, m_prefetcher.get(),
+                                       records.data());
 
+  for (unsigned int j = 0; j < missing; ++j) {
     m_grid->ctx()->log()->message(5, " %s: reading entry #%02d, year %s...\n",
                                   m_name.c_str(),
                                   start + j,
                                   t->date(m_time[start + j]).c_str());
+  }
 
-    set_record(kept + j);
+  if (m_streaming) {
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      const size_t offset = (j - m_grid->ys()) * m_grid->xm() + (i - m_grid->xs());
+
+      float *c = column(i, j);
+      for (unsigned int k = 0; k < missing; ++k) {
+        c[kept + k] = records[k * record_size + offset];
+      }
+    }
+  } else {
+    double ***a3 = get_array3();
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      const size_t offset = (j - m_grid->ys()) * m_grid->xm() + (i - m_grid->xs());
+
+      for (unsigned int k = 0; k < missing; ++k) {
+        a3[j][i][kept + k] = records[k * record_size + offset];
+      }
+    }
+    end_access();
+  }
+
+  // update I/O statistics
+  {
+    const size_t record_bytes = m_grid->Mx() * m_grid->My() * sizeof(double);
+    for (unsigned int k = 0; k < missing; ++k) {
+      if (m_was_read[start + k]) {
+        m_bytes_reread += record_bytes;
+      }
+      m_was_read[start + k] = true;
+    }
+    m_bytes_read += missing * record_bytes;
+    if (prefetched) {
+      m_bytes_prefetched += missing * record_bytes;
+    }
+
+    log->message(3,
+                 "  %s: read %d records (total: %.1f MiB, re-read: %.1f MiB)\n",
+                 m_name.c_str(), missing,
+                 m_bytes_read / 1048576.0, m_bytes_reread / 1048576.0);
+  }
+
+  if (m_prefetcher) {
+    // start reading the block of records that will be needed next
+    unsigned int next = start + missing;
+    if (next < time_size) {
+      auto var = file.find_variable(m_metadata[0].get_name(),
+                                    m_metadata[0].get_string("standard_name"));
+      m_prefetcher->request(file.filename(), var.name, next, m_n_records);
+    }
   }
 }
 
@@ -420,6 +582,17 @@ void IceModelVec2T::discard(int number) {
 
   m_N -= number;
 
+  if (m_streaming) {
+    for (Points p(*m_grid); p; p.next()) {
+      float *c = column(p.i(), p.j());
+
+      for (unsigned int k = 0; k < m_N; ++k) {
+        c[k] = c[k + number];
+      }
+    }
+    return;
+  }
+
   double ***a3 = get_array3();
   for (Points p(*m_grid); p; p.next()) {
     const int i = p.i(), j = p.j();
@@ -434,6 +607,15 @@ void IceModelVec2T::discard(int number) {
 //! Sets the record number n to the contents of the (internal) Vec v.
 void IceModelVec2T::set_record(int n) {
 
+  if (m_streaming) {
+    IceModelVec::AccessList list{this};
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+      column(i, j)[n] = (*this)(i, j);
+    }
+    return;
+  }
+
   double  **a2 = get_array();
   double ***a3 = get_array3();
   for (Points p(*m_grid); p; p.next()) {
@@ -447,6 +629,15 @@ void IceModelVec2T::set_record(int n) {
 //! Sets the (internal) Vec v to the contents of the nth record.
 void IceModelVec2T::get_record(int n) {
 
+  if (m_streaming) {
+    IceModelVec::AccessList list{this};
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+      (*this)(i, j) = column(i, j)[n];
+    }
+    return;
+  }
+
   double  **a2 = get_array();
   double ***a3 = get_array3();
   for (Points p(*m_grid); p; p.next()) {
@@ -573,10 +764,18 @@ void IceModelVec2T::init_interpolation(const std::vector<double> &ts) {
  *
  */
 void IceModelVec2T::interp(int i, int j, std::vector<double> &result) {
-  double ***a3 = (double***) m_array3;
-
   result.resize(m_interp->alpha().size());
 
+  if (m_streaming) {
+    const float *c = column(i, j);
+    m_column.assign(c, c + m_N);
+
+    m_interp->interpolate(m_column.data(), result.data());
+    return;
+  }
+
+  double ***a3 = (double***) m_array3;
+
   m_interp->interpolate(a3[j][i], result.data());
 }
 
@@ -590,8 +789,12 @@ double IceModelVec2T::average(int i, int j) {
   double result = 0.0;
 
   if (m_N == 1) {
-    double ***a3 = (double***) m_array3;
-    result = a3[j][i][0];
+    if (m_streaming) {
+      result = column(i, j)[0];
+    } else {
+      double ***a3 = (double***) m_array3;
+      result = a3[j][i][0];
+    }
   } else {
     std::vector<double> values(M);
 
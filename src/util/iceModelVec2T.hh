@@ -19,17 +19,30 @@
 #ifndef __IceModelVec2T_hh
 #define __IceModelVec2T_hh
 
+#include <memory>
+
 #include "iceModelVec.hh"
 #include "MaxTimestep.hh"
 
 namespace pism {
 
+namespace io {
+class Prefetcher;
+}
+
 //! A class for storing and accessing 2D time-series (for climate forcing)
 /*! This class was created to read time-dependent and spatially-varying climate
   forcing data, in particular snow temperatures and precipitation.
 
   If requests (calls to update()) go in sequence, every records should be read
-  only once.
+  only once. Each process reads all the records it needs using one (multi-record) read.
+  If `input.forcing.prefetch` is set, the next block of records is read in the
+  background while the model uses the current one.
+
+  In the "streaming" mode (see `input.forcing.streaming.enabled`) the buffer is a sliding
+  window sized to cover the interpolation stencil and the longest time step
+  (`input.forcing.streaming.max_time_step`) and buffered records are stored in single
+  precision.
 
   Note that this class is optimized for use with a PDD scheme -- it stores
   records so that data corresponding to a grid point are stored in adjacent
@@ -55,11 +68,16 @@ public:
 
   IceModelVec2T(IceGrid::ConstPtr grid, const std::string &short_name, unsigned int n_records,
                 unsigned int n_evaluations_per_year,
-                InterpolationType interpolation_type = PIECEWISE_CONSTANT);
+                InterpolationType interpolation_type = PIECEWISE_CONSTANT,
+                bool streaming = false);
   virtual ~IceModelVec2T();
 
   unsigned int n_records();
 
+  size_t bytes_read() const;
+  size_t bytes_reread() const;
+  size_t bytes_prefetched() const;
+
   void init(const std::string &filename, unsigned int period, double reference_time);
   void init_constant(double value);
 
@@ -102,7 +120,28 @@ private:
   unsigned int m_period;        // in years
   double m_reference_time;      // in seconds
 
+  //! reads the next block of records in the background (if enabled)
+  std::unique_ptr<io::Prefetcher> m_prefetcher;
+
+  //! true if the buffer is a sliding window storing records in single precision
+  bool m_streaming;
+  //! buffered records in the streaming mode (m_n_records values per grid point)
+  std::vector<float> m_records;
+  //! work space used to interpolate single precision records
+  std::vector<double> m_column;
+
+  //! flags indicating which records were read at least once
+  std::vector<bool> m_was_read;
+  //! total amount of data read from the file
+  size_t m_bytes_read;
+  //! amount of data read from the file more than once
+  size_t m_bytes_reread;
+  //! amount of data read in the background (see io::Prefetcher)
+  size_t m_bytes_prefetched;
+
   double*** get_array3();
+  float* column(int i, int j);
+  unsigned int streaming_window() const;
   void update(unsigned int start);
   void discard(int N);
   double average(int i, int j);
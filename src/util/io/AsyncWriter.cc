@@ -0,0 +1,479 @@
+/* Copyright (C) 2020 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>               // fprintf, stderr
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "AsyncWriter.hh"
+#include "NCFile.hh"
+#include "pism/util/IceGrid.hh"
+#include "pism/util/error_handling.hh"
+#include "pism/util/pism_utilities.hh"
+
+// The following is a stupid kludge necessary to make NetCDF 4.x work in
+// serial mode in an MPI program:
+#ifndef MPI_INCLUDED
+#define MPI_INCLUDED 1
+#endif
+#include <netcdf.h>
+
+namespace pism {
+namespace io {
+
+namespace {
+
+//! A gathered array waiting to be written.
+struct Job {
+  std::string variable_name;
+  std::vector<size_t> start;
+  std::vector<size_t> count;
+  std::vector<double> data;
+};
+
+//! All arrays that should be written to a file.
+struct Batch {
+  Batch() : bytes(0) {}
+
+  std::string filename;
+  std::vector<Job> jobs;
+  size_t bytes;
+};
+
+double seconds_since(const std::chrono::steady_clock::time_point &start) {
+  std::chrono::duration<double> result = std::chrono::steady_clock::now() - start;
+  return result.count();
+}
+
+} // end of anonymous namespace
+
+struct AsyncWriter::Impl {
+  MPI_Comm com;
+  int rank;
+  size_t max_queue_size;
+
+  // Members below are used on rank 0 only.
+
+  //! buffers for files that are still open (accessed by the main thread only)
+  std::map<std::string, Batch> staged;
+
+  //! protects members below
+  std::mutex mutex;
+  //! signals changes of the queue and of the "done" flag
+  std::condition_variable changed;
+
+  //! batches submitted to the writer thread
+  std::deque<Batch> queue;
+  //! total size of submitted batches that are not written yet
+  size_t queued_bytes;
+  //! number of batches that are not written yet, per file
+  std::map<std::string, int> pending;
+  //! the first error message reported by the writer thread
+  std::string error;
+  //! set to stop the writer thread
+  bool done;
+
+  Stats stats;
+
+  std::thread thread;
+};
+
+//! Write all arrays in `batch`. Returns an error message (an empty string on success).
+static std::string write_batch(const Batch &batch) {
+  std::recursive_mutex &library = NCFile::library_mutex();
+
+  int file_id = -1;
+  int stat = NC_NOERR;
+  {
+    std::lock_guard<std::recursive_mutex> lock(library);
+    stat = nc_open(batch.filename.c_str(), NC_WRITE, &file_id);
+  }
+  if (stat != NC_NOERR) {
+    return "failed to open " + batch.filename + ": " + nc_strerror(stat);
+  }
+
+  std::string message;
+  for (const auto &job : batch.jobs) {
+    std::lock_guard<std::recursive_mutex> lock(library);
+
+    int variable_id = -1;
+    stat = nc_inq_varid(file_id, job.variable_name.c_str(), &variable_id);
+    if (stat == NC_NOERR) {
+      stat = nc_put_vara_double(file_id, variable_id,
+                                job.start.data(), job.count.data(), job.data.data());
+    }
+
+    if (stat != NC_NOERR) {
+      message = "failed to write " + job.variable_name + " to " + batch.filename + ": " +
+        nc_strerror(stat);
+      break;
+    }
+  }
+
+  {
+    std::lock_guard<std::recursive_mutex> lock(library);
+    stat = nc_close(file_id);
+  }
+  if (stat != NC_NOERR and message.empty()) {
+    message = "failed to close " + batch.filename + ": " + nc_strerror(stat);
+  }
+
+  return message;
+}
+
+static void writer_thread(AsyncWriter::Impl *impl) {
+  while (true) {
+    Batch batch;
+    {
+      std::unique_lock<std::mutex> lock(impl->mutex);
+      while (impl->queue.empty() and not impl->done) {
+        impl->changed.wait(lock);
+      }
+
+      if (impl->queue.empty()) {
+        // done and there is nothing left to write
+        return;
+      }
+
+      batch = std::move(impl->queue.front());
+      impl->queue.pop_front();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::string message = write_batch(batch);
+    double write_time = seconds_since(start);
+
+    {
+      std::lock_guard<std::mutex> lock(impl->mutex);
+
+      impl->queued_bytes -= batch.bytes;
+
+      impl->pending[batch.filename] -= 1;
+      if (impl->pending[batch.filename] == 0) {
+        impl->pending.erase(batch.filename);
+      }
+
+      if (impl->error.empty()) {
+        impl->error = message;
+      }
+
+      impl->stats.n_arrays   += batch.jobs.size();
+      impl->stats.bytes      += batch.bytes;
+      impl->stats.write_time += write_time;
+    }
+    impl->changed.notify_all();
+  }
+}
+
+/*!
+ * @param[in] com MPI communicator
+ * @param[in] max_queue_size maximum total size of staging buffers handed to the writer
+ *                           thread, in bytes
+ */
+AsyncWriter::AsyncWriter(MPI_Comm com, size_t max_queue_size)
+  : m_impl(new Impl) {
+  if (not supported()) {
+    delete m_impl;
+    throw RuntimeError(PISM_ERROR_LOCATION,
+                       "asynchronous output requires MPI_THREAD_FUNNELED or higher");
+  }
+
+  m_impl->com            = com;
+  m_impl->max_queue_size = max_queue_size;
+  m_impl->queued_bytes   = 0;
+  m_impl->done           = false;
+  m_impl->stats          = {0, 0.0, 0.0, 0.0};
+
+  MPI_Comm_rank(com, &m_impl->rank);
+
+  if (m_impl->rank == 0) {
+    m_impl->thread = std::thread(writer_thread, m_impl);
+  }
+}
+
+AsyncWriter::~AsyncWriter() {
+  if (m_impl->thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(m_impl->mutex);
+      m_impl->done = true;
+    }
+    m_impl->changed.notify_all();
+    // the writer thread finishes writing submitted batches before it stops
+    m_impl->thread.join();
+
+    if (not m_impl->error.empty()) {
+      fprintf(stderr, "PISM ERROR: asynchronous output failed: %s\n",
+              m_impl->error.c_str());
+    }
+  }
+  delete m_impl;
+}
+
+/*!
+ * Gather a distributed array on rank 0 and add it to the staging buffer of the file
+ * `filename`.
+ *
+ * This is a collective operation. The total size of staged and submitted arrays is
+ * limited by `max_queue_size`: if adding this array would exceed the limit, this call
+ * blocks until the writer thread catches up. Staged arrays are not written until their
+ * file is closed, so if the limit is still exceeded once all submitted arrays are written
+ * this array is not staged and this method returns false (on all ranks). The caller has
+ * to write it synchronously in this case.
+ *
+ * The variable `variable_name` has to be defined in `filename`. Data are written once the
+ * file is closed (see submit()).
+ */
+bool AsyncWriter::write_array(const std::string &filename,
+                              const std::string &variable_name,
+                              const IceGrid &grid,
+                              unsigned int z_count,
+                              bool time_dependent,
+                              unsigned int record,
+                              const double *input) {
+  const int
+    xs = grid.xs(),
+    ys = grid.ys(),
+    xm = grid.xm(),
+    ym = grid.ym(),
+    Mx = grid.Mx(),
+    My = grid.My();
+
+  const size_t bytes = (size_t)Mx * My * z_count * sizeof(double);
+
+  // back-pressure: wait until there is enough room for this array
+  int fits = 1;
+  if (m_impl->rank == 0) {
+    auto start = std::chrono::steady_clock::now();
+
+    size_t staged = 0;
+    for (const auto &b : m_impl->staged) {
+      staged += b.second.bytes;
+    }
+
+    std::unique_lock<std::mutex> lock(m_impl->mutex);
+    while (m_impl->queued_bytes > 0 and
+           m_impl->queued_bytes + staged + bytes > m_impl->max_queue_size) {
+      m_impl->changed.wait(lock);
+    }
+
+    fits = m_impl->queued_bytes + staged + bytes <= m_impl->max_queue_size;
+
+    m_impl->stats.wait_time += seconds_since(start);
+  }
+
+  MPI_Bcast(&fits, 1, MPI_INT, 0, m_impl->com);
+
+  if (not fits) {
+    return false;
+  }
+
+  int size = 1;
+  MPI_Comm_size(m_impl->com, &size);
+
+  const int patch[4] = {xs, ys, xm, ym};
+  std::vector<int> patches(m_impl->rank == 0 ? 4 * size : 0);
+  MPI_Gather(patch, 4, MPI_INT, patches.data(), 4, MPI_INT, 0, m_impl->com);
+
+  std::vector<int> counts, displacements;
+  std::vector<double> buffer;
+  if (m_impl->rank == 0) {
+    counts.resize(size);
+    displacements.resize(size);
+
+    int total = 0;
+    for (int r = 0; r < size; ++r) {
+      counts[r]        = patches[4 * r + 2] * patches[4 * r + 3] * z_count;
+      displacements[r] = total;
+      total += counts[r];
+    }
+    buffer.resize(total);
+  }
+
+  MPI_Gatherv(const_cast<double*>(input), xm * ym * z_count, MPI_DOUBLE,
+              buffer.data(), counts.data(), displacements.data(), MPI_DOUBLE,
+              0, m_impl->com);
+
+  if (m_impl->rank != 0) {
+    return true;
+  }
+
+  Job job;
+  job.variable_name = variable_name;
+
+  // time
+  if (time_dependent) {
+    job.start.push_back(record);
+    job.count.push_back(1);
+  }
+  // y
+  job.start.push_back(0);
+  job.count.push_back(My);
+  // x
+  job.start.push_back(0);
+  job.count.push_back(Mx);
+  // z (these are not used when writing 2D fields)
+  job.start.push_back(0);
+  job.count.push_back(z_count);
+
+  // re-arrange patches into the (y, x, z) array covering the whole grid
+  job.data.resize((size_t)Mx * My * z_count);
+  for (int r = 0; r < size; ++r) {
+    const int
+      r_xs = patches[4 * r + 0],
+      r_ys = patches[4 * r + 1],
+      r_xm = patches[4 * r + 2],
+      r_ym = patches[4 * r + 3];
+
+    const double *patch_data = buffer.data() + displacements[r];
+
+    for (int j = 0; j < r_ym; ++j) {
+      for (int i = 0; i < r_xm; ++i) {
+        const double *column = patch_data + ((size_t)j * r_xm + i) * z_count;
+        double *result = job.data.data() + ((size_t)(r_ys + j) * Mx + (r_xs + i)) * z_count;
+        for (unsigned int k = 0; k < z_count; ++k) {
+          result[k] = column[k];
+        }
+      }
+    }
+  }
+
+  Batch &batch = m_impl->staged[filename];
+  batch.filename = filename;
+  batch.bytes += bytes;
+  batch.jobs.emplace_back(std::move(job));
+
+  return true;
+}
+
+/*!
+ * Hand staged arrays for `filename` to the writer thread.
+ *
+ * Should be called after `filename` is closed by the main thread. Does not need to be
+ * called on all ranks.
+ */
+void AsyncWriter::submit(const std::string &filename) {
+  if (m_impl->rank != 0) {
+    return;
+  }
+
+  auto it = m_impl->staged.find(filename);
+  if (it == m_impl->staged.end()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    m_impl->queued_bytes += it->second.bytes;
+    m_impl->pending[filename] += 1;
+    m_impl->queue.emplace_back(std::move(it->second));
+  }
+  m_impl->staged.erase(it);
+
+  m_impl->changed.notify_all();
+}
+
+/*!
+ * Wait until all submitted arrays for `filename` are written.
+ *
+ * This is a collective operation. It has to be called before `filename` is opened by the
+ * main thread.
+ */
+void AsyncWriter::wait(const std::string &filename) {
+  if (m_impl->rank == 0) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(m_impl->mutex);
+    while (m_impl->pending.find(filename) != m_impl->pending.end()) {
+      m_impl->changed.wait(lock);
+    }
+
+    m_impl->stats.wait_time += seconds_since(start);
+  }
+
+  check_errors();
+}
+
+/*!
+ * Wait until all submitted arrays are written.
+ *
+ * This is a collective operation.
+ */
+void AsyncWriter::flush() {
+  if (m_impl->rank == 0) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(m_impl->mutex);
+    while (not m_impl->pending.empty()) {
+      m_impl->changed.wait(lock);
+    }
+
+    m_impl->stats.wait_time += seconds_since(start);
+  }
+
+  check_errors();
+}
+
+/*!
+ * Throw an exception (on all ranks) if the writer thread reported an error.
+ */
+void AsyncWriter::check_errors() {
+  std::string message;
+  if (m_impl->rank == 0) {
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    message = m_impl->error;
+    m_impl->error.clear();
+  }
+
+  unsigned int length = message.size();
+  MPI_Bcast(&length, 1, MPI_UNSIGNED, 0, m_impl->com);
+
+  if (length > 0) {
+    message.resize(length);
+    MPI_Bcast(&message[0], length, MPI_CHAR, 0, m_impl->com);
+
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "asynchronous output failed: %s", message.c_str());
+  }
+}
+
+/*!
+ * Returns true if the MPI library supports the thread level needed by this class.
+ *
+ * The writer thread does not make MPI calls, so it is enough to have
+ * `MPI_THREAD_FUNNELED`.
+ */
+bool AsyncWriter::supported() {
+  return mpi_thread_funneled();
+}
+
+/*!
+ * Returns I/O statistics (meaningful on rank 0 only).
+ */
+AsyncWriter::Stats AsyncWriter::stats() const {
+  std::lock_guard<std::mutex> lock(m_impl->mutex);
+  return m_impl->stats;
+}
+
+} // end of namespace io
+} // end of namespace pism
@@ -0,0 +1,94 @@
+/* Copyright (C) 2020 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PISM_ASYNCWRITER_H
+#define PISM_ASYNCWRITER_H
+
+#include <string>
+#include <mpi.h>
+
+namespace pism {
+
+class IceGrid;
+
+namespace io {
+
+//! Writes distributed arrays to NetCDF-3 files in a background thread.
+/*!
+ * Arrays are gathered on rank 0 and copied into staging buffers. Buffers for a given file
+ * are handed to a writer thread (running on rank 0) once this file is closed by the main
+ * thread (see submit()), so that the model can continue time-stepping while data are
+ * written.
+ *
+ * The total size of staged and submitted but not yet written buffers is limited:
+ * write_array() blocks (on all ranks) until enough data are written if this limit is
+ * reached, and asks the caller to write synchronously if waiting does not help.
+ *
+ * The writer thread does not make any MPI calls. All calls to the NetCDF library are
+ * serialized using NCFile::library_mutex().
+ */
+class AsyncWriter {
+public:
+  AsyncWriter(MPI_Comm com, size_t max_queue_size);
+  ~AsyncWriter();
+
+  static bool supported();
+
+  bool write_array(const std::string &filename,
+                   const std::string &variable_name,
+                   const IceGrid &grid,
+                   unsigned int z_count,
+                   bool time_dependent,
+                   unsigned int record,
+                   const double *input);
+
+  void submit(const std::string &filename);
+
+  void wait(const std::string &filename);
+
+  void flush();
+
+  struct Stats {
+    //! number of arrays written
+    unsigned int n_arrays;
+    //! number of bytes written
+    double bytes;
+    //! time spent writing (in the writer thread), in seconds
+    double write_time;
+    //! time the main thread spent waiting for the writer thread, in seconds
+    double wait_time;
+  };
+
+  Stats stats() const;
+
+  struct Impl;
+private:
+  Impl *m_impl;
+
+  void check_errors();
+
+  // disable copying and assignments
+  AsyncWriter(const AsyncWriter &other);
+  AsyncWriter & operator=(const AsyncWriter &);
+};
+
+} // end of namespace io
+} // end of namespace pism
+
+#endif /* PISM_ASYNCWRITER_H */
@@ -0,0 +1,49 @@
+/* Copyright (C) 2020 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "BackupIndex.hh"
+
+namespace pism {
+namespace io {
+
+//! Forget all recorded variables (the next backup file will contain all of them).
+void BackupIndex::clear() {
+  m_records.clear();
+}
+
+/*!
+ * Record the `checksum` of `variable_name` that is about to be written to `filename`.
+ *
+ * Returns the name of the file containing the same data if this variable did not change,
+ * or an empty string if it has to be written to `filename`.
+ */
+std::string BackupIndex::update(const std::string &variable_name, uint64_t checksum,
+                                const std::string &filename) {
+  auto r = m_records.find(variable_name);
+
+  if (r == m_records.end() or r->second.checksum != checksum) {
+    m_records[variable_name] = {checksum, filename};
+    return "";
+  }
+
+  return r->second.filename;
+}
+
+} // end of namespace io
+} // end of namespace pism
@@ -0,0 +1,56 @@
+/* Copyright (C) 2020 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PISM_BACKUPINDEX_H
+#define PISM_BACKUPINDEX_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace pism {
+namespace io {
+
+//! Keeps track of spatial variables written to a sequence of backup files.
+/*!
+ * A backup file that uses an index contains only spatial variables that changed since
+ * they were last written. Variables that did not change are defined (so that they can be
+ * found) but not written; the attribute `pism_backup_source` of such a variable contains
+ * the name of the file containing its data. See File::set_backup_index().
+ *
+ * Changes are detected by comparing checksums (see IceModelVec::fletcher64()).
+ */
+class BackupIndex {
+public:
+  void clear();
+
+  std::string update(const std::string &variable_name, uint64_t checksum,
+                     const std::string &filename);
+private:
+  struct Record {
+    uint64_t checksum;
+    std::string filename;
+  };
+  std::map<std::string, Record> m_records;
+};
+
+} // end of namespace io
+} // end of namespace pism
+
+#endif /* PISM_BACKUPINDEX_H */
@@ -0,0 +1,406 @@
+/* Copyright (C) 2020 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cmath>                // sin, cos, atan2
+#include <map>
+#include <vector>
+
+#include "Coarsening.hh"
+#include "pism/util/error_handling.hh"
+#include "pism/util/pism_utilities.hh"
+#include "pism/util/Context.hh"
+#include "pism/util/ConfigInterface.hh"
+#include "pism/util/projection.hh"
+#include "pism/util/petscwrappers/Vec.hh"
+
+namespace pism {
+namespace io {
+
+struct Coarsening::Impl {
+  IceGrid::ConstPtr fine;
+  IceGrid::Ptr coarse;
+  int factor;
+  Method method;
+  //! methods used for some variables instead of `method`
+  std::map<std::string, Method> methods;
+};
+
+//! Which point(s) of a block contribute to the corresponding coarse grid value.
+enum Rule {BLOCK_AVERAGE, BLOCK_CENTER, BLOCK_CORNERS};
+
+/*!
+ * Compute ownership ranges of the coarse grid (blocks of `factor` points) aligned with
+ * ownership ranges `fine` of the computational grid: a block belongs to the process
+ * owning its central point.
+ *
+ * Falls back to an even distribution if this leaves a process without blocks.
+ */
+static std::vector<unsigned int> coarse_ownership_ranges(const PetscInt *fine,
+                                                         unsigned int n_procs,
+                                                         unsigned int factor,
+                                                         unsigned int n_blocks) {
+  std::vector<unsigned int> result(n_procs, 0);
+
+  unsigned int start = 0;
+  for (unsigned int p = 0; p < n_procs; ++p) {
+    for (unsigned int b = 0; b < n_blocks; ++b) {
+      unsigned int center = b * factor + (factor - 1) / 2;
+      if (center >= start and center < start + fine[p]) {
+        result[p] += 1;
+      }
+    }
+    start += fine[p];
+  }
+
+  for (auto n : result) {
+    if (n == 0) {
+      for (unsigned int p = 0; p < n_procs; ++p) {
+        result[p] = n_blocks / n_procs + (p < n_blocks % n_procs ? 1 : 0);
+      }
+      break;
+    }
+  }
+
+  return result;
+}
+
+/*!
+ * @param[in] grid computational grid
+ * @param[in] factor coarsening factor (number of grid points in each direction that are
+ *                   combined into one)
+ * @param[in] method coarsening method
+ */
+Coarsening::Coarsening(IceGrid::ConstPtr grid, unsigned int factor, Method method)
+  : m_impl(new Impl) {
+
+  m_impl->fine   = grid;
+  m_impl->factor = factor;
+  m_impl->method = method;
+
+  const unsigned int
+    Mx = grid->Mx() / factor,
+    My = grid->My() / factor;
+
+  if (factor < 2 or Mx < 3 or My < 3) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "cannot coarsen a %d x %d grid by the factor of %d",
+                                  grid->Mx(), grid->My(), factor);
+  }
+
+  // domain decomposition of the computational grid
+  PetscInt Nx = 0, Ny = 0;
+  const PetscInt *lx = nullptr, *ly = nullptr;
+  {
+    auto da = grid->get_dm(1, 0);
+
+    PetscErrorCode ierr = DMDAGetInfo(*da, NULL, NULL, NULL, NULL, &Nx, &Ny,
+                                      NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    PISM_CHK(ierr, "DMDAGetInfo");
+
+    ierr = DMDAGetOwnershipRanges(*da, &lx, &ly, NULL);
+    PISM_CHK(ierr, "DMDAGetOwnershipRanges");
+  }
+
+  if (Mx < (unsigned int)Nx or My < (unsigned int)Ny) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "cannot distribute a coarse %d x %d grid across %d x %d processes",
+                                  Mx, My, (int)Nx, (int)Ny);
+  }
+
+  // Offset of coarse grid points relative to the first point of a block, in units of grid
+  // spacing of the computational grid.
+  const double offset = method == AVERAGE ? (factor - 1) / 2.0 : (factor - 1) / 2;
+
+  const double
+    dx = grid->dx(),
+    dy = grid->dy(),
+    x_min = grid->x(0) + offset * dx,
+    x_max = grid->x((Mx - 1) * factor) + offset * dx,
+    y_min = grid->y(0) + offset * dy,
+    y_max = grid->y((My - 1) * factor) + offset * dy;
+
+  GridParameters P(grid->ctx()->config());
+  P.Mx           = Mx;
+  P.My           = My;
+  P.x0           = 0.5 * (x_min + x_max);
+  P.y0           = 0.5 * (y_min + y_max);
+  P.Lx           = 0.5 * (x_max - x_min);
+  P.Ly           = 0.5 * (y_max - y_min);
+  P.registration = CELL_CORNER;
+  P.periodicity  = NOT_PERIODIC;
+  P.z            = grid->z();
+  P.procs_x      = coarse_ownership_ranges(lx, Nx, factor, Mx);
+  P.procs_y      = coarse_ownership_ranges(ly, Ny, factor, My);
+
+  m_impl->coarse = IceGrid::Ptr(new IceGrid(grid->ctx(), P));
+  m_impl->coarse->set_mapping_info(grid->get_mapping_info());
+}
+
+Coarsening::~Coarsening() {
+  delete m_impl;
+}
+
+//! The coarse grid.
+IceGrid::ConstPtr Coarsening::grid() const {
+  return m_impl->coarse;
+}
+
+//! Use `method` to coarsen the variable `variable_name`.
+void Coarsening::set_method(const std::string &variable_name, Method method) {
+  m_impl->methods[variable_name] = method;
+}
+
+/*!
+ * Add `values` (corresponding to `indices` of the coarse grid in the natural ordering) to
+ * a field on the coarse grid and put the result in `output`.
+ *
+ * This is a collective operation.
+ */
+static void assemble(const IceGrid &coarse, unsigned int nlevels,
+                     const std::vector<PetscInt> &indices, const std::vector<double> &values,
+                     double *output) {
+  PetscErrorCode ierr = 0;
+
+  auto da = coarse.get_dm(nlevels, 0);
+
+  petsc::Vec result;
+  ierr = DMCreateGlobalVector(*da, result.rawptr());
+  PISM_CHK(ierr, "DMCreateGlobalVector");
+
+  ierr = VecSet(result, 0.0);
+  PISM_CHK(ierr, "VecSet");
+
+  // contributions to blocks owned by other processes are communicated during assembly
+  ierr = VecSetValues(result, indices.size(), indices.data(), values.data(), ADD_VALUES);
+  PISM_CHK(ierr, "VecSetValues");
+
+  ierr = VecAssemblyBegin(result);
+  PISM_CHK(ierr, "VecAssemblyBegin");
+
+  ierr = VecAssemblyEnd(result);
+  PISM_CHK(ierr, "VecAssemblyEnd");
+
+  // the storage order of a global DMDA Vec matches the one used by PISM's I/O code
+  petsc::VecArray array(result);
+  const double *data = array.get();
+  const size_t size = coarse.xm() * coarse.ym() * nlevels;
+  for (size_t n = 0; n < size; ++n) {
+    output[n] = data[n];
+  }
+}
+
+/*!
+ * Coarsen a field with `nlevels` levels.
+ *
+ * Computes `output` (on the coarse grid) from `input` (on the computational grid) using
+ * `rule`. If `fill_value` is not NULL, block averages skip points equal to it. This is a
+ * collective operation.
+ */
+static void coarsen_field(const IceGrid &fine, const IceGrid &coarse, int factor,
+                          Rule rule, unsigned int nlevels, const double *fill_value,
+                          const double *input, double *output) {
+  PetscErrorCode ierr = 0;
+
+  const int
+    Mx = coarse.Mx(),
+    My = coarse.My(),
+    center = (factor - 1) / 2,
+    // blocks overlapping the part of the computational grid owned by this process
+    I0 = fine.xs() / factor,
+    J0 = fine.ys() / factor,
+    I1 = std::min((fine.xs() + fine.xm() - 1) / factor, Mx - 1),
+    J1 = std::min((fine.ys() + fine.ym() - 1) / factor, My - 1),
+    nI = std::max(I1 - I0 + 1, 0),
+    nJ = std::max(J1 - J0 + 1, 0);
+
+  // partial sums for these blocks and numbers of points that are not missing
+  std::vector<double>
+    sums(nI * nJ * nlevels, 0.0),
+    counts(rule == BLOCK_AVERAGE ? sums.size() : 0, 0.0);
+
+  for (Points p(fine); p; p.next()) {
+    const int
+      i = p.i(),
+      j = p.j(),
+      I = i / factor,
+      J = j / factor,
+      ii = i % factor,
+      jj = j % factor;
+
+    if (I >= Mx or J >= My) {
+      // this point belongs to an incomplete block
+      continue;
+    }
+
+    const double *column = &input[((j - fine.ys()) * fine.xm() + (i - fine.xs())) * nlevels];
+    const size_t offset = ((J - J0) * nI + (I - I0)) * nlevels;
+    double *sum = &sums[offset];
+
+    for (unsigned int k = 0; k < nlevels; ++k) {
+      switch (rule) {
+      case BLOCK_AVERAGE:
+        if (fill_value == nullptr or column[k] != *fill_value) {
+          sum[k] += column[k];
+          counts[offset + k] += 1.0;
+        }
+        break;
+      case BLOCK_CENTER:
+        if (ii == center and jj == center) {
+          sum[k] = column[k];
+        }
+        break;
+      case BLOCK_CORNERS:
+        {
+          // corners are numbered counter-clockwise, starting from the lower left one
+          const int
+            ci = (k == 1 or k == 2) ? factor - 1 : 0,
+            cj = (k == 2 or k == 3) ? factor - 1 : 0;
+          if (ii == ci and jj == cj) {
+            sum[k] = column[k];
+          }
+        }
+        break;
+      }
+    }
+  }
+
+  // indices of coarse grid values in the natural ordering
+  std::vector<PetscInt> indices(sums.size());
+  for (int J = 0; J < nJ; ++J) {
+    for (int I = 0; I < nI; ++I) {
+      for (unsigned int k = 0; k < nlevels; ++k) {
+        size_t n = (J * nI + I) * nlevels + k;
+        indices[n] = ((J0 + J) * Mx + (I0 + I)) * nlevels + k;
+      }
+    }
+  }
+
+  auto da = coarse.get_dm(nlevels, 0);
+
+  // convert from the natural ordering to the PETSc ordering
+  AO ao;
+  ierr = DMDAGetAO(*da, &ao);
+  PISM_CHK(ierr, "DMDAGetAO");
+
+  ierr = AOApplicationToPetsc(ao, indices.size(), indices.data());
+  PISM_CHK(ierr, "AOApplicationToPetsc");
+
+  assemble(coarse, nlevels, indices, sums, output);
+
+  if (rule == BLOCK_AVERAGE) {
+    const size_t size = coarse.xm() * coarse.ym() * nlevels;
+
+    std::vector<double> n(size);
+    assemble(coarse, nlevels, indices, counts, n.data());
+
+    for (size_t k = 0; k < size; ++k) {
+      if (n[k] > 0.0) {
+        output[k] /= n[k];
+      } else {
+        // all the points in this block are missing
+        output[k] = fill_value ? *fill_value : 0.0;
+      }
+    }
+  }
+}
+
+/*!
+ * Coarsen `input` (a field with `nlevels` levels on the computational grid) and put the
+ * result in `output` (on the coarse grid).
+ *
+ * @param[in] variable metadata of the variable (used to detect latitude, longitude and
+ *                     their bounds, fill values and variables that have to be subsampled)
+ * @param[in] nlevels number of levels
+ * @param[in] input field on the computational grid, in units used in the output file
+ * @param[out] output field on the coarse grid
+ */
+void Coarsening::coarsen(const SpatialVariableMetadata &variable, unsigned int nlevels,
+                         const double *input, double *output) const {
+  const IceGrid
+    &fine   = *m_impl->fine,
+    &coarse = *m_impl->coarse;
+  const int factor = m_impl->factor;
+  const std::string variable_name = variable.get_name();
+
+  Method method = m_impl->method;
+  {
+    IO_Type type = variable.get_output_type();
+
+    auto m = m_impl->methods.find(variable_name);
+    if (m != m_impl->methods.end()) {
+      method = m->second;
+    } else if (variable.has_attribute("flag_values") or
+               variable.has_attribute("flag_meanings") or
+               type == PISM_BYTE or type == PISM_CHAR or
+               type == PISM_SHORT or type == PISM_INT) {
+      // averages of flags and integers are meaningless
+      method = SUBSAMPLE;
+    }
+  }
+
+  const Rule rule = method == AVERAGE ? BLOCK_AVERAGE : BLOCK_CENTER;
+
+  double fill_value = 0.0;
+  const double *fill = nullptr;
+  if (variable.has_attribute("_FillValue")) {
+    fill_value = variable.get_number("_FillValue");
+    fill = &fill_value;
+  }
+
+  if (member(variable_name, {"lat_bnds", "lon_bnds"}) and nlevels == 4) {
+    coarsen_field(fine, coarse, factor, BLOCK_CORNERS, nlevels, nullptr, input, output);
+  } else if (variable_name == "lon" and rule == BLOCK_AVERAGE) {
+    // average unit vectors
+    const size_t
+      fine_size   = fine.xm() * fine.ym() * nlevels,
+      coarse_size = coarse.xm() * coarse.ym() * nlevels;
+
+    std::vector<double> S(fine_size), C(fine_size), S_mean(coarse_size), C_mean(coarse_size);
+    for (size_t k = 0; k < fine_size; ++k) {
+      double lambda = input[k] * M_PI / 180.0;
+      S[k] = sin(lambda);
+      C[k] = cos(lambda);
+    }
+
+    coarsen_field(fine, coarse, factor, rule, nlevels, nullptr, S.data(), S_mean.data());
+    coarsen_field(fine, coarse, factor, rule, nlevels, nullptr, C.data(), C_mean.data());
+
+    for (size_t k = 0; k < coarse_size; ++k) {
+      output[k] = atan2(S_mean[k], C_mean[k]) * 180.0 / M_PI;
+    }
+  } else {
+    coarsen_field(fine, coarse, factor, rule, nlevels, fill, input, output);
+  }
+}
+
+Coarsening::Method string_to_coarsening_method(const std::string &method) {
+  if (method == "average") {
+    return Coarsening::AVERAGE;
+  }
+
+  if (method == "subsample") {
+    return Coarsening::SUBSAMPLE;
+  }
+
+  throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                "invalid coarsening method: %s", method.c_str());
+}
+
+} // end of namespace io
+} // end of namespace pism
@@ -0,0 +1,89 @@
+/* Copyright (C) 2020 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PISM_COARSENING_H
+#define PISM_COARSENING_H
+
+#include <string>
+
+#include "pism/util/IceGrid.hh"
+#include "pism/util/VariableMetadata.hh"
+
+namespace pism {
+namespace io {
+
+//! Coarsens spatial fields on the fly, before they are written to an output file.
+/*!
+ * The coarse grid consists of non-overlapping blocks of `factor x factor` points of the
+ * computational grid (incomplete blocks along the right and top edges of the domain are
+ * ignored). A coarse grid point is either the average of the corresponding block or its
+ * central point (`factor` odd) or the point just below and to the left of its center
+ * (`factor` even). Coordinates of the coarse grid match this choice.
+ *
+ * Coarsened fields are computed in parallel: each process adds contributions of points
+ * it owns to a distributed array on the coarse grid. The coarse grid uses a domain
+ * decomposition aligned with the one of the computational grid (if possible), so most
+ * contributions are local.
+ *
+ * Block averages skip points equal to the `_FillValue` of a variable; if all the points
+ * of a block are missing the result is missing, too. Variables with the `flag_values` or
+ * `flag_meanings` attribute and variables of integer types are always subsampled. Use
+ * set_method() to override the method used for a particular variable.
+ *
+ * Coordinates of the coarse grid correspond to the method passed to the constructor. If
+ * `factor` is even, block centers and central points of blocks differ by half a grid
+ * spacing in each direction, so variables coarsened using the other method are shifted
+ * by `dx/2` and `dy/2` relative to written coordinates (subsampled variables are
+ * shifted towards smaller x and y).
+ *
+ * Latitude and longitude are treated differently: longitudes are averaged using unit
+ * vectors (to avoid artifacts near +-180 degrees) and cell bounds (`lat_bnds` and
+ * `lon_bnds`) use corners of a block.
+ *
+ * See File::set_coarsening().
+ */
+class Coarsening {
+public:
+  enum Method {AVERAGE, SUBSAMPLE};
+
+  Coarsening(IceGrid::ConstPtr grid, unsigned int factor, Method method);
+  ~Coarsening();
+
+  IceGrid::ConstPtr grid() const;
+
+  void set_method(const std::string &variable_name, Method method);
+
+  void coarsen(const SpatialVariableMetadata &variable, unsigned int nlevels,
+               const double *input, double *output) const;
+
+  struct Impl;
+private:
+  Impl *m_impl;
+
+  // disable copying and assignments
+  Coarsening(const Coarsening &other);
+  Coarsening & operator=(const Coarsening &);
+};
+
+Coarsening::Method string_to_coarsening_method(const std::string &method);
+
+} // end of namespace io
+} // end of namespace pism
+
+#endif /* PISM_COARSENING_H */
@@ -18,6 +18,8 @@
 
 #include <cassert>
 #include <cstdio>
+#include <cstdint>              // uint64_t
+#include <algorithm>            // std::max
 #include <memory>
 using std::shared_ptr;
 
@@ -30,6 +32,7 @@ using std::shared_ptr;
 #include "pism/util/ConfigInterface.hh"
 #include "pism/util/Time.hh"
 #include "NC3File.hh"
+#include "AsyncWriter.hh"
 
 #include "pism/pism_config.hh"
 
@@ -54,6 +57,45 @@ struct File::Impl {
   MPI_Comm com;
   IO_Backend backend;
   io::NCFile::Ptr nc;
+  //! if set, distributed arrays are written by this writer after the file is closed
+  io::AsyncWriter *writer;
+  //! if set, spatial variables that did not change since the last backup are not written
+  io::BackupIndex *backup_index;
+  const io::Coarsening *coarsening;
+  //! binary checkpoint data (see File::start_binary_checkpoint())
+  struct {
+    //! true if spatial variables defined now should be stored in the binary file
+    bool defining;
+    //! -1 if not checked yet, 0 if there is no binary data, 1 otherwise
+    int present;
+    //! number of values allocated in the binary file
+    uint64_t size;
+    //! sub-domains (xs, ys, xm, ym) of all processes that wrote the binary file
+    std::vector<int> patches;
+    //! binary file handle (MPI_FILE_NULL if the binary file is not open)
+    MPI_File handle;
+  } binary;
+  //! a data write postponed until the end of the define phase
+  struct DeferredWrite {
+    std::string variable_name;
+    //! the grid (distributed arrays only; nullptr otherwise)
+    const IceGrid *grid;
+    unsigned int z_count;
+    unsigned int record;
+    //! start and count (other variables)
+    std::vector<unsigned int> start, count;
+    std::vector<double> data;
+  };
+  //! deferred definitions (see File::begin_define_batch())
+  struct {
+    //! true if a batch is open
+    bool active;
+    //! maximum number of bytes to keep in `writes`
+    size_t max_size;
+    //! number of bytes in `writes`
+    size_t size;
+    std::vector<DeferredWrite> writes;
+  } batch;
 };
 
 IO_Backend string_to_backend(const std::string &backend) {
@@ -160,8 +202,20 @@ File::File(MPI_Comm com, const std::string &filename, IO_Backend backend, IO_Mod
     m_impl->backend = backend;
   }
 
-  m_impl->com = com;
-  m_impl->nc  = create_backend(m_impl->com, m_impl->backend, iosysid);
+  m_impl->com    = com;
+  m_impl->nc     = create_backend(m_impl->com, m_impl->backend, iosysid);
+  m_impl->writer = nullptr;
+  m_impl->backup_index = nullptr;
+  m_impl->coarsening   = nullptr;
+
+  m_impl->binary.defining = false;
+  m_impl->binary.present  = -1;
+  m_impl->binary.size     = 0;
+  m_impl->binary.handle   = MPI_FILE_NULL;
+
+  m_impl->batch.active   = false;
+  m_impl->batch.max_size = 0;
+  m_impl->batch.size     = 0;
 
   this->open(filename, mode);
 }
@@ -233,7 +287,19 @@ void File::remove_attribute(const std::string &variable_name, const std::string
 
 void File::close() {
   try {
+    std::string name = filename();
+
+    commit_define_batch();
+
+    if (m_impl->binary.handle != MPI_FILE_NULL) {
+      MPI_File_close(&m_impl->binary.handle);
+    }
+
     m_impl->nc->close();
+
+    if (m_impl->writer != nullptr) {
+      m_impl->writer->submit(name);
+    }
   } catch (RuntimeError &e) {
     e.add_context("closing \"" + filename() + "\"");
     throw;
@@ -242,6 +308,8 @@ void File::close() {
 
 void File::sync() const {
   try {
+    commit_define_batch();
+
     m_impl->nc->sync();
   } catch (RuntimeError &e) {
     e.add_context("synchronizing \"" + filename() + "\"");
@@ -261,6 +329,11 @@ void File::redef() const {
 
 void File::enddef() const {
   try {
+    if (m_impl->batch.active) {
+      commit_define_batch();
+      return;
+    }
+
     m_impl->nc->enddef();
   } catch (RuntimeError &e) {
     e.add_context("switching to data mode; file \"" + filename() + "\"");
@@ -516,28 +589,37 @@ void File::define_dimension(const std::string &name, size_t length) const {
 void File::define_variable(const std::string &name, IO_Type nctype, const std::vector<std::string> &dims) const {
   try {
     m_impl->nc->def_var(name, nctype, dims);
+  } catch (RuntimeError &e) {
+    e.add_context("defining variable '%s' in '%s'", name.c_str(), filename().c_str());
+    throw;
+  }
+}
 
-    // FIXME: I need to write and tune chunk_dimensions that would be called below before we use
-    // this.
-    //
-    /*
-    // if it's not a spatial variable, we're done
-    if (dims.size() < 2) {
-      return;
-    }
-
-    std::vector<size_t> dim_lengths;
-    for (unsigned int k = 0; k < dims.size(); ++k) {
-      dim_lengths.push_back(this->dimension_length(dims[k]));
-    }
-
-    std::vector<size_t> chunk_dims = chunk_dimensions(nctype, dim_lengths);
-
-    m_impl->nc->def_var_chunking(name, chunk_dims);
-    */
+//! \brief Set chunk sizes of a variable (ignored by backends that do not support chunking).
+void File::define_variable_chunking(const std::string &name,
+                                    const std::vector<size_t> &chunk_dimensions) const {
+  try {
+    std::vector<size_t> chunks = chunk_dimensions;
+    m_impl->nc->def_var_chunking(name, chunks);
+  } catch (RuntimeError &e) {
+    e.add_context("setting chunk sizes of '%s' in '%s'", name.c_str(), filename().c_str());
+    throw;
+  }
+}
 
+//! \brief Set compression parameters of a variable (ignored by backends that do not support
+//! compression).
+/*!
+ * @param[in] name variable name
+ * @param[in] level deflate level (0 to 9; 0 disables deflate compression)
+ * @param[in] shuffle if true, use the shuffle filter
+ */
+void File::define_variable_compression(const std::string &name, int level, bool shuffle) const {
+  try {
+    m_impl->nc->def_var_compression(name, level, shuffle);
   } catch (RuntimeError &e) {
-    e.add_context("defining variable '%s' in '%s'", name.c_str(), filename().c_str());
+    e.add_context("setting compression parameters of '%s' in '%s'",
+                  name.c_str(), filename().c_str());
     throw;
   }
 }
@@ -692,6 +774,8 @@ void File::read_variable(const std::string &variable_name,
                            const std::vector<unsigned int> &count,
                           double *ip) const {
   try {
+    commit_define_batch();
+
     m_impl->nc->get_vara_double(variable_name, start, count, ip);
   } catch (RuntimeError &e) {
     e.add_context("reading variable '%s' from '%s'", variable_name.c_str(), filename().c_str());
@@ -705,6 +789,41 @@ void File::write_variable(const std::string &variable_name,
                           const std::vector<unsigned int> &count,
                           const double *op) const {
   try {
+    auto &batch = m_impl->batch;
+
+    if (batch.active) {
+      // Writes to variables that use the unlimited dimension change the number of records
+      // seen by the code that follows, so they end the batch.
+      std::string time_dimension;
+      m_impl->nc->inq_unlimdim(time_dimension);
+
+      bool time_dependent = false;
+      for (const auto &d : dimensions(variable_name)) {
+        time_dependent = time_dependent or d == time_dimension;
+      }
+
+      size_t length = 1;
+      for (auto c : count) {
+        length *= c;
+      }
+
+      if (time_dependent) {
+        commit_define_batch();
+      } else if (defer(length)) {
+        Impl::DeferredWrite w;
+        w.variable_name = variable_name;
+        w.grid          = nullptr;
+        w.z_count       = 0;
+        w.record        = 0;
+        w.start         = start;
+        w.count         = count;
+        w.data.assign(op, op + length);
+
+        batch.writes.emplace_back(std::move(w));
+        return;
+      }
+    }
+
     m_impl->nc->put_vara_double(variable_name, start, count, op);
   } catch (RuntimeError &e) {
     e.add_context("writing variable '%s' to '%s'", variable_name.c_str(), filename().c_str());
@@ -712,6 +831,35 @@ void File::write_variable(const std::string &variable_name,
   }
 }
 
+/*!
+ * Write a distributed array to the record `record` using the asynchronous writer (if
+ * set) or the I/O backend.
+ */
+static void write_array(const File &file, io::NCFile &nc, io::AsyncWriter *writer,
+                        const std::string &variable_name,
+                        const IceGrid &grid,
+                        unsigned int z_count,
+                        unsigned int record,
+                        const double *input) {
+  if (writer != nullptr) {
+    unsigned int ndims = file.dimensions(variable_name).size();
+
+    bool time_dependent = ((z_count  > 1 and ndims == 4) or
+                           (z_count == 1 and ndims == 3));
+
+    // make sure the header is written before the file is re-opened by the writer
+    nc.enddef();
+
+    bool staged = writer->write_array(file.filename(), variable_name, grid, z_count,
+                                      time_dependent, record, input);
+    if (staged) {
+      return;
+    }
+    // the staging buffer is full: write synchronously
+  }
+
+  nc.write_darray(variable_name, grid, z_count, record, input);
+}
 
 void File::write_distributed_array(const std::string &variable_name,
                                    const IceGrid &grid,
@@ -721,7 +869,24 @@ void File::write_distributed_array(const std::string &variable_name,
     unsigned int t_length = nrecords();
     assert(t_length > 0);
 
-    m_impl->nc->write_darray(variable_name, grid, z_count, t_length - 1, input);
+    size_t length = grid.xm() * grid.ym() * z_count;
+
+    // Note: the decision to defer has to be the same on all processes, so it is based on
+    // the size of the whole array.
+    if (m_impl->batch.active and defer((size_t)grid.Mx() * grid.My() * z_count)) {
+      Impl::DeferredWrite w;
+      w.variable_name = variable_name;
+      w.grid          = &grid;
+      w.z_count       = z_count;
+      w.record        = t_length - 1;
+      w.data.assign(input, input + length);
+
+      m_impl->batch.writes.emplace_back(std::move(w));
+      return;
+    }
+
+    write_array(*this, *m_impl->nc, m_impl->writer,
+                variable_name, grid, z_count, t_length - 1, input);
   } catch (RuntimeError &e) {
     e.add_context("writing distributed array '%s' to '%s'",
                   variable_name.c_str(), filename().c_str());
@@ -729,12 +894,100 @@ void File::write_distributed_array(const std::string &variable_name,
   }
 }
 
+/*!
+ * Start a batch of definitions.
+ *
+ * Until commit_define_batch() is called this file stays in the define mode: dimensions,
+ * variables and attributes are defined and modified without switching between the define
+ * and the data modes, and data written using write_variable() and
+ * write_distributed_array() are copied and written once the define phase is over.
+ *
+ * Each switch from the data mode back to the define mode may make the NetCDF library
+ * re-write the header and move all the data written so far, so batching definitions
+ * saves a lot of time when writing files containing hundreds of variables.
+ *
+ * The batch is committed early if
+ *
+ * - more than `max_size` bytes would have to be kept in memory (the size of a
+ *   distributed array is its total size, not the size of the part owned by a process),
+ * - a variable using the unlimited (time) dimension is written using write_variable(),
+ * - a variable is read,
+ * - the file is synchronized or closed.
+ */
+void File::begin_define_batch(size_t max_size) const {
+  auto &batch = m_impl->batch;
+
+  commit_define_batch();
+
+  batch.active   = true;
+  batch.max_size = max_size;
+  batch.size     = 0;
+  batch.writes.clear();
+
+  redef();
+}
+
+/*!
+ * End the define phase started by begin_define_batch() and write all the deferred data.
+ */
+void File::commit_define_batch() const {
+  auto &batch = m_impl->batch;
+
+  if (not batch.active) {
+    return;
+  }
+
+  try {
+    // do this first to make sure we don't try to commit again if something fails
+    batch.active = false;
+
+    m_impl->nc->enddef();
+
+    for (const auto &w : batch.writes) {
+      if (w.grid != nullptr) {
+        write_array(*this, *m_impl->nc, m_impl->writer,
+                    w.variable_name, *w.grid, w.z_count, w.record, w.data.data());
+      } else {
+        m_impl->nc->put_vara_double(w.variable_name, w.start, w.count, w.data.data());
+      }
+    }
+
+    batch.writes.clear();
+    batch.size = 0;
+  } catch (RuntimeError &e) {
+    batch.writes.clear();
+    batch.size = 0;
+    e.add_context("writing deferred data to '%s'", filename().c_str());
+    throw;
+  }
+}
+
+/*!
+ * Returns true if `length` more values can be stored in the current batch and updates its
+ * size. Commits the batch otherwise.
+ */
+bool File::defer(size_t length) const {
+  auto &batch = m_impl->batch;
+
+  size_t size = length * sizeof(double);
+
+  if (batch.size + size > batch.max_size) {
+    commit_define_batch();
+    return false;
+  }
+
+  batch.size += size;
+  return true;
+}
+
 
 void File::read_variable_transposed(const std::string &variable_name,
                                     const std::vector<unsigned int> &start,
                                     const std::vector<unsigned int> &count,
                                     const std::vector<unsigned int> &imap, double *ip) const {
   try {
+    commit_define_batch();
+
     m_impl->nc->get_varm_double(variable_name, start, count, imap, ip);
   } catch (RuntimeError &e) {
     e.add_context("reading variable '%s' from '%s'", variable_name.c_str(), filename().c_str());
@@ -742,6 +995,46 @@ void File::read_variable_transposed(const std::string &variable_name,
   }
 }
 
+/*!
+ * Use `writer` to write distributed arrays.
+ *
+ * Arrays are gathered and staged by write_distributed_array() and written by a background
+ * thread once this file is closed. Only the NetCDF-3 backend supports this.
+ */
+void File::set_async_writer(io::AsyncWriter *writer) {
+  if (writer != nullptr and m_impl->backend != PISM_NETCDF3) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "asynchronous output requires the netcdf3 backend (file: %s)",
+                                  filename().c_str());
+  }
+  m_impl->writer = writer;
+}
+
+/*!
+ * Use `index` to skip spatial variables that did not change since they were written to an
+ * earlier backup file (see IceModelVec::define()).
+ */
+void File::set_backup_index(io::BackupIndex *index) {
+  m_impl->backup_index = index;
+}
+
+io::BackupIndex* File::backup_index() const {
+  return m_impl->backup_index;
+}
+
+/*!
+ * Write coarsened versions of spatial variables (see io::Coarsening).
+ *
+ * Has to be called before any spatial variables are defined.
+ */
+void File::set_coarsening(const io::Coarsening *coarsening) {
+  m_impl->coarsening = coarsening;
+}
+
+const io::Coarsening* File::coarsening() const {
+  return m_impl->coarsening;
+}
+
 unsigned int File::nvariables() const {
   int n_vars = 0;
 
@@ -768,4 +1061,270 @@ std::string File::variable_name(unsigned int id) const {
 }
 
 
+
+//! Name of the file containing binary data of the NetCDF file `filename`.
+static std::string binary_filename(const std::string &filename) {
+  return filename + ".bin";
+}
+
+//! Sub-domains (xs, ys, xm, ym) of all processes in the communicator of `grid`.
+static std::vector<int> grid_patches(const IceGrid &grid) {
+  int patch[4] = {grid.xs(), grid.ys(), grid.xm(), grid.ym()};
+
+  std::vector<int> result(4 * grid.size());
+
+  MPI_Allgather(patch, 4, MPI_INT, result.data(), 4, MPI_INT, grid.com);
+
+  return result;
+}
+
+//! Offsets (in numbers of grid points) of sub-domains in a block storing one variable.
+static std::vector<uint64_t> patch_offsets(const std::vector<int> &patches) {
+  size_t N = patches.size() / 4;
+  std::vector<uint64_t> result(N + 1, 0);
+  for (size_t k = 0; k < N; ++k) {
+    result[k + 1] = result[k] + (uint64_t)patches[4 * k + 2] * patches[4 * k + 3];
+  }
+  return result;
+}
+
+static void check_mpi_io(int errcode, const char *function_name, const std::string &filename) {
+  if (errcode != MPI_SUCCESS) {
+    char message[MPI_MAX_ERROR_STRING];
+    int length = 0;
+    MPI_Error_string(errcode, message, &length);
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "%s failed for '%s': %s",
+                                  function_name, filename.c_str(), message);
+  }
+}
+
+/*!
+ * Store spatial variables defined after this call in a binary file next to this one.
+ *
+ * Each process writes its own sub-domain of each of these variables using MPI-IO, in
+ * internal units and without any re-arrangement. This NetCDF file contains all the
+ * metadata (dimensions, attributes, non-spatial variables) and serves as the manifest:
+ * the global attribute `pism_binary_patches` records the domain decomposition and the
+ * attribute `pism_binary_offset` of each variable gives its location in the binary file.
+ *
+ * Variables stored this way contain fill values in the NetCDF file, so this is meant
+ * for restart files only. Each variable can have one record.
+ *
+ * Spatial variables are read back from the binary file by read_spatial_variable() and
+ * regrid_spatial_variable() as long as the grid is the same. Reading is fastest if the
+ * domain decomposition is the same, too.
+ */
+void File::start_binary_checkpoint(const IceGrid &grid) const {
+  auto &binary = m_impl->binary;
+
+  try {
+    if (binary.handle == MPI_FILE_NULL) {
+      std::string name = binary_filename(filename());
+
+      io::move_if_exists(m_impl->com, name);
+
+      int errcode = MPI_File_open(m_impl->com, name.c_str(),
+                                  MPI_MODE_CREATE | MPI_MODE_RDWR, MPI_INFO_NULL,
+                                  &binary.handle);
+      check_mpi_io(errcode, "MPI_File_open", name);
+
+      binary.patches = grid_patches(grid);
+      binary.size    = 0;
+      binary.present = 1;
+
+      std::vector<double> patches(binary.patches.begin(), binary.patches.end());
+      write_attribute("PISM_GLOBAL", "pism_binary_patches", PISM_INT, patches);
+    }
+
+    binary.defining = true;
+  } catch (RuntimeError &e) {
+    e.add_context("starting a binary checkpoint for '%s'", filename().c_str());
+    throw;
+  }
+}
+
+/*!
+ * Store spatial variables defined after this call in this NetCDF file.
+ */
+void File::stop_binary_checkpoint() const {
+  m_impl->binary.defining = false;
+}
+
+/*!
+ * Return true if the variable `variable_name` is stored in the binary file.
+ */
+bool File::is_binary(const std::string &variable_name) const {
+  auto &binary = m_impl->binary;
+
+  try {
+    if (binary.present < 0) {
+      binary.present = attribute_type("PISM_GLOBAL", "pism_binary_patches") != PISM_NAT;
+
+      if (binary.present) {
+        auto patches = read_double_attribute("PISM_GLOBAL", "pism_binary_patches");
+        binary.patches.assign(patches.begin(), patches.end());
+      }
+    }
+
+    return (binary.present == 1 and
+            find_variable(variable_name) and
+            attribute_type(variable_name, "pism_binary_offset") != PISM_NAT);
+  } catch (RuntimeError &e) {
+    e.add_context("checking if '%s' is stored in '%s'",
+                  variable_name.c_str(), binary_filename(filename()).c_str());
+    throw;
+  }
+}
+
+/*!
+ * Allocate space for a variable with `z_count` levels in the binary file.
+ *
+ * Does nothing unless called between start_binary_checkpoint() and
+ * stop_binary_checkpoint().
+ */
+void File::define_binary_array(const std::string &variable_name, unsigned int z_count) const {
+  auto &binary = m_impl->binary;
+
+  if (not binary.defining) {
+    return;
+  }
+
+  try {
+    write_attribute(variable_name, "pism_binary_offset", PISM_DOUBLE, {(double)binary.size});
+
+    binary.size += z_count * patch_offsets(binary.patches).back();
+  } catch (RuntimeError &e) {
+    e.add_context("defining '%s' in '%s'",
+                  variable_name.c_str(), binary_filename(filename()).c_str());
+    throw;
+  }
+}
+
+void File::write_binary_array(const std::string &variable_name, const IceGrid &grid,
+                              unsigned int z_count, const double *input) const {
+  auto &binary = m_impl->binary;
+  std::string name = binary_filename(filename());
+
+  try {
+    if (binary.handle == MPI_FILE_NULL) {
+      throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                    "'%s' is not open for writing", name.c_str());
+    }
+
+    if (grid_patches(grid) != binary.patches) {
+      throw RuntimeError(PISM_ERROR_LOCATION,
+                         "the domain decomposition changed after the binary checkpoint was started");
+    }
+
+    double offset = read_double_attribute(variable_name, "pism_binary_offset")[0];
+
+    uint64_t start = (uint64_t)offset + z_count * patch_offsets(binary.patches)[grid.rank()];
+    int count = grid.xm() * grid.ym() * z_count;
+
+    int errcode = MPI_File_write_at_all(binary.handle, start * sizeof(double),
+                                        const_cast<double*>(input), count, MPI_DOUBLE,
+                                        MPI_STATUS_IGNORE);
+    check_mpi_io(errcode, "MPI_File_write_at_all", name);
+  } catch (RuntimeError &e) {
+    e.add_context("writing '%s' to '%s'", variable_name.c_str(), name.c_str());
+    throw;
+  }
+}
+
+/*!
+ * Read the variable `variable_name` from the binary file.
+ *
+ * The grid has to be the same as the one used to write this file. If the domain
+ * decomposition is different each process reads parts of its sub-domain from the
+ * sub-domains of processes that wrote the file.
+ */
+void File::read_binary_array(const std::string &variable_name, const IceGrid &grid,
+                             unsigned int z_count, double *output) const {
+  auto &binary = m_impl->binary;
+  std::string name = binary_filename(filename());
+
+  try {
+    if (not is_binary(variable_name)) {
+      throw RuntimeError::formatted(PISM_ERROR_LOCATION, "'%s' is not in '%s'",
+                                    variable_name.c_str(), name.c_str());
+    }
+
+    int Mx = 0, My = 0;
+    for (size_t k = 0; k < binary.patches.size(); k += 4) {
+      Mx = std::max(Mx, binary.patches[k + 0] + binary.patches[k + 2]);
+      My = std::max(My, binary.patches[k + 1] + binary.patches[k + 3]);
+    }
+
+    if (Mx != (int)grid.Mx() or My != (int)grid.My()) {
+      throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                    "grid size mismatch: stored %dx%d, expected %dx%d",
+                                    Mx, My, grid.Mx(), grid.My());
+    }
+
+    if (binary.handle == MPI_FILE_NULL) {
+      int errcode = MPI_File_open(m_impl->com, name.c_str(), MPI_MODE_RDONLY,
+                                  MPI_INFO_NULL, &binary.handle);
+      check_mpi_io(errcode, "MPI_File_open", name);
+    }
+
+    uint64_t offset = read_double_attribute(variable_name, "pism_binary_offset")[0];
+    std::vector<uint64_t> offsets = patch_offsets(binary.patches);
+
+    if (grid_patches(grid) == binary.patches) {
+      // same decomposition: read the whole sub-domain at once
+      uint64_t start = offset + z_count * offsets[grid.rank()];
+      int count = grid.xm() * grid.ym() * z_count;
+
+      int errcode = MPI_File_read_at_all(binary.handle, start * sizeof(double),
+                                         output, count, MPI_DOUBLE, MPI_STATUS_IGNORE);
+      check_mpi_io(errcode, "MPI_File_read_at_all", name);
+    } else {
+      // different decomposition: read rows of all overlapping sub-domains
+      const int
+        xs = grid.xs(),
+        ys = grid.ys(),
+        xm = grid.xm(),
+        ym = grid.ym();
+
+      ParallelSection loop(m_impl->com);
+      try {
+        for (size_t p = 0; p < binary.patches.size() / 4; ++p) {
+          const int
+            pxs = binary.patches[4 * p + 0],
+            pys = binary.patches[4 * p + 1],
+            pxm = binary.patches[4 * p + 2],
+            pym = binary.patches[4 * p + 3];
+
+          const int
+            i0 = std::max(xs, pxs),
+            i1 = std::min(xs + xm, pxs + pxm),
+            j0 = std::max(ys, pys),
+            j1 = std::min(ys + ym, pys + pym);
+
+          if (i0 >= i1 or j0 >= j1) {
+            continue;
+          }
+
+          for (int j = j0; j < j1; ++j) {
+            uint64_t start = (offset + z_count * offsets[p] +
+                              ((uint64_t)(j - pys) * pxm + (i0 - pxs)) * z_count);
+            int count = (i1 - i0) * z_count;
+            double *row = output + ((size_t)(j - ys) * xm + (i0 - xs)) * z_count;
+
+            int errcode = MPI_File_read_at(binary.handle, start * sizeof(double),
+                                           row, count, MPI_DOUBLE, MPI_STATUS_IGNORE);
+            check_mpi_io(errcode, "MPI_File_read_at", name);
+          }
+        }
+      } catch (...) {
+        loop.failed();
+      }
+      loop.check();
+    }
+  } catch (RuntimeError &e) {
+    e.add_context("reading '%s' from '%s'", variable_name.c_str(), name.c_str());
+    throw;
+  }
+}
+
 } // end of namespace pism
@@ -32,6 +32,12 @@ enum AxisType {X_AXIS, Y_AXIS, Z_AXIS, T_AXIS, UNKNOWN_AXIS};
 
 class IceGrid;
 
+namespace io {
+class AsyncWriter;
+class BackupIndex;
+class Coarsening;
+}
+
 /*!
  * Convert a string to PISM's backend type.
  */
@@ -66,6 +72,10 @@ public:
 
   void sync() const;
 
+  void begin_define_batch(size_t max_size) const;
+
+  void commit_define_batch() const;
+
   std::string filename() const;
 
   unsigned int nrecords() const;
@@ -99,6 +109,11 @@ public:
   void define_variable(const std::string &name, IO_Type nctype,
                        const std::vector<std::string> &dims) const;
 
+  void define_variable_chunking(const std::string &name,
+                                const std::vector<size_t> &chunk_dimensions) const;
+
+  void define_variable_compression(const std::string &name, int level, bool shuffle) const;
+
   VariableLookupData find_variable(const std::string &short_name, const std::string &std_name) const;
 
   bool find_variable(const std::string &short_name) const;
@@ -143,12 +158,40 @@ public:
   std::string read_text_attribute(const std::string &var_name, const std::string &att_name) const;
 
   void append_history(const std::string &history) const;
+
+  void set_async_writer(io::AsyncWriter *writer);
+
+  void set_backup_index(io::BackupIndex *index);
+
+  io::BackupIndex* backup_index() const;
+
+  void set_coarsening(const io::Coarsening *coarsening);
+
+  const io::Coarsening* coarsening() const;
+
+  // binary checkpoints
+
+  void start_binary_checkpoint(const IceGrid &grid) const;
+
+  void stop_binary_checkpoint() const;
+
+  bool is_binary(const std::string &variable_name) const;
+
+  void define_binary_array(const std::string &variable_name, unsigned int z_count) const;
+
+  void write_binary_array(const std::string &variable_name, const IceGrid &grid,
+                          unsigned int z_count, const double *input) const;
+
+  void read_binary_array(const std::string &variable_name, const IceGrid &grid,
+                         unsigned int z_count, double *output) const;
 private:
   struct Impl;
   Impl *m_impl;
 
   void open(const std::string &filename, IO_Mode mode);
 
+  bool defer(size_t length) const;
+
   // disable copying and assignments
   File(const File &other);
   File & operator=(const File &);
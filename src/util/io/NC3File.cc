@@ -26,9 +26,11 @@
 #include <netcdf.h>
 #include <cstring>              // memset
 #include <cstdio>               // stderr, fprintf
+#include <algorithm>            // std::min, std::max
 
 #include "pism/util/pism_utilities.hh" // join
 #include "pism/util/error_handling.hh"
+#include "pism/util/IceGrid.hh"
 
 #include "pism_type_conversion.hh" // This has to be included *after* netcdf.h.
 
@@ -58,6 +60,7 @@ NC3File::NC3File(MPI_Comm c)
 NC3File::~NC3File() {
   if (m_file_id >= 0) {
     if (m_rank == 0) {
+      std::lock_guard<std::recursive_mutex> lock(library_mutex());
       nc_close(m_file_id);
       fprintf(stderr, "NC3File::~NC3File: NetCDF file %s is still open\n",
               m_filename.c_str());
@@ -474,6 +477,157 @@ void NC3File::put_vara_double_impl(const std::string &variable_name,
   }
 }
 
+/*!
+ * Write a distributed array using two-phase aggregation.
+ *
+ * In the first phase sub-domains of processes in each aggregation group (see
+ * IceGrid::io_aggregation()) are gathered onto the group's aggregator, which assembles a
+ * contiguous block of grid rows. In the second phase aggregators send their blocks to
+ * processor 0, which writes each block using one nc_put_vara_double() call, receiving the
+ * next block while writing the current one.
+ */
+void NC3File::write_darray_impl(const std::string &variable_name,
+                                const IceGrid &grid,
+                                unsigned int z_count,
+                                unsigned int record,
+                                const double *input) {
+  const int data_tag = 5;
+
+  std::vector<std::string> dims;
+  this->inq_vardimid(variable_name, dims);
+
+  const unsigned int ndims = dims.size();
+
+  const bool time_dependent = ((z_count  > 1 and ndims == 4) or
+                               (z_count == 1 and ndims == 3));
+
+  const IceGrid::IOAggregation &aggregation = grid.io_aggregation();
+
+  int group_rank = 0, group_size = 1;
+  MPI_Comm_rank(aggregation.group, &group_rank);
+  MPI_Comm_size(aggregation.group, &group_size);
+
+  const int
+    Mx         = grid.Mx(),
+    local_size = grid.xm() * grid.ym() * z_count;
+
+  // Phase 1: gather sub-domains onto aggregators.
+  const int patch[4] = {grid.xs(), grid.ys(), grid.xm(), grid.ym()};
+  std::vector<int> patches(group_rank == 0 ? 4 * group_size : 0);
+  MPI_Gather(patch, 4, MPI_INT, patches.data(), 4, MPI_INT, 0, aggregation.group);
+
+  // the first row and the number of rows in the block of this group (set on aggregators)
+  int block[2] = {0, 0};
+  std::vector<int> counts, displacements;
+  std::vector<double> buffer;
+  if (group_rank == 0) {
+    counts.resize(group_size);
+    displacements.resize(group_size);
+
+    int total = 0, y_start = grid.My(), y_end = 0;
+    for (int r = 0; r < group_size; ++r) {
+      const int ys = patches[4 * r + 1], xm = patches[4 * r + 2], ym = patches[4 * r + 3];
+
+      counts[r]        = xm * ym * z_count;
+      displacements[r] = total;
+      total += counts[r];
+
+      y_start = std::min(y_start, ys);
+      y_end   = std::max(y_end, ys + ym);
+    }
+    buffer.resize(total);
+
+    block[0] = y_start;
+    block[1] = y_end - y_start;
+  }
+
+  MPI_Gatherv(const_cast<double*>(input), local_size, MPI_DOUBLE,
+              buffer.data(), counts.data(), displacements.data(), MPI_DOUBLE,
+              0, aggregation.group);
+
+  // rows of the block of this group, in the order used in the file (y, x, z)
+  std::vector<double> rows;
+  if (group_rank == 0) {
+    rows.resize((size_t)block[1] * Mx * z_count);
+
+    for (int r = 0; r < group_size; ++r) {
+      const int
+        xs = patches[4 * r + 0],
+        ys = patches[4 * r + 1],
+        xm = patches[4 * r + 2],
+        ym = patches[4 * r + 3];
+
+      const double *patch_data = &buffer[displacements[r]];
+
+      for (int j = 0; j < ym; ++j) {
+        for (int i = 0; i < xm; ++i) {
+          const double *column = patch_data + ((size_t)j * xm + i) * z_count;
+          double *result = &rows[((size_t)(ys - block[0] + j) * Mx + (xs + i)) * z_count];
+          for (unsigned int k = 0; k < z_count; ++k) {
+            result[k] = column[k];
+          }
+        }
+      }
+    }
+  }
+
+  // Phase 2: send blocks to processor 0 and write them.
+  int com_size = 1;
+  MPI_Comm_size(m_com, &com_size);
+
+  std::vector<int> blocks(m_rank == 0 ? 2 * com_size : 0);
+  MPI_Gather(block, 2, MPI_INT, blocks.data(), 2, MPI_INT, 0, m_com);
+
+  if (m_rank == 0) {
+    const std::vector<int> &aggregators = aggregation.aggregators;
+    const int n_blocks = aggregators.size();
+
+    int varid = 0;
+    int stat = nc_inq_varid(m_file_id, variable_name.c_str(), &varid);
+    check_and_abort(m_com, PISM_ERROR_LOCATION, stat);
+
+    std::vector<double> next;
+    for (int b = 0; b < n_blocks; ++b) {
+      // start receiving the next block
+      MPI_Request request = MPI_REQUEST_NULL;
+      if (b + 1 < n_blocks) {
+        const int source = aggregators[b + 1];
+        next.resize((size_t)blocks[2 * source + 1] * Mx * z_count);
+        MPI_Irecv(next.data(), next.size(), MPI_DOUBLE, source, data_tag, m_com, &request);
+      }
+
+      // write the current block
+      const int aggregator = aggregators[b];
+
+      std::vector<size_t> start, count;
+      // time
+      if (time_dependent) {
+        start.push_back(record);
+        count.push_back(1);
+      }
+      // y
+      start.push_back(blocks[2 * aggregator + 0]);
+      count.push_back(blocks[2 * aggregator + 1]);
+      // x
+      start.push_back(0);
+      count.push_back(Mx);
+      // z (these are not used when writing 2D fields)
+      start.push_back(0);
+      count.push_back(z_count);
+
+      stat = nc_put_vara_double(m_file_id, varid, start.data(), count.data(), rows.data());
+      check_and_abort(m_com, PISM_ERROR_LOCATION, stat);
+
+      if (b + 1 < n_blocks) {
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+        rows.swap(next);
+      }
+    }
+  } else if (group_rank == 0) {
+    MPI_Send(rows.data(), rows.size(), MPI_DOUBLE, 0, data_tag, m_com);
+  }
+}
+
 //! \brief Get the number of variables.
 void NC3File::inq_nvars_impl(int &result) const {
   int stat = NC_NOERR;
@@ -878,6 +1032,7 @@ std::string NC3File::get_format() const {
   int format;
 
   if (m_rank == 0) {
+    std::lock_guard<std::recursive_mutex> lock(library_mutex());
     int stat = nc_inq_format(m_file_id, &format); check(PISM_ERROR_LOCATION, stat);
   }
   MPI_Barrier(m_com);
@@ -156,6 +156,16 @@ void NC4File::def_var_chunking_impl(const std::string &name,
   check(PISM_ERROR_LOCATION, stat);
 }
 
+void NC4File::def_var_compression_impl(const std::string &name, int level, bool shuffle) const {
+  int stat = 0, varid = 0;
+
+  stat = nc_inq_varid(m_file_id, name.c_str(), &varid);
+  check(PISM_ERROR_LOCATION, stat);
+
+  stat = nc_def_var_deflate(m_file_id, varid, shuffle ? 1 : 0, level > 0 ? 1 : 0, level);
+  check(PISM_ERROR_LOCATION, stat);
+}
+
 void NC4File::get_varm_double_impl(const std::string &variable_name,
                                   const std::vector<unsigned int> &start,
                                   const std::vector<unsigned int> &count,
@@ -56,6 +56,8 @@ protected:
   virtual void def_var_chunking_impl(const std::string &name,
                                     std::vector<size_t> &dimensions) const;
 
+  virtual void def_var_compression_impl(const std::string &name, int level, bool shuffle) const;
+
   virtual void def_var_impl(const std::string &name,
                            IO_Type nctype, const std::vector<std::string> &dims) const;
 
@@ -41,6 +41,18 @@ NCFile::~NCFile() {
   // empty
 }
 
+/*!
+ * Mutex serializing calls to the NetCDF library.
+ *
+ * The NetCDF library is not thread-safe. All calls made through an NCFile instance hold
+ * this (recursive) lock, so that files written by a background thread (see AsyncWriter)
+ * can be accessed while other files are being read or written by the main thread.
+ */
+std::recursive_mutex& NCFile::library_mutex() {
+  static std::recursive_mutex mutex;
+  return mutex;
+}
+
 std::string NCFile::filename() const {
   return m_filename;
 }
@@ -52,31 +64,43 @@ void NCFile::def_var_chunking_impl(const std::string &name,
   // the default implementation does nothing
 }
 
+void NCFile::def_var_compression_impl(const std::string &name, int level, bool shuffle) const {
+  (void) name;
+  (void) level;
+  (void) shuffle;
+  // the default implementation does nothing
+}
+
 
 void NCFile::open(const std::string &filename, IO_Mode mode) {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->open_impl(filename, mode);
   m_filename = filename;
   m_define_mode = false;
 }
 
 void NCFile::create(const std::string &filename) {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->create_impl(filename);
   m_filename = filename;
   m_define_mode = true;
 }
 
 void NCFile::sync() const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   enddef();
   this->sync_impl();
 }
 
 void NCFile::close() {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->close_impl();
   m_filename.clear();
   m_file_id = -1;
 }
 
 void NCFile::enddef() const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   if (m_define_mode) {
     this->enddef_impl();
     m_define_mode = false;
@@ -84,6 +108,7 @@ void NCFile::enddef() const {
 }
 
 void NCFile::redef() const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   if (not m_define_mode) {
     this->redef_impl();
     m_define_mode = true;
@@ -91,38 +116,51 @@ void NCFile::redef() const {
 }
 
 void NCFile::def_dim(const std::string &name, size_t length) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   redef();
   this->def_dim_impl(name, length);
 }
 
 void NCFile::inq_dimid(const std::string &dimension_name, bool &exists) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->inq_dimid_impl(dimension_name,exists);
 }
 
 void NCFile::inq_dimlen(const std::string &dimension_name, unsigned int &result) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->inq_dimlen_impl(dimension_name,result);
 }
 
 void NCFile::inq_unlimdim(std::string &result) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->inq_unlimdim_impl(result);
 }
 
 void NCFile::def_var(const std::string &name, IO_Type nctype,
                     const std::vector<std::string> &dims) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   redef();
   this->def_var_impl(name, nctype, dims);
 }
 
 void NCFile::def_var_chunking(const std::string &name,
                               std::vector<size_t> &dimensions) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->def_var_chunking_impl(name, dimensions);
 }
 
+void NCFile::def_var_compression(const std::string &name, int level, bool shuffle) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
+  redef();
+  this->def_var_compression_impl(name, level, shuffle);
+}
+
 
 void NCFile::get_vara_double(const std::string &variable_name,
                             const std::vector<unsigned int> &start,
                             const std::vector<unsigned int> &count,
                             double *ip) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
 #if (Pism_DEBUG==1)
   if (start.size() != count.size()) {
     throw RuntimeError::formatted(PISM_ERROR_LOCATION,
@@ -138,6 +176,7 @@ void NCFile::put_vara_double(const std::string &variable_name,
                             const std::vector<unsigned int> &start,
                             const std::vector<unsigned int> &count,
                             const double *op) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
 #if (Pism_DEBUG==1)
   if (start.size() != count.size()) {
     throw RuntimeError::formatted(PISM_ERROR_LOCATION,
@@ -155,6 +194,7 @@ void NCFile::write_darray(const std::string &variable_name,
                           unsigned int z_count,
                           unsigned int record,
                           const double *input) {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   enddef();
   this->write_darray_impl(variable_name, grid, z_count, record, input);
 }
@@ -204,6 +244,7 @@ void NCFile::get_varm_double(const std::string &variable_name,
                             const std::vector<unsigned int> &count,
                             const std::vector<unsigned int> &imap,
                             double *ip) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
 
 #if (Pism_DEBUG==1)
   if (start.size() != count.size() or
@@ -218,34 +259,41 @@ void NCFile::get_varm_double(const std::string &variable_name,
 }
 
 void NCFile::inq_nvars(int &result) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->inq_nvars_impl(result);
 }
 
 void NCFile::inq_vardimid(const std::string &variable_name, std::vector<std::string> &result) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->inq_vardimid_impl(variable_name, result);
 }
 
 void NCFile::inq_varnatts(const std::string &variable_name, int &result) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->inq_varnatts_impl(variable_name, result);
 }
 
 void NCFile::inq_varid(const std::string &variable_name, bool &result) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->inq_varid_impl(variable_name, result);
 }
 
 void NCFile::inq_varname(unsigned int j, std::string &result) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->inq_varname_impl(j, result);
 }
 
 void NCFile::get_att_double(const std::string &variable_name,
                             const std::string &att_name,
                             std::vector<double> &result) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->get_att_double_impl(variable_name, att_name, result);
 }
 
 void NCFile::get_att_text(const std::string &variable_name,
                           const std::string &att_name,
                           std::string &result) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->get_att_text_impl(variable_name, att_name, result);
 }
 
@@ -253,33 +301,39 @@ void NCFile::put_att_double(const std::string &variable_name,
                             const std::string &att_name,
                             IO_Type xtype,
                             const std::vector<double> &data) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->put_att_double_impl(variable_name, att_name, xtype, data);
 }
 
 void NCFile::put_att_text(const std::string &variable_name,
                           const std::string &att_name,
                           const std::string &value) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->put_att_text_impl(variable_name, att_name, value);
 }
 
 void NCFile::inq_attname(const std::string &variable_name,
                          unsigned int n,
                          std::string &result) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->inq_attname_impl(variable_name, n, result);
 }
 
 void NCFile::inq_atttype(const std::string &variable_name,
                          const std::string &att_name,
                          IO_Type &result) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->inq_atttype_impl(variable_name, att_name, result);
 }
 
 void NCFile::set_fill(int fillmode, int &old_modep) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   redef();
   this->set_fill_impl(fillmode, old_modep);
 }
 
 void NCFile::del_att(const std::string &variable_name, const std::string &att_name) const {
+  std::lock_guard<std::recursive_mutex> lock(library_mutex());
   this->del_att_impl(variable_name, att_name);
 }
 
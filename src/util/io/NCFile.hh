@@ -20,6 +20,7 @@
 #define _PISMNCWRAPPER_H_
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -90,6 +91,8 @@ public:
 
   void def_var_chunking(const std::string &name, std::vector<size_t> &dimensions) const;
 
+  void def_var_compression(const std::string &name, int level, bool shuffle) const;
+
   void get_vara_double(const std::string &variable_name,
                        const std::vector<unsigned int> &start,
                        const std::vector<unsigned int> &count,
@@ -146,6 +149,7 @@ public:
 
   void del_att(const std::string &variable_name, const std::string &att_name) const;
 
+  static std::recursive_mutex& library_mutex();
 protected:
   // implementations:
 
@@ -176,6 +180,8 @@ protected:
   virtual void def_var_chunking_impl(const std::string &name,
                                     std::vector<size_t> &dimensions) const;
 
+  virtual void def_var_compression_impl(const std::string &name, int level, bool shuffle) const;
+
   virtual void get_vara_double_impl(const std::string &variable_name,
                                    const std::vector<unsigned int> &start,
                                    const std::vector<unsigned int> &count,
@@ -185,9 +185,34 @@ void ParallelIO::def_var_impl(const std::string &name, IO_Type nctype,
 
 void ParallelIO::def_var_chunking_impl(const std::string &name,
                                       std::vector<size_t> &dimensions) const {
-  (void) name;
-  (void) dimensions;
-  // FIXME
+  // chunking is supported by NetCDF-4 I/O types only
+  if (not (m_iotype == PIO_IOTYPE_NETCDF4C or m_iotype == PIO_IOTYPE_NETCDF4P)) {
+    return;
+  }
+
+  int varid = -1;
+  int stat = PIOc_inq_varid(m_file_id, name.c_str(), &varid);
+  check(PISM_ERROR_LOCATION, stat);
+
+  std::vector<PIO_Offset> chunks(dimensions.begin(), dimensions.end());
+
+  stat = PIOc_def_var_chunking(m_file_id, varid, NC_CHUNKED, chunks.data());
+  check(PISM_ERROR_LOCATION, stat);
+}
+
+void ParallelIO::def_var_compression_impl(const std::string &name, int level,
+                                          bool shuffle) const {
+  // compression is supported by NetCDF-4 I/O types only
+  if (not (m_iotype == PIO_IOTYPE_NETCDF4C or m_iotype == PIO_IOTYPE_NETCDF4P)) {
+    return;
+  }
+
+  int varid = -1;
+  int stat = PIOc_inq_varid(m_file_id, name.c_str(), &varid);
+  check(PISM_ERROR_LOCATION, stat);
+
+  stat = PIOc_def_var_deflate(m_file_id, varid, shuffle ? 1 : 0, level > 0 ? 1 : 0, level);
+  check(PISM_ERROR_LOCATION, stat);
 }
 
 void ParallelIO::get_vara_double_impl(const std::string &variable_name,
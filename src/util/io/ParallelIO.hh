@@ -57,6 +57,8 @@ protected:
   void def_var_chunking_impl(const std::string &name,
                             std::vector<size_t> &dimensions) const;
 
+  void def_var_compression_impl(const std::string &name, int level, bool shuffle) const;
+
   void get_vara_double_impl(const std::string &variable_name,
                            const std::vector<unsigned int> &start,
                            const std::vector<unsigned int> &count,
@@ -0,0 +1,339 @@
+/* Copyright (C) 2020 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <algorithm>            // std::min
+#include <cstring>              // memcpy
+#include <stdexcept>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Prefetcher.hh"
+#include "NCFile.hh"
+#include "pism/util/error_handling.hh"
+#include "pism/util/pism_utilities.hh"
+
+// The following is a stupid kludge necessary to make NetCDF 4.x work in
+// serial mode in an MPI program:
+#ifndef MPI_INCLUDED
+#define MPI_INCLUDED 1
+#endif
+#include <netcdf.h>
+
+namespace pism {
+namespace io {
+
+namespace {
+
+//! A block of records read (or being read) by the background thread.
+struct Block {
+  std::string filename;
+  std::string variable_name;
+  unsigned int t_start, t_count;
+  //! the x-y window read from the file (x_count == 0 means "the whole domain")
+  unsigned int x_start, x_count, y_start, y_count;
+  //! data in the (t, y, x) storage order
+  std::vector<double> data;
+  //! error message (empty on success)
+  std::string error;
+};
+
+} // end of anonymous namespace
+
+struct Prefetcher::Impl {
+  MPI_Comm com;
+  int rank;
+  int size;
+
+  // Members below are used on rank 0 only.
+
+  //! true if `block` contains (or will contain) requested records
+  bool valid;
+  Block block;
+  std::thread thread;
+  //! sub-domains (x_start, x_count, y_start, y_count) of all processes in the last read()
+  std::vector<unsigned int> patches;
+};
+
+static void check(int stat) {
+  if (stat != NC_NOERR) {
+    throw std::runtime_error(nc_strerror(stat));
+  }
+}
+
+//! Read records described by `block` (runs in the background thread).
+/*!
+ * Holds NCFile::library_mutex() while reading one record at a time so that the main
+ * thread does not have to wait for the whole block if it needs the NetCDF library.
+ */
+static void read_block(Block *block) {
+  std::recursive_mutex &library = NCFile::library_mutex();
+
+  int file_id = -1;
+  int stat = NC_NOERR;
+  {
+    std::lock_guard<std::recursive_mutex> lock(library);
+    stat = nc_open(block->filename.c_str(), NC_NOWRITE, &file_id);
+  }
+  if (stat != NC_NOERR) {
+    block->error = "failed to open " + block->filename + ": " + nc_strerror(stat);
+    return;
+  }
+
+  try {
+    int variable_id = -1;
+    {
+      std::lock_guard<std::recursive_mutex> lock(library);
+
+      int ndims = 0;
+      check(nc_inq_varid(file_id, block->variable_name.c_str(), &variable_id));
+      check(nc_inq_varndims(file_id, variable_id, &ndims));
+      if (ndims != 3) {
+        throw std::runtime_error("expected a variable with dimensions (time, y, x)");
+      }
+
+      int dimids[3];
+      size_t length[3];
+      check(nc_inq_vardimid(file_id, variable_id, dimids));
+      for (int k = 0; k < 3; ++k) {
+        check(nc_inq_dimlen(file_id, dimids[k], &length[k]));
+      }
+
+      if (block->t_start >= length[0]) {
+        throw std::runtime_error("invalid record index");
+      }
+      // don't read past the last record
+      block->t_count = std::min((size_t)block->t_count, length[0] - block->t_start);
+
+      if (block->x_count == 0) {
+        block->x_start = 0;
+        block->x_count = length[2];
+        block->y_start = 0;
+        block->y_count = length[1];
+      }
+
+      if (block->x_start + block->x_count > length[2] or
+          block->y_start + block->y_count > length[1]) {
+        throw std::runtime_error("invalid x-y window");
+      }
+    }
+
+    const size_t record_size = (size_t)block->x_count * block->y_count;
+    block->data.resize(block->t_count * record_size);
+
+    for (unsigned int k = 0; k < block->t_count; ++k) {
+      size_t
+        start[] = {block->t_start + k, block->y_start, block->x_start},
+        count[] = {1, block->y_count, block->x_count};
+
+      std::lock_guard<std::recursive_mutex> lock(library);
+      check(nc_get_vara_double(file_id, variable_id, start, count,
+                               &block->data[k * record_size]));
+    }
+  } catch (std::exception &e) {
+    block->error = "failed to read " + block->variable_name + " from " + block->filename +
+      ": " + e.what();
+    block->data.clear();
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(library);
+  nc_close(file_id);
+}
+
+Prefetcher::Prefetcher(MPI_Comm com)
+  : m_impl(new Impl) {
+  if (not supported()) {
+    delete m_impl;
+    throw RuntimeError(PISM_ERROR_LOCATION,
+                       "prefetching forcing data requires MPI_THREAD_FUNNELED or higher");
+  }
+
+  m_impl->com   = com;
+  m_impl->valid = false;
+
+  MPI_Comm_rank(com, &m_impl->rank);
+  MPI_Comm_size(com, &m_impl->size);
+}
+
+Prefetcher::~Prefetcher() {
+  if (m_impl->thread.joinable()) {
+    m_impl->thread.join();
+  }
+  delete m_impl;
+}
+
+/*!
+ * Returns true if the MPI library supports the thread level needed by this class.
+ *
+ * The background thread does not make MPI calls, so it is enough to have
+ * `MPI_THREAD_FUNNELED`.
+ */
+bool Prefetcher::supported() {
+  return mpi_thread_funneled();
+}
+
+/*!
+ * Start reading records `[t_start, t_start + t_count)` of `variable_name` in `filename`.
+ *
+ * The variable has to use the storage order (time, y, x). Records past the end of the
+ * file are ignored. Only the smallest x-y window containing sub-domains of all processes
+ * in the last call to read() is read (the whole domain if read() was not called yet).
+ *
+ * Should be called on all ranks, but only rank 0 does any work. Previously requested
+ * records are discarded.
+ */
+void Prefetcher::request(const std::string &filename, const std::string &variable_name,
+                         unsigned int t_start, unsigned int t_count) {
+  if (m_impl->rank != 0) {
+    return;
+  }
+
+  if (m_impl->thread.joinable()) {
+    m_impl->thread.join();
+  }
+
+  Block &block = m_impl->block;
+  block.filename      = filename;
+  block.variable_name = variable_name;
+  block.t_start       = t_start;
+  block.t_count       = t_count;
+  block.x_start       = 0;
+  block.x_count       = 0;
+  block.y_start       = 0;
+  block.y_count       = 0;
+  block.error.clear();
+
+  const auto &patches = m_impl->patches;
+  if (not patches.empty()) {
+    unsigned int
+      x_start = patches[0],
+      x_end   = patches[0] + patches[1],
+      y_start = patches[2],
+      y_end   = patches[2] + patches[3];
+
+    for (size_t k = 4; k < patches.size(); k += 4) {
+      x_start = std::min(x_start, patches[k + 0]);
+      x_end   = std::max(x_end, patches[k + 0] + patches[k + 1]);
+      y_start = std::min(y_start, patches[k + 2]);
+      y_end   = std::max(y_end, patches[k + 2] + patches[k + 3]);
+    }
+
+    block.x_start = x_start;
+    block.x_count = x_end - x_start;
+    block.y_start = y_start;
+    block.y_count = y_end - y_start;
+  }
+
+  m_impl->valid = true;
+  m_impl->thread = std::thread(read_block, &block);
+}
+
+/*!
+ * Get records `[t_start, t_start + t_count)` of `variable_name` in `filename` in the
+ * sub-domain `[x_start, x_start + x_count) x [y_start, y_start + y_count)` of the grid
+ * used in this file.
+ *
+ * Returns false if these records were not requested (or could not be read). Otherwise
+ * waits for the background thread (if necessary), puts records in `output` (using the
+ * storage order (t, y, x)) and returns true.
+ *
+ * Sub-domains passed to this call determine the window read by the next request().
+ *
+ * This is a collective operation.
+ */
+bool Prefetcher::read(const std::string &filename, const std::string &variable_name,
+                      unsigned int t_start, unsigned int t_count,
+                      unsigned int x_start, unsigned int x_count,
+                      unsigned int y_start, unsigned int y_count,
+                      double *output) {
+  const Block &block = m_impl->block;
+  const bool rank0 = m_impl->rank == 0;
+
+  unsigned int patch[] = {x_start, x_count, y_start, y_count};
+
+  std::vector<unsigned int> patches(rank0 ? 4 * m_impl->size : 0);
+  MPI_Gather(patch, 4, MPI_UNSIGNED, patches.data(), 4, MPI_UNSIGNED, 0, m_impl->com);
+
+  int available = 0;
+  if (rank0) {
+    if (m_impl->thread.joinable()) {
+      m_impl->thread.join();
+    }
+
+    available = (m_impl->valid and
+                 block.error.empty() and
+                 block.filename == filename and
+                 block.variable_name == variable_name and
+                 t_start >= block.t_start and
+                 t_start + t_count <= block.t_start + block.t_count) ? 1 : 0;
+
+    for (int r = 0; available and r < m_impl->size; ++r) {
+      const unsigned int *p = &patches[4 * r];
+      available = (p[0] >= block.x_start and p[0] + p[1] <= block.x_start + block.x_count and
+                   p[2] >= block.y_start and p[2] + p[3] <= block.y_start + block.y_count) ? 1 : 0;
+    }
+
+    m_impl->patches = patches;
+  }
+  MPI_Bcast(&available, 1, MPI_INT, 0, m_impl->com);
+
+  if (available == 0) {
+    return false;
+  }
+
+  std::vector<double> buffer;
+  std::vector<int> counts, displacements;
+  if (rank0) {
+    counts.resize(m_impl->size);
+    displacements.resize(m_impl->size);
+
+    for (int r = 0; r < m_impl->size; ++r) {
+      counts[r]        = t_count * patches[4 * r + 1] * patches[4 * r + 3];
+      displacements[r] = r == 0 ? 0 : displacements[r - 1] + counts[r - 1];
+    }
+    buffer.resize(displacements.back() + counts.back());
+
+    // pack sub-domains of all processes, in the order of ranks
+    double *result = buffer.data();
+    for (int r = 0; r < m_impl->size; ++r) {
+      const unsigned int
+        xs = patches[4 * r + 0] - block.x_start,
+        xc = patches[4 * r + 1],
+        ys = patches[4 * r + 2] - block.y_start,
+        yc = patches[4 * r + 3];
+
+      for (unsigned int t = 0; t < t_count; ++t) {
+        for (unsigned int y = 0; y < yc; ++y) {
+          size_t offset = (((size_t)(t_start - block.t_start + t) * block.y_count + ys + y) *
+                           block.x_count + xs);
+          memcpy(result, &block.data[offset], xc * sizeof(double));
+          result += xc;
+        }
+      }
+    }
+  }
+
+  MPI_Scatterv(buffer.data(), counts.data(), displacements.data(), MPI_DOUBLE,
+               output, t_count * y_count * x_count, MPI_DOUBLE, 0, m_impl->com);
+
+  return true;
+}
+
+} // end of namespace io
+} // end of namespace pism
@@ -0,0 +1,67 @@
+/* Copyright (C) 2020 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PISM_PREFETCHER_H
+#define PISM_PREFETCHER_H
+
+#include <string>
+#include <mpi.h>
+
+namespace pism {
+namespace io {
+
+//! Reads blocks of records of a 2D variable in a background thread.
+/*!
+ * Rank 0 reads records of a variable stored as (time, y, x) in a NetCDF file (the part of
+ * the x-y domain covering sub-domains of all processes) in a background thread, so that
+ * the model can continue time-stepping while the next block of forcing data is read.
+ * read() waits for this thread and scatters the block.
+ *
+ * The background thread does not make any MPI calls. All calls to the NetCDF library are
+ * serialized using NCFile::library_mutex(), which is released between records.
+ */
+class Prefetcher {
+public:
+  Prefetcher(MPI_Comm com);
+  ~Prefetcher();
+
+  static bool supported();
+
+  void request(const std::string &filename, const std::string &variable_name,
+               unsigned int t_start, unsigned int t_count);
+
+  bool read(const std::string &filename, const std::string &variable_name,
+            unsigned int t_start, unsigned int t_count,
+            unsigned int x_start, unsigned int x_count,
+            unsigned int y_start, unsigned int y_count,
+            double *output);
+
+  struct Impl;
+private:
+  Impl *m_impl;
+
+  // disable copying and assignments
+  Prefetcher(const Prefetcher &other);
+  Prefetcher & operator=(const Prefetcher &);
+};
+
+} // end of namespace io
+} // end of namespace pism
+
+#endif /* PISM_PREFETCHER_H */
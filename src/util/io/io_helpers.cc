@@ -19,6 +19,10 @@
 
 #include <memory>
 #include <cassert>
+#include <cmath>                // std::ceil, std::log2, std::isfinite, std::fabs
+#include <cstdint>              // uint64_t
+#include <cstdlib>              // strtol
+#include <cstring>              // memcpy
 
 #include "io_helpers.hh"
 #include "File.hh"
@@ -34,6 +38,8 @@
 #include "pism/util/projection.hh"
 #include "pism/util/interpolation.hh"
 #include "pism/util/Profiling.hh"
+#include "Prefetcher.hh"
+#include "Coarsening.hh"
 
 namespace pism {
 namespace io {
@@ -45,7 +51,7 @@ namespace io {
  * Note that its inputs are (essentially)
  * - the definition of the input grid
  * - the definition of the output grid
- * - input array (lic->buffer)
+ * - input array (usually lic->buffer)
  * - output array (double *output_array)
  *
  * The `output_array` is expected to be big enough to contain
@@ -55,14 +61,13 @@ namespace io {
  * fairly easily...
  */
 static void regrid(const IceGrid& grid, const std::vector<double> &zlevels_out,
-                   LocalInterpCtx *lic, double *output_array) {
+                   LocalInterpCtx *lic, const double *input_array, double *output_array) {
   // We'll work with the raw storage here so that the array we are filling is
   // indexed the same way as the buffer we are pulling from (input_array)
 
   const int X = 1, Z = 3; // indices, just for clarity
 
   unsigned int nlevels = zlevels_out.size();
-  double *input_array = &(lic->buffer[0]);
 
   // array sizes for mapping from logical to "flat" indices
   int
@@ -439,6 +444,7 @@ static void read_distributed_array(const File &file, const IceGrid &grid,
 }
 
 static void regrid_vec_generic(const File &file, const IceGrid &grid,
+                               const grid_info &input_grid,
                                const std::string &variable_name,
                                const std::vector<double> &zlevels_out,
                                unsigned int t_start,
@@ -451,10 +457,11 @@ static void regrid_vec_generic(const File &file, const IceGrid &grid,
   const Profiling& profiling = grid.ctx()->profiling();
 
   try {
-    grid_info gi(file, variable_name, grid.ctx()->unit_system(), grid.registration());
-    LocalInterpCtx lic(gi, grid, zlevels_out, interpolation_type);
+    // variables in an input file usually share the grid, so the interpolation context is
+    // cached by the grid
+    auto lic = grid.interpolation_context(input_grid, zlevels_out, interpolation_type);
 
-    std::vector<double> &buffer = lic.buffer;
+    std::vector<double> &buffer = lic->buffer;
 
     const unsigned int t_count = 1;
     std::vector<unsigned int> start, count, imap;
@@ -462,9 +469,9 @@ static void regrid_vec_generic(const File &file, const IceGrid &grid,
                             grid.ctx()->unit_system(),
                             variable_name,
                             t_start, t_count,
-                            lic.start[X], lic.count[X],
-                            lic.start[Y], lic.count[Y],
-                            lic.start[Z], lic.count[Z],
+                            lic->start[X], lic->count[X],
+                            lic->start[Y], lic->count[Y],
+                            lic->start[Z], lic->count[Z],
                             start, count, imap);
 
     bool transposed_io = use_transposed_io(file, grid.ctx()->unit_system(), variable_name);
@@ -493,7 +500,7 @@ static void regrid_vec_generic(const File &file, const IceGrid &grid,
 
     // interpolate
     profiling.begin("io.regridding.interpolate");
-    regrid(grid, zlevels_out, &lic, output);
+    regrid(grid, zlevels_out, lic.get(), buffer.data(), output);
     profiling.end("io.regridding.interpolate");
   } catch (RuntimeError &e) {
     e.add_context("reading variable '%s' (using linear interpolation) from '%s'",
@@ -504,12 +511,14 @@ static void regrid_vec_generic(const File &file, const IceGrid &grid,
 
 //! \brief Read a PETSc Vec from a file, using bilinear (or trilinear)
 //! interpolation to put it on the grid defined by "grid" and zlevels_out.
-static void regrid_vec(const File &file, const IceGrid &grid, const std::string &var_name,
+static void regrid_vec(const File &file, const IceGrid &grid,
+                       const grid_info &input_grid,
+                       const std::string &var_name,
                        const std::vector<double> &zlevels_out,
                        unsigned int t_start,
                        InterpolationType interpolation_type,
                        double *output) {
-  regrid_vec_generic(file, grid,
+  regrid_vec_generic(file, grid, input_grid,
                      var_name,
                      zlevels_out,
                      t_start,
@@ -522,6 +531,7 @@ static void regrid_vec(const File &file, const IceGrid &grid, const std::string
  *
  * @param[in] file input file
  * @param grid computational grid; used to initialize interpolation
+ * @param input_grid grid of `var_name` in `file`
  * @param var_name variable to regrid
  * @param zlevels_out vertical levels of the resulting grid
  * @param t_start time index of the record to regrid
@@ -529,13 +539,14 @@ static void regrid_vec(const File &file, const IceGrid &grid, const std::string
  * @param[out] output resulting interpolated field
  */
 static void regrid_vec_fill_missing(const File &file, const IceGrid &grid,
+                                    const grid_info &input_grid,
                                     const std::string &var_name,
                                     const std::vector<double> &zlevels_out,
                                     unsigned int t_start,
                                     double default_value,
                                     InterpolationType interpolation_type,
                                     double *output) {
-  regrid_vec_generic(file, grid,
+  regrid_vec_generic(file, grid, input_grid,
                      var_name,
                      zlevels_out,
                      t_start,
@@ -544,9 +555,167 @@ static void regrid_vec_fill_missing(const File &file, const IceGrid &grid,
                      output);
 }
 
+//! Size of a value of type `type`, in bytes.
+static size_t type_size(IO_Type type) {
+  switch (type) {
+  case PISM_BYTE:
+  case PISM_CHAR:
+    return 1;
+  case PISM_SHORT:
+    return 2;
+  case PISM_INT:
+  case PISM_FLOAT:
+    return 4;
+  case PISM_DOUBLE:
+  default:
+    return 8;
+  }
+}
+
+/*!
+ * Chunk sizes for a spatial variable.
+ *
+ * Each write covers one record of the whole grid, so a chunk contains one time record and
+ * the whole x-y tile, plus as many vertical levels as fit in `max_size` bytes. If the x-y
+ * tile is bigger than `max_size`, it is split along the y axis.
+ */
+static std::vector<size_t> spatial_chunk_dimensions(IO_Type type, bool time_dependent,
+                                                    size_t Mx, size_t My, size_t Mz,
+                                                    bool has_z, size_t max_size) {
+  const size_t
+    value_size = type_size(type),
+    tile_size  = Mx * My * value_size;
+
+  size_t z_chunk = std::max(std::min(Mz, max_size / tile_size), (size_t)1);
+  size_t y_chunk = My;
+  if (tile_size > max_size) {
+    y_chunk = std::max(std::min(My, max_size / (Mx * value_size)), (size_t)1);
+  }
+
+  std::vector<size_t> result;
+  if (time_dependent) {
+    result.push_back(1);
+  }
+  result.push_back(y_chunk);
+  result.push_back(Mx);
+  if (has_z) {
+    result.push_back(z_chunk);
+  }
+  return result;
+}
+
+/*!
+ * Returns true if the spatial variable `name` should be compressed.
+ *
+ * Sets `significant_digits` to the number of significant decimal digits to keep (zero
+ * means "lossless"). Entries of `output.compression.variables` can have the form
+ * `name:N` to override `output.compression.significant_digits`.
+ */
+static bool compression_settings(const Config &config, const std::string &name,
+                                 int &significant_digits) {
+  significant_digits = config.get_number("output.compression.significant_digits");
+
+  std::string variables = config.get_string("output.compression.variables");
+  if (variables.empty()) {
+    return true;
+  }
+
+  for (const auto &entry : split(variables, ',')) {
+    std::vector<std::string> parts = split(entry, ':');
+
+    if (parts.empty() or parts[0] != name) {
+      continue;
+    }
+
+    if (parts.size() > 1) {
+      char *endptr = NULL;
+      long int digits = strtol(parts[1].c_str(), &endptr, 10);
+      if (*endptr != '\0' or digits < 0) {
+        throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                      "invalid entry '%s' in output.compression.variables"
+                                      " (expected 'name' or 'name:N', N >= 0)",
+                                      entry.c_str());
+      }
+      significant_digits = digits;
+    }
+    return true;
+  }
+
+  return false;
+}
+
+/*!
+ * Returns true if the spatial variable `var` is compressed when written to `file`.
+ *
+ * Sets `significant_digits` to the number of significant decimal digits to keep (zero
+ * means "do not quantize"). Quantization is lossy, so it is used only with compression and
+ * never applies to the model state: re-starting from a file has to reproduce the run.
+ */
+static bool compressed(const Config &config, const File &file,
+                       const SpatialVariableMetadata &var, IO_Type type,
+                       int &significant_digits) {
+  significant_digits = 0;
+
+  IO_Backend backend = file.backend();
+  bool netcdf4 = (backend == PISM_NETCDF4_PARALLEL or
+                  backend == PISM_PIO_NETCDF4C or
+                  backend == PISM_PIO_NETCDF4P);
+
+  int digits = 0;
+  if (config.get_number("output.compression.level") <= 0 or not netcdf4 or
+      not compression_settings(config, var.get_name(), digits)) {
+    return false;
+  }
+
+  bool
+    floating_point = (type == PISM_NAT or type == PISM_FLOAT or type == PISM_DOUBLE),
+    model_state    = var.get_string("pism_intent") == "model_state";
+
+  if (floating_point and not model_state) {
+    significant_digits = digits;
+  }
+
+  return true;
+}
+
+/*!
+ * Round `data` to `significant_digits` decimal digits by rounding mantissas of IEEE
+ * doubles to the corresponding number of bits (bit rounding).
+ *
+ * Zeroed trailing mantissa bits are easy to compress. Rounding to the nearest value does
+ * not introduce a bias. Values that are not finite are left alone.
+ */
+static void quantize(double *data, size_t size, int significant_digits) {
+  const int
+    mantissa_bits = 52,
+    keep_bits     = std::ceil(significant_digits * std::log2(10.0));
+
+  if (significant_digits <= 0 or keep_bits >= mantissa_bits) {
+    return;
+  }
+
+  const int drop_bits = mantissa_bits - keep_bits;
+
+  const uint64_t
+    half = (uint64_t)1 << (drop_bits - 1),
+    mask = ~(((uint64_t)1 << drop_bits) - 1);
+
+  for (size_t k = 0; k < size; ++k) {
+    if (not std::isfinite(data[k])) {
+      continue;
+    }
+
+    uint64_t bits = 0;
+    memcpy(&bits, &data[k], sizeof(bits));
+    // a carry into the exponent is correct rounding
+    bits = (bits + half) & mask;
+    memcpy(&data[k], &bits, sizeof(bits));
+  }
+}
+
 //! Define a NetCDF variable corresponding to a VariableMetadata object.
 void define_spatial_variable(const SpatialVariableMetadata &var,
-                             const IceGrid &grid, const File &file,
+                             const IceGrid &computational_grid, const File &file,
                              IO_Type default_type) {
   std::vector<std::string> dims;
   std::string name = var.get_name();
@@ -555,6 +724,9 @@ void define_spatial_variable(const SpatialVariableMetadata &var,
     return;
   }
 
+  // use the coarse grid if this file contains coarsened fields
+  const IceGrid &grid = file.coarsening() ? *file.coarsening()->grid() : computational_grid;
+
   define_dimensions(var, grid, file);
 
   std::string
@@ -581,8 +753,33 @@ void define_spatial_variable(const SpatialVariableMetadata &var,
   }
   file.define_variable(name, type, dims);
 
+  // chunking and compression (used by NetCDF-4 backends only)
+  {
+    const Config &config = *grid.ctx()->config();
+
+    size_t max_size = config.get_number("output.chunking.max_size") * 1024 * 1024;
+    size_t Mz = var.get_levels().size();
+
+    file.define_variable_chunking(name,
+                                  spatial_chunk_dimensions(type,
+                                                           not var.get_time_independent(),
+                                                           grid.Mx(), grid.My(),
+                                                           std::max(Mz, (size_t)1),
+                                                           not z.empty(),
+                                                           max_size));
+
+    int digits = 0;
+    if (compressed(config, file, var, type, digits)) {
+      file.define_variable_compression(name, config.get_number("output.compression.level"),
+                                       config.get_flag("output.compression.shuffle"));
+    }
+  }
+
   write_attributes(file, var, type);
 
+  // no-op unless a binary checkpoint is being defined
+  file.define_binary_array(name, std::max(var.get_levels().size(), (size_t)1));
+
   // add the "grid_mapping" attribute if the grid has an associated mapping. Variables lat, lon,
   // lat_bnds, and lon_bnds should not have the grid_mapping attribute to support CDO (see issue
   // #384).
@@ -600,6 +797,24 @@ void define_spatial_variable(const SpatialVariableMetadata &var,
   }
 }
 
+/*!
+ * Returns the name of the file containing data of `variable_name` if this variable was not
+ * written to `file` because it did not change since an earlier backup (see
+ * IceModelVec::define()). Returns an empty string otherwise.
+ */
+static std::string backup_source(const File &file, const std::string &variable_name) {
+  if (not file.find_variable(variable_name) or
+      file.attribute_type(variable_name, "pism_backup_source") == PISM_NAT) {
+    return "";
+  }
+
+  std::string source = file.read_text_attribute(variable_name, "pism_backup_source");
+
+  // backup files are in the same directory
+  std::string filename = file.filename();
+  return filename.substr(0, filename.rfind('/') + 1) + source;
+}
+
 //! Read a variable from a file into an array `output`.
 /*! This also converts data from input units to internal units if needed.
  */
@@ -609,6 +824,28 @@ void read_spatial_variable(const SpatialVariableMetadata &variable,
 
   const Logger &log = *grid.ctx()->log();
 
+  // make sure we have at least one level
+  const std::vector<double>& zlevels = variable.get_levels();
+  unsigned int nlevels = std::max(zlevels.size(), (size_t)1);
+
+  std::string source = backup_source(file, variable.get_name());
+  if (not source.empty()) {
+    File source_file(file.com(), source, PISM_GUESS, PISM_READONLY);
+
+    unsigned int n_records = source_file.nrecords(variable.get_name(),
+                                                  variable.get_string("standard_name"),
+                                                  variable.unit_system());
+
+    read_spatial_variable(variable, grid, source_file, std::max(n_records, 1U) - 1, output);
+    return;
+  }
+
+  if (file.is_binary(variable.get_name())) {
+    // binary checkpoints are stored in internal units
+    file.read_binary_array(variable.get_name(), grid, nlevels, output);
+    return;
+  }
+
   // Find the variable:
   auto var = file.find_variable(variable.get_name(), variable.get_string("standard_name"));
 
@@ -663,10 +900,6 @@ void read_spatial_variable(const SpatialVariableMetadata &variable,
     }
   }
 
-  // make sure we have at least one level
-  const std::vector<double>& zlevels = variable.get_levels();
-  unsigned int nlevels = std::max(zlevels.size(), (size_t)1);
-
   read_distributed_array(file, grid, var.name, nlevels, time, output);
 
   std::string input_units = file.read_text_attribute(var.name, "units");
@@ -706,7 +939,19 @@ void write_spatial_variable(const SpatialVariableMetadata &var,
                                   file.filename().c_str());
   }
 
-  write_dimensions(var, grid, file);
+  // make sure we have at least one level
+  unsigned int nlevels = std::max(var.get_levels().size(), (size_t)1);
+
+  // use the coarse grid if this file contains coarsened fields
+  const IceGrid *output_grid = file.coarsening() ? file.coarsening()->grid().get() : &grid;
+
+  write_dimensions(var, *output_grid, file);
+
+  // skip variables that did not change since an earlier backup
+  if (file.backup_index() != nullptr and
+      file.attribute_type(name, "pism_backup_source") != PISM_NAT) {
+    return;
+  }
 
   // avoid writing time-independent variables more than once (saves time when writing to
   // extra_files)
@@ -720,30 +965,42 @@ void write_spatial_variable(const SpatialVariableMetadata &var,
     }
   }
 
-  // make sure we have at least one level
-  unsigned int nlevels = std::max(var.get_levels().size(), (size_t)1);
+  if (file.is_binary(name)) {
+    // binary checkpoints are stored in internal units
+    file.write_binary_array(name, grid, nlevels, input);
+    return;
+  }
 
   std::string
     units               = var.get_string("units"),
     glaciological_units = var.get_string("glaciological_units");
 
-  if (units != glaciological_units) {
-    size_t data_size = grid.xm() * grid.ym() * nlevels;
+  int significant_digits = 0;
+  compressed(*grid.ctx()->config(), file, var, var.get_output_type(), significant_digits);
 
-    // create a temporary array, convert to glaciological units, and
+  if (units != glaciological_units or significant_digits > 0 or file.coarsening()) {
+    // create a temporary array, convert to glaciological units, coarsen, quantize, and
     // save
-    std::vector<double> tmp(data_size);
-    for (size_t k = 0; k < data_size; ++k) {
-      tmp[k] = input[k];
+    std::vector<double> tmp(input, input + grid.xm() * grid.ym() * nlevels);
+
+    if (units != glaciological_units) {
+      units::Converter(var.unit_system(),
+                       units,
+                       glaciological_units).convert_doubles(&tmp[0], tmp.size());
+    }
+
+    // coarsening has to recognize fill values, so it uses glaciological units
+    if (file.coarsening()) {
+      std::vector<double> coarse(output_grid->xm() * output_grid->ym() * nlevels);
+      file.coarsening()->coarsen(var, nlevels, tmp.data(), coarse.data());
+      tmp.swap(coarse);
     }
 
-    units::Converter(var.unit_system(),
-                     units,
-                     glaciological_units).convert_doubles(&tmp[0], tmp.size());
+    quantize(tmp.data(), tmp.size(), significant_digits);
 
-    file.write_distributed_array(name, grid, nlevels, &tmp[0]);
+    file.write_distributed_array(name, *output_grid, nlevels, &tmp[0]);
   } else {
-    file.write_distributed_array(name, grid, nlevels, input);
+    file.write_distributed_array(name, *output_grid, nlevels, input);
   }
 }
 
@@ -892,6 +1149,37 @@ static void check_grid_overlap(const grid_info &input, const IceGrid &internal,
   }
 }
 
+//! Check if coordinates `a` and `b` are the same (up to one micron).
+static bool same_coordinates(const std::vector<double> &a, const std::vector<double> &b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+
+  for (size_t k = 0; k < a.size(); ++k) {
+    if (std::fabs(a[k] - b[k]) > 1e-6) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//! Check that a variable stored in a binary checkpoint uses the same grid as PISM.
+static void check_same_grid(const grid_info &input, const IceGrid &internal,
+                            const std::vector<double> &z_internal) {
+  bool z_matches = (z_internal.size() <= 1 ?
+                    input.z.size() <= 1 :
+                    same_coordinates(input.z, z_internal));
+
+  if (not (same_coordinates(input.x, internal.x()) and
+           same_coordinates(input.y, internal.y()) and
+           z_matches)) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "cannot regrid from the binary checkpoint '%s':\n"
+                                  "restarting from it requires the same grid",
+                                  input.filename.c_str());
+  }
+}
+
 void regrid_spatial_variable(SpatialVariableMetadata &variable,
                              const IceGrid& grid, const File &file,
                              unsigned int t_start, RegriddingFlag flag,
@@ -911,48 +1199,65 @@ void regrid_spatial_variable(SpatialVariableMetadata &variable,
 
   if (var.exists) {                      // the variable was found successfully
 
-    {
-      grid_info input_grid(file, var.name, sys, grid.registration());
+    std::string source = backup_source(file, var.name);
+    if (not source.empty()) {
+      File source_file(file.com(), source, PISM_GUESS, PISM_READONLY);
+
+      regrid_spatial_variable(variable, grid, source_file, flag, report_range,
+                              allow_extrapolation, default_value, interpolation_type,
+                              output);
+      return;
+    }
 
-      check_input_grid(input_grid);
+    bool binary = file.is_binary(var.name);
 
-      if (not allow_extrapolation) {
-        check_grid_overlap(input_grid, grid, levels);
-      }
+    grid_info input_grid(file, var.name, sys, grid.registration());
+
+    check_input_grid(input_grid);
+
+    if (binary) {
+      check_same_grid(input_grid, grid, levels);
+    } else if (not allow_extrapolation) {
+      check_grid_overlap(input_grid, grid, levels);
     }
 
-    if (flag == OPTIONAL_FILL_MISSING or flag == CRITICAL_FILL_MISSING) {
+    if (binary) {
+      // binary checkpoints are stored in internal units and don't need regridding
+      file.read_binary_array(var.name, grid, levels.size(), output);
+    } else if (flag == OPTIONAL_FILL_MISSING or flag == CRITICAL_FILL_MISSING) {
       log.message(2,
                   "PISM WARNING: Replacing missing values with %f [%s] in variable '%s' read from '%s'.\n",
                   default_value, variable.get_string("units").c_str(), variable.get_name().c_str(),
                   file.filename().c_str());
 
-      regrid_vec_fill_missing(file, grid, var.name, levels,
+      regrid_vec_fill_missing(file, grid, input_grid, var.name, levels,
                               t_start, default_value, interpolation_type, output);
     } else {
-      regrid_vec(file, grid, var.name, levels, t_start, interpolation_type, output);
+      regrid_vec(file, grid, input_grid, var.name, levels, t_start, interpolation_type, output);
     }
 
-    // Now we need to get the units string from the file and convert
-    // the units, because check_range and report_range expect data to
-    // be in PISM (MKS) units.
-
-    std::string input_units = file.read_text_attribute(var.name, "units");
-    std::string internal_units = variable.get_string("units");
+    if (not binary) {
+      // Now we need to get the units string from the file and convert
+      // the units, because check_range and report_range expect data to
+      // be in PISM (MKS) units.
+
+      std::string input_units = file.read_text_attribute(var.name, "units");
+      std::string internal_units = variable.get_string("units");
+
+      if (input_units.empty() and not internal_units.empty()) {
+        log.message(2,
+                    "PISM WARNING: Variable '%s' ('%s') does not have the units attribute.\n"
+                    "              Assuming that it is in '%s'.\n",
+                    variable.get_name().c_str(),
+                    variable.get_string("long_name").c_str(),
+                    internal_units.c_str());
+        input_units = internal_units;
+      }
 
-    if (input_units.empty() and not internal_units.empty()) {
-      log.message(2,
-                  "PISM WARNING: Variable '%s' ('%s') does not have the units attribute.\n"
-                  "              Assuming that it is in '%s'.\n",
-                  variable.get_name().c_str(),
-                  variable.get_string("long_name").c_str(),
-                  internal_units.c_str());
-      input_units = internal_units;
+      // Convert data:
+      units::Converter(sys, input_units, internal_units).convert_doubles(output, data_size);
     }
 
-    // Convert data:
-    units::Converter(sys, input_units, internal_units).convert_doubles(output, data_size);
-
     // Check the range and report it if necessary.
     {
       double min = 0.0, max = 0.0;
@@ -999,6 +1304,148 @@ void regrid_spatial_variable(SpatialVariableMetadata &variable,
 
 
 
+/*!
+ * Regrid records `[t_start, t_start + t_count)` of a 2D or 3D variable using a single
+ * (multi-record) read per process.
+ *
+ * Records are stored in `output` one after another, each using the layout expected by
+ * regrid_spatial_variable().
+ *
+ * If `prefetcher` is not NULL and it holds requested records, they are taken from it
+ * instead of the file. The prefetcher is used only if the variable is stored as (time, y,
+ * x).
+ *
+ * Returns true if records were taken from the prefetcher.
+ *
+ * The variable has to be present in `file`.
+ */
+bool regrid_records(SpatialVariableMetadata &variable,
+                    const IceGrid& grid, const File &file,
+                    unsigned int t_start, unsigned int t_count,
+                    bool report_range,
+                    bool allow_extrapolation,
+                    InterpolationType interpolation_type,
+                    Prefetcher *prefetcher,
+                    double *output) {
+  const int X = 1, Y = 2, Z = 3; // indices, just for clarity
+
+  const Logger &log = *grid.ctx()->log();
+  const Profiling& profiling = grid.ctx()->profiling();
+
+  units::System::Ptr sys = variable.unit_system();
+  const std::vector<double>& levels = variable.get_levels();
+  const size_t data_size = grid.xm() * grid.ym() * levels.size();
+
+  auto var = file.find_variable(variable.get_name(), variable.get_string("standard_name"));
+
+  if (not var.exists) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "Can't find '%s' in the regridding file '%s'.",
+                                  variable.get_name().c_str(), file.filename().c_str());
+  }
+
+  if (file.is_binary(var.name) or not backup_source(file, var.name).empty()) {
+    // these are not used to store forcing: fall back to reading one record at a time
+    for (unsigned int k = 0; k < t_count; ++k) {
+      regrid_spatial_variable(variable, grid, file, t_start + k, CRITICAL,
+                              report_range, allow_extrapolation, 0.0, interpolation_type,
+                              output + k * data_size);
+    }
+    return false;
+  }
+
+  grid_info input_grid(file, var.name, sys, grid.registration());
+
+  check_input_grid(input_grid);
+
+  if (not allow_extrapolation) {
+    check_grid_overlap(input_grid, grid, levels);
+  }
+
+  bool prefetched = false;
+  try {
+    auto lic = grid.interpolation_context(input_grid, levels, interpolation_type);
+
+    // the size of one record in the buffer (lic->buffer is bigger on rank 0: it may need
+    // to hold a record read by another process)
+    const size_t record_size = lic->count[X] * lic->count[Y] * std::max(lic->count[Z], 1u);
+
+    std::vector<double> buffer(lic->buffer.size() * t_count);
+
+    bool transposed_io = use_transposed_io(file, grid.ctx()->unit_system(), var.name);
+
+    profiling.begin("io.regridding.read");
+    if (prefetcher != nullptr and not transposed_io and
+        file.dimensions(var.name).size() == 3) {
+      prefetched = prefetcher->read(file.filename(), var.name,
+                                    t_start, t_count,
+                                    lic->start[X], lic->count[X],
+                                    lic->start[Y], lic->count[Y],
+                                    buffer.data());
+    }
+
+    if (not prefetched) {
+      std::vector<unsigned int> start, count, imap;
+      compute_start_and_count(file,
+                              grid.ctx()->unit_system(),
+                              var.name,
+                              t_start, t_count,
+                              lic->start[X], lic->count[X],
+                              lic->start[Y], lic->count[Y],
+                              lic->start[Z], lic->count[Z],
+                              start, count, imap);
+
+      if (transposed_io) {
+        file.read_variable_transposed(var.name, start, count, imap, buffer.data());
+      } else {
+        file.read_variable(var.name, start, count, buffer.data());
+      }
+    }
+    profiling.end("io.regridding.read");
+
+    profiling.begin("io.regridding.interpolate");
+    for (unsigned int k = 0; k < t_count; ++k) {
+      regrid(grid, levels, lic.get(), &buffer[k * record_size], output + k * data_size);
+    }
+    profiling.end("io.regridding.interpolate");
+  } catch (RuntimeError &e) {
+    e.add_context("reading records %d through %d of variable '%s' from '%s'",
+                  t_start, t_start + t_count - 1,
+                  var.name.c_str(), file.filename().c_str());
+    throw;
+  }
+
+  std::string input_units = file.read_text_attribute(var.name, "units");
+  std::string internal_units = variable.get_string("units");
+
+  if (input_units.empty() and not internal_units.empty()) {
+    log.message(2,
+                "PISM WARNING: Variable '%s' ('%s') does not have the units attribute.\n"
+                "              Assuming that it is in '%s'.\n",
+                variable.get_name().c_str(),
+                variable.get_string("long_name").c_str(),
+                internal_units.c_str());
+    input_units = internal_units;
+  }
+
+  units::Converter(sys, input_units, internal_units).convert_doubles(output, data_size * t_count);
+
+  {
+    double min = 0.0, max = 0.0;
+    read_valid_range(file, var.name, variable);
+
+    compute_range(grid.com, output, data_size * t_count, &min, &max);
+
+    variable.check_range(file.filename(), min, max);
+    if (report_range) {
+      log.message(2, "  FOUND ");
+
+      variable.report_range(log, min, max, var.found_using_standard_name);
+    }
+  }
+
+  return prefetched;
+}
+
 //! Define a NetCDF variable corresponding to a time-series.
 void define_timeseries(const TimeseriesMetadata& var,
                        const File &file, IO_Type nctype) {
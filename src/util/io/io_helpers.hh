@@ -43,6 +43,8 @@ class Config;
 
 namespace io {
 
+class Prefetcher;
+
 void regrid_spatial_variable(SpatialVariableMetadata &var,
                              const IceGrid& grid, const File &nc,
                              RegriddingFlag flag, bool do_report_range,
@@ -60,6 +62,15 @@ void regrid_spatial_variable(SpatialVariableMetadata &var,
                              InterpolationType type,
                              double *output);
 
+bool regrid_records(SpatialVariableMetadata &var,
+                    const IceGrid& grid, const File &nc,
+                    unsigned int t_start, unsigned int t_count,
+                    bool do_report_range,
+                    bool allow_extrapolation,
+                    InterpolationType type,
+                    Prefetcher *prefetcher,
+                    double *output);
+
 void read_spatial_variable(const SpatialVariableMetadata &var,
                            const IceGrid& grid, const File &nc,
                            unsigned int time, double *output);
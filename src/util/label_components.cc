@@ -1,4 +1,4 @@
-/* Copyright (C) 2019 PISM Authors
+/* Copyright (C) 2019, 2020 PISM Authors
  *
  * This file is part of PISM.
  *
@@ -17,40 +17,301 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <vector>
+#include <algorithm>            // std::sort, std::lower_bound
+#include <cmath>                // std::fabs
+#include <cstdint>              // int64_t
+
 #include "label_components.hh"
 
 #include "pism/util/iceModelVec.hh"
+#include "pism/util/IceGrid.hh"
 #include "pism/util/error_handling.hh"
-#include "connected_components.hh"
 
 namespace pism {
 
+/*!
+ * Find the root of the set containing `k`, using path halving.
+ */
+static int find_root(std::vector<int> &parent, int k) {
+  while (parent[k] != k) {
+    parent[k] = parent[parent[k]];
+    k = parent[k];
+  }
+  return k;
+}
+
+/*!
+ * Merge sets containing `a` and `b`. The smallest element of a set is always its root.
+ */
+static void join(std::vector<int> &parent, int a, int b) {
+  a = find_root(parent, a);
+  b = find_root(parent, b);
+
+  if (a < b) {
+    parent[b] = a;
+  } else if (b < a) {
+    parent[a] = b;
+  }
+}
+
+/*!
+ * Gather `local` from all processes on rank 0. Sets `counts` and `displacements` (used to
+ * send results back) on rank 0.
+ */
+static std::vector<int64_t> gather(MPI_Comm com, int rank, int size,
+                                   const std::vector<int64_t> &local,
+                                   std::vector<int> &counts,
+                                   std::vector<int> &displacements) {
+  int local_count = local.size();
+
+  counts.resize(size);
+  displacements.resize(size);
+
+  MPI_Gather(&local_count, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, com);
+
+  int total = 0;
+  if (rank == 0) {
+    for (int k = 0; k < size; ++k) {
+      displacements[k] = total;
+      total += counts[k];
+    }
+  }
+
+  std::vector<int64_t> result(total);
+  MPI_Gatherv(const_cast<int64_t*>(local.data()), local_count, MPI_INT64_T,
+              result.data(), counts.data(), displacements.data(), MPI_INT64_T,
+              0, com);
+
+  return result;
+}
+
 /*!
  * Label connected components in a mask stored in an IceModelVec2Int.
  *
- * This function allocates a copy on rank 0 and so should not be used if that is a
- * problem.
+ * Cells with positive mask values are in the foreground; two foreground cells are
+ * connected if they share an edge.
+ *
+ * If `identify_icebergs` is true, cells of components that contain at least one cell
+ * with the value `mask_grounded` are set to zero and all other foreground cells are set
+ * to one. Otherwise foreground cells are set to labels of their components: 1, 2, ...,
+ * numbered in the order of their first cells in the natural (row-major) ordering.
+ * Background cells are not modified.
+ *
+ * The result is the same as the one produced by the serial label_connected_components(),
+ * but the mask is never gathered on one process:
+ *
+ * 1. Each process labels components of the part of the mask it owns using union-find.
+ *    The provisional label of a component is the natural index of its first cell.
+ *
+ * 2. Provisional labels are exchanged with neighbors (using ghosts) and each process
+ *    records pairs of labels of components that touch across its north and east
+ *    sub-domain boundaries, as well as one "grounded" flag per local component.
+ *
+ * 3. Rank 0 merges these (the amount of data is proportional to the number of local
+ *    components and the length of sub-domain boundaries, not the grid size) and sends
+ *    the final value for each local component back to the process that owns it.
  */
 void label_components(IceModelVec2Int &mask, bool identify_icebergs, double mask_grounded) {
-  auto mask_p0 = mask.allocate_proc0_copy();
+  IceGrid::ConstPtr grid = mask.grid();
+
+  MPI_Comm com = grid->com;
+
+  const double eps = 1e-6;
 
-  mask.put_on_proc0(*mask_p0);
+  const int
+    Mx = grid->Mx(),
+    My = grid->My(),
+    xs = grid->xs(),
+    xm = grid->xm(),
+    ys = grid->ys(),
+    ym = grid->ym();
 
-  auto grid = mask.grid();
+  // Step 1: label components in the sub-domain owned by this process
+  std::vector<int> parent(xm * ym, -1);
+  {
+    IceModelVec::AccessList list{&mask};
 
-  ParallelSection rank0(grid->com);
+    for (Points p(*grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      if (not (mask(i, j) > 0.0)) {
+        continue;
+      }
+
+      const int k = (j - ys) * xm + (i - xs);
+
+      parent[k] = k;
+
+      if (i > xs and parent[k - 1] >= 0) {
+        join(parent, k, k - 1);
+      }
+
+      if (j > ys and parent[k - xm] >= 0) {
+        join(parent, k, k - xm);
+      }
+    }
+  }
+
+  // Provisional labels (natural indexes of first cells of local components) and
+  // "grounded" flags of local components. Note that roots are the smallest elements of
+  // their sets, so the root of a component is its first cell in the natural ordering.
+  std::vector<int> component(xm * ym, -1);
+  std::vector<int64_t> labels, grounded;
+  for (int k = 0; k < xm * ym; ++k) {
+    if (parent[k] == k) {
+      component[k] = labels.size();
+      labels.push_back(static_cast<int64_t>(ys + k / xm) * Mx + (xs + k % xm));
+      grounded.push_back(0);
+    }
+  }
+
+  // Step 2: exchange provisional labels with neighbors and record connections across
+  // sub-domain boundaries
+  IceModelVec2S provisional(grid, "provisional_labels", WITH_GHOSTS, 1);
+  {
+    IceModelVec::AccessList list{&mask, &provisional};
+
+    for (Points p(*grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      const int k = (j - ys) * xm + (i - xs);
+
+      if (parent[k] < 0) {
+        provisional(i, j) = -1.0;
+        continue;
+      }
+
+      const int c = component[find_root(parent, k)];
+
+      provisional(i, j) = labels[c];
+
+      if (std::fabs(mask(i, j) - mask_grounded) < eps) {
+        grounded[c] = 1;
+      }
+    }
+  }
+  provisional.update_ghosts();
+
+  // pairs of provisional labels of connected components
+  std::vector<int64_t> connections;
+  {
+    IceModelVec::AccessList list{&provisional};
+
+    for (Points p(*grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      if (provisional(i, j) < 0.0) {
+        continue;
+      }
+
+      // Only consider east and north neighbors so that each connection is recorded
+      // once. Skip neighbors outside the domain (ghosts of periodic grids).
+      if (i == xs + xm - 1 and i + 1 < Mx and provisional(i + 1, j) >= 0.0) {
+        connections.push_back(static_cast<int64_t>(provisional(i, j)));
+        connections.push_back(static_cast<int64_t>(provisional(i + 1, j)));
+      }
+
+      if (j == ys + ym - 1 and j + 1 < My and provisional(i, j + 1) >= 0.0) {
+        connections.push_back(static_cast<int64_t>(provisional(i, j)));
+        connections.push_back(static_cast<int64_t>(provisional(i, j + 1)));
+      }
+    }
+  }
+
+  // Step 3: merge on rank 0
+  const int
+    rank = grid->rank(),
+    size = grid->size();
+
+  std::vector<int> counts, displacements, unused_counts, unused_displacements;
+
+  std::vector<int64_t>
+    all_labels      = gather(com, rank, size, labels, counts, displacements),
+    all_grounded    = gather(com, rank, size, grounded, unused_counts, unused_displacements),
+    all_connections = gather(com, rank, size, connections, unused_counts, unused_displacements);
+
+  std::vector<int64_t> all_values(all_labels.size());
+
+  ParallelSection rank0(com);
   try {
-    if (grid->rank() == 0) {
-      petsc::VecArray array(*mask_p0);
-      label_connected_components(array.get(), grid->My(), grid->Mx(),
-                                 identify_icebergs, mask_grounded);
+    if (rank == 0) {
+      const int N = all_labels.size();
+
+      // provisional labels are distinct natural indexes; sort them to map a label to its
+      // position in the sorted list
+      std::vector<int64_t> sorted(all_labels);
+      std::sort(sorted.begin(), sorted.end());
+
+      std::vector<int> global_parent(N);
+      for (int k = 0; k < N; ++k) {
+        global_parent[k] = k;
+      }
+
+      for (unsigned int k = 0; k + 1 < all_connections.size(); k += 2) {
+        auto a = std::lower_bound(sorted.begin(), sorted.end(), all_connections[k]);
+        auto b = std::lower_bound(sorted.begin(), sorted.end(), all_connections[k + 1]);
+
+        if (a == sorted.end() or b == sorted.end()) {
+          throw RuntimeError(PISM_ERROR_LOCATION, "invalid provisional component label");
+        }
+
+        join(global_parent, a - sorted.begin(), b - sorted.begin());
+      }
+
+      // roots are the smallest elements of their sets, so numbering roots in increasing
+      // order reproduces the numbering used by the serial code
+      std::vector<int64_t> final_label(N, 0), root_grounded(N, 0);
+      int64_t n_components = 0;
+      for (int k = 0; k < N; ++k) {
+        if (global_parent[k] == k) {
+          n_components += 1;
+          final_label[k] = n_components;
+        }
+      }
+
+      std::vector<int> position(N);
+      for (int k = 0; k < N; ++k) {
+        position[k] = std::lower_bound(sorted.begin(), sorted.end(), all_labels[k]) - sorted.begin();
+
+        if (all_grounded[k] != 0) {
+          root_grounded[find_root(global_parent, position[k])] = 1;
+        }
+      }
+
+      for (int k = 0; k < N; ++k) {
+        const int r = find_root(global_parent, position[k]);
+
+        all_values[k] = identify_icebergs ? 1 - root_grounded[r] : final_label[r];
+      }
     }
   } catch (...) {
     rank0.failed();
   }
   rank0.check();
 
-  mask.get_from_proc0(*mask_p0);
+  std::vector<int64_t> values(labels.size());
+  MPI_Scatterv(all_values.data(), counts.data(), displacements.data(), MPI_INT64_T,
+               values.data(), values.size(), MPI_INT64_T, 0, com);
+
+  // Step 4: set final values
+  {
+    IceModelVec::AccessList list{&mask};
+
+    for (Points p(*grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      const int k = (j - ys) * xm + (i - xs);
+
+      if (parent[k] >= 0) {
+        mask(i, j) = values[component[find_root(parent, k)]];
+      }
+    }
+  }
+
+  if (mask.stencil_width() > 0) {
+    mask.update_ghosts();
+  }
 }
 
 } // end of namespace pism
@@ -158,6 +158,18 @@ int GlobalSum(MPI_Comm comm, int input) {
   return result;
 }
 
+/*!
+ * Returns true if the MPI library was initialized with `MPI_THREAD_FUNNELED` or a higher
+ * thread level, i.e. if the main thread can make MPI calls while other threads (that do
+ * not use MPI) are running.
+ */
+bool mpi_thread_funneled() {
+  int provided = MPI_THREAD_SINGLE;
+  MPI_Query_thread(&provided);
+
+  return provided >= MPI_THREAD_FUNNELED;
+}
+
 double GlobalMin(MPI_Comm comm, double local) {
   double result;
   GlobalMin(comm, &local, &result, 1);
@@ -115,6 +115,8 @@ unsigned int GlobalSum(MPI_Comm comm, unsigned int input);
 
 int GlobalSum(MPI_Comm comm, int input);
 
+bool mpi_thread_funneled();
+
 std::string version();
 
 std::string printf(const char *format, ...) __attribute__((format(printf, 1, 2)));
@@ -152,6 +152,23 @@ def test(plot=False):
     assert convergence_rate_time(errors, plot)[1] > 0.94
     assert convergence_rate_space(errors, plot)[1] > 1.89
 
+def test_steady_state():
+    "the steady state profile is a fixed point of the time-stepping scheme"
+    Mz = 11
+    dz = 1000.0 / (Mz - 1.0)
+    column = PISM.BedrockColumn("btu", ctx.config, dz, Mz)
+
+    Q_bottom = 0.05
+    T_top = 260.0
+    dt = convert(100.0, "years", "seconds")
+
+    T_steady = column.steady_state(Q_bottom, T_top)
+    T = column.solve(dt, Q_bottom, T_top, T_steady)
+
+    np.testing.assert_allclose(T, T_steady, rtol=1e-12)
+    # the flux through the bottom surface
+    np.testing.assert_allclose(k * (T_steady[0] - T_steady[1]) / dz, Q_bottom, rtol=1e-12)
+
 if __name__ == "__main__":
     import pylab as plt
 
@@ -162,8 +162,39 @@ def test_enth_restart_from_temp():
     enth_model.restart(pio, 0)
 
 
+def test_steady_column_skipping():
+    "Columns in a steady state are skipped at most max_interval times in a row"
+    config = ctx.config
+    prefix = "energy.enthalpy.steady_column_skipping."
+
+    config.set_flag(prefix + "enabled", True)
+    config.set_number(prefix + "max_interval", 2)
+    # use a large tolerance to make sure that all columns are treated as steady
+    config.set_number(prefix + "enthalpy_tolerance", 1e9)
+    # zero geothermal flux keeps the whole column cold
+    basal_heat_flux.set(0.0)
+
+    try:
+        model = PISM.EnthalpyModel(grid, None)
+        initialize(model)
+
+        skipped = []
+        for k in range(4):
+            model.update(0, dt, inputs)
+            stats = model.stats()
+            assert stats.ice_column_counter == grid.Mx() * grid.My()
+            skipped.append(stats.skipped_column_counter)
+
+        # the first update and every (max_interval + 1)-th update solve all columns
+        assert skipped == [0, grid.Mx() * grid.My(), grid.Mx() * grid.My(), 0]
+    finally:
+        config.set_flag(prefix + "enabled", False)
+        basal_heat_flux.set(convert(10, "mW m-2", "W m-2"))
+
+
 setup()
 
 test_interface()
 test_temp_restart_from_enth()
 test_enth_restart_from_temp()
+test_steady_column_skipping()
@@ -0,0 +1,46 @@
+#!/usr/bin/env python
+
+"""Compare the performance of the fused flow step kernel in GeometryEvolution to the
+multi-pass implementation and check that results are identical.
+
+Usage: python geometry_evolution_benchmark.py [Mx] [n_steps]
+
+Run with mpiexec to compare parallel performance.
+"""
+
+import sys
+import time
+
+import numpy as np
+import PISM
+
+from mass_transport import fused_kernel_run
+
+
+def benchmark(fused, Mx, n_steps):
+    start = time.time()
+    result = fused_kernel_run(fused, Mx, n_steps)
+    return time.time() - start, result
+
+
+if __name__ == "__main__":
+    Mx = int(sys.argv[1]) if len(sys.argv) > 1 else 401
+    n_steps = int(sys.argv[2]) if len(sys.argv) > 2 else 50
+
+    ctx = PISM.Context()
+    log = ctx.log
+
+    times = {}
+    results = {}
+    for name, fused in [("multi-pass", False), ("fused", True)]:
+        times[name], results[name] = benchmark(fused, Mx, n_steps)
+
+    if ctx.com.rank == 0:
+        for a, b in zip(results["fused"], results["multi-pass"]):
+            np.testing.assert_array_equal(a, b)
+
+    for name in ["multi-pass", "fused"]:
+        log.message(1, "{:>10}: {:8.3f} s ({} steps, {}x{} grid)\n".format(name, times[name],
+                                                                      n_steps, Mx, Mx))
+
+    log.message(1, "Results are identical.\n")
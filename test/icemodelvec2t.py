@@ -289,6 +289,67 @@ class ForcingInput(unittest.TestCase):
         # fourth month
         check(3)
 
+    def test_prefetch(self):
+        "update() calls with a small buffer and background prefetching"
+        config = ctx.config
+        prefetch = config.get_flag("input.forcing.prefetch")
+        try:
+            config.set_flag("input.forcing.prefetch", True)
+
+            forcing = self.forcing(self.filename, buffer_size=3)
+
+            # step through the whole file one month at a time: each block of records
+            # after the first one is read in the background
+            for month in range(12):
+                t = self.tb[month] * 86400 + 1
+                forcing.update(t, 30 * 86400 - 2)
+                forcing.interp(t)
+
+                compare(forcing, self.f[month])
+
+            # all the records after the first block were read in the background
+            record_size = self.grid.Mx() * self.grid.My() * 8
+            assert forcing.bytes_read() == 12 * record_size
+            assert forcing.bytes_prefetched() == 9 * record_size
+        finally:
+            config.set_flag("input.forcing.prefetch", prefetch)
+
+    def test_streaming(self):
+        "Streaming mode: automatically sized sliding window"
+        config = ctx.config
+        streaming = config.get_flag("input.forcing.streaming.enabled")
+        max_dt = config.get_number("input.forcing.streaming.max_time_step")
+        try:
+            config.set_flag("input.forcing.streaming.enabled", True)
+            # a month and a half
+            config.set_number("input.forcing.streaming.max_time_step", 45.0 / 365.0)
+
+            forcing = self.forcing(self.filename)
+
+            # piecewise-constant interpolation: one record for the current interval and
+            # two more to cover a time step that starts near its end
+            assert forcing.n_records() == 3
+
+            for month in range(12):
+                t = self.tb[month] * 86400 + 1
+                forcing.update(t, 30 * 86400 - 2)
+                forcing.interp(t)
+
+                # records are stored in single precision
+                with PISM.vec.Access(nocomm=forcing):
+                    numpy.testing.assert_almost_equal(forcing[0, 0], self.f[month], decimal=6)
+
+            record_size = self.grid.Mx() * self.grid.My() * 8
+            assert forcing.bytes_read() == 12 * record_size
+            assert forcing.bytes_reread() == 0
+
+            # going back in time requires re-reading records
+            forcing.update(0, 1)
+            assert forcing.bytes_reread() == 3 * record_size
+        finally:
+            config.set_flag("input.forcing.streaming.enabled", streaming)
+            config.set_number("input.forcing.streaming.max_time_step", max_dt)
+
     def test_max_timestep(self):
         "Maximum time step"
         forcing = self.forcing(self.filename, buffer_size=1)
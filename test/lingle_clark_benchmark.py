@@ -0,0 +1,77 @@
+#!/usr/bin/env python
+
+"""Compare the performance of the serial (rank 0) and distributed FFT implementations of
+the Lingle-Clark bed deformation model and check that results agree.
+
+Usage: python lingle_clark_benchmark.py [Mx] [n_steps]
+
+Run with mpiexec using different numbers of processes to see how the distributed
+implementation scales. The serial implementation gathers the load on rank 0, so its
+cost does not depend on the number of processes (apart from communication).
+"""
+
+import sys
+import time
+
+import numpy as np
+import PISM
+from PISM.util import convert
+
+ctx = PISM.Context()
+config = ctx.config
+
+def run(fft, Mx, n_steps):
+    "Bootstrap the model and take n_steps steps with a disc load. Returns times and results."
+    config.set_string("bed_deformation.lc.fft", fft)
+
+    L = convert(2000, "km", "m")
+    grid = PISM.IceGrid.Shallow(ctx.ctx, L, L, 0, 0, Mx, Mx,
+                                PISM.CELL_CORNER, PISM.NOT_PERIODIC)
+
+    geometry = PISM.Geometry(grid)
+    geometry.bed_elevation.set(0.0)
+    geometry.ice_thickness.set(0.0)
+    geometry.sea_level_elevation.set(0.0)
+    geometry.ensure_consistency(0.0)
+
+    bed_uplift = PISM.IceModelVec2S(grid, "uplift", PISM.WITHOUT_GHOSTS)
+    bed_uplift.set(0.0)
+
+    start = time.time()
+    model = PISM.LingleClark(grid)
+    model.bootstrap(geometry.bed_elevation, bed_uplift, geometry.ice_thickness,
+                    geometry.sea_level_elevation)
+    setup = time.time() - start
+
+    with PISM.vec.Access(nocomm=geometry.ice_thickness):
+        for (i, j) in grid.points():
+            if PISM.radius(grid, i, j) <= 0.5 * L:
+                geometry.ice_thickness[i, j] = 1000.0
+
+    dt = convert(100.0, "years", "seconds")
+
+    start = time.time()
+    for k in range(n_steps):
+        model.step(geometry.ice_thickness, geometry.sea_level_elevation, dt)
+    steps = time.time() - start
+
+    return setup, steps, model.total_displacement().numpy()
+
+if __name__ == "__main__":
+    Mx = int(sys.argv[1]) if len(sys.argv) > 1 else 201
+    n_steps = int(sys.argv[2]) if len(sys.argv) > 2 else 10
+
+    log = ctx.log
+    log.set_threshold(1)
+
+    results = {}
+    for fft in ["serial", "parallel"]:
+        setup, steps, results[fft] = run(fft, Mx, n_steps)
+        log.message(1,
+                    "{:>8}: setup {:8.3f} s, {} steps {:8.3f} s ({}x{} grid, {} processes)\n".format(
+                        fft, setup, n_steps, steps, Mx, Mx, ctx.com.size))
+
+    config.set_string("bed_deformation.lc.fft", "serial")
+
+    np.testing.assert_allclose(results["serial"], results["parallel"], rtol=1e-10, atol=1e-10)
+    log.message(1, "Results agree.\n")
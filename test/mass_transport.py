@@ -199,3 +199,122 @@ def part_grid_symmetry_test():
     np.testing.assert_almost_equal(H, np.flipud(H))
     np.testing.assert_almost_equal(H, np.fliplr(H))
     np.testing.assert_almost_equal(H, np.flipud(np.fliplr(H)))
+
+
+def residual_redistribution_test():
+    "Front-local residual redistribution gives the same results as the full-grid version"
+    import os
+
+    ctx = PISM.Context()
+    config = ctx.config
+
+    old_part_grid = config.get_flag("geometry.part_grid.enabled")
+    old_front_local = config.get_flag("geometry.part_grid.front_local_redistribution")
+    old_max_iterations = config.get_number("geometry.part_grid.max_iterations")
+
+    Mx = 51
+    try:
+        log.disable()
+        # max_iterations = 1 leaves some residual and exercises the code adding it to ice
+        # thickness
+        for max_iterations in [10, 1]:
+            config.set_number("geometry.part_grid.max_iterations", max_iterations)
+
+            results = {}
+            for front_local in [True, False]:
+                config.set_flag("geometry.part_grid.front_local_redistribution", front_local)
+
+                geometry = run(Mx, Mx, 1.0, part_grid=True)
+
+                results[front_local] = (geometry.ice_thickness.numpy(),
+                                        geometry.ice_area_specific_volume.numpy())
+
+            for a, b in zip(results[True], results[False]):
+                np.testing.assert_allclose(a, b, rtol=1e-12, atol=1e-12)
+    finally:
+        log.enable()
+        config.set_flag("geometry.part_grid.enabled", old_part_grid)
+        config.set_flag("geometry.part_grid.front_local_redistribution", old_front_local)
+        config.set_number("geometry.part_grid.max_iterations", old_max_iterations)
+
+        filename = "profiling_%d_%d.py" % (Mx, Mx)
+        if ctx.rank == 0 and os.path.exists(filename):
+            os.remove(filename)
+
+
+def fused_kernel_run(fused, Mx=51, n_steps=5):
+    """Run GeometryEvolution::flow_step() with or without the fused kernel. Returns ice
+    thickness, flux divergence and the conservation error after n_steps steps."""
+    ctx = PISM.Context()
+    config = ctx.config
+
+    old_part_grid = config.get_flag("geometry.part_grid.enabled")
+    old_fused = config.get_flag("geometry.update.fused_kernel")
+
+    try:
+        config.set_flag("geometry.part_grid.enabled", False)
+        config.set_flag("geometry.update.fused_kernel", fused)
+
+        grid = PISM.IceGrid_Shallow(ctx.ctx, 1, 1, 0, 0, Mx, Mx, PISM.CELL_CORNER, PISM.NOT_PERIODIC)
+
+        L = min(grid.Lx(), grid.Ly())
+
+        geometry = PISM.Geometry(grid)
+
+        v         = PISM.IceModelVec2V(grid, "velocity", PISM.WITH_GHOSTS)
+        Q         = PISM.IceModelVec2Stag(grid, "Q", PISM.WITH_GHOSTS)
+        v_bc_mask = PISM.IceModelVec2Int(grid, "v_bc_mask", PISM.WITHOUT_GHOSTS)
+        H_bc_mask = PISM.IceModelVec2Int(grid, "H_bc_mask", PISM.WITHOUT_GHOSTS)
+
+        geometry.latitude.set(0.0)
+        geometry.longitude.set(0.0)
+        # grounded in the western half of the domain, floating in the eastern half
+        with PISM.vec.Access(nocomm=geometry.bed_elevation):
+            for (i, j) in grid.points():
+                geometry.bed_elevation[i, j] = 10.0 if grid.x(i) < 0.0 else -10.0
+        geometry.sea_level_elevation.set(0.0)
+        disc(geometry.ice_thickness, 0, 0, 1, 0.25 * L, 0.35 * L)
+        geometry.ice_area_specific_volume.set(0.0)
+        geometry.ensure_consistency(0.0)
+
+        set_velocity(0.7, v)
+        # a diffusive flux that is not constant in space
+        with PISM.vec.Access(nocomm=Q):
+            for (i, j) in grid.points():
+                Q[i, j, 0] = 0.1 * grid.x(i) / L
+                Q[i, j, 1] = -0.1 * grid.y(j) / L
+        Q.update_ghosts()
+
+        v_bc_mask.set(0.0)
+        H_bc_mask.set(0.0)
+
+        ge = PISM.GeometryEvolution(grid)
+
+        dt = 0.5 * PISM.max_timestep_cfl_2d(geometry.ice_thickness,
+                                            geometry.cell_type,
+                                            v).dt_max.value()
+
+        for k in range(n_steps):
+            ge.flow_step(geometry, dt, v, Q, v_bc_mask, H_bc_mask)
+            ge.apply_flux_divergence(geometry)
+            geometry.ensure_consistency(0.0)
+
+        return (geometry.ice_thickness.numpy(),
+                ge.flux_divergence().numpy(),
+                ge.conservation_error().numpy())
+    finally:
+        config.set_flag("geometry.part_grid.enabled", old_part_grid)
+        config.set_flag("geometry.update.fused_kernel", old_fused)
+
+
+def fused_kernel_test():
+    "The fused flow step kernel produces the same results as the multi-pass implementation"
+    try:
+        log.disable()
+        fused = fused_kernel_run(True)
+        multi_pass = fused_kernel_run(False)
+    finally:
+        log.enable()
+
+    for a, b in zip(fused, multi_pass):
+        np.testing.assert_array_equal(a, b)
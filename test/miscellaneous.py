@@ -802,6 +802,44 @@ def regridding_test():
 
 
 
+def cached_regridding_test():
+    "Regrid variables from files using different grids onto the same grid"
+    def F(x, y):
+        return 2.0 * x + 3.0 * y
+
+    target = PISM.testing.shallow_grid(Mx=21, My=31)
+
+    files = ["cached_regridding_{}.nc".format(k) for k in range(5)]
+    with PISM.testing.temporary_files(*files):
+        for k, (Mx, My) in enumerate([(11, 13), (17, 19), (11, 13)]):
+            # input grids cover the target grid
+            source = PISM.testing.shallow_grid(Mx=Mx, My=My, Lx=11e3, Ly=21e3)
+
+            v = PISM.IceModelVec2S(source, "v", PISM.WITHOUT_GHOSTS)
+            with PISM.vec.Access(nocomm=v):
+                for (i, j) in source.points():
+                    v[i, j] = F(source.x(i), source.y(j)) + k
+            v.dump(files[k])
+
+        # two files using the target grid: different data, the same interpolation context
+        for k in [3, 4]:
+            PISM.testing.index_field(target, "v", offset=k).dump(files[k])
+
+        # read twice to re-use cached interpolation contexts; files 3 and 4 check that
+        # re-using a context does not re-use data read earlier
+        for _ in range(2):
+            for k, filename in enumerate(files):
+                w = PISM.testing.read_field(target, "v", filename)
+
+                if k >= 3:
+                    PISM.testing.check_index_field(w, offset=k)
+                    continue
+
+                # bilinear interpolation reproduces linear functions
+                with PISM.vec.Access(nocomm=w):
+                    for (i, j) in target.points():
+                        assert abs(w[i, j] - (F(target.x(i), target.y(j)) + k)) < 1e-6
+
 def interpolation_weights_test():
     "Test 2D interpolation weights."
 
@@ -1146,6 +1184,59 @@ class AgeModel(TestCase):
 
         model.age().dump(self.output_file)
 
+    def test_age_model_semi_lagrangian(self):
+        "Check the semi-Lagrangian age model"
+        ice_thickness = PISM.model.createIceThicknessVec(self.grid)
+
+        u = PISM.IceModelVec3(self.grid, "u", PISM.WITHOUT_GHOSTS)
+        v = PISM.IceModelVec3(self.grid, "v", PISM.WITHOUT_GHOSTS)
+        w = PISM.IceModelVec3(self.grid, "w", PISM.WITHOUT_GHOSTS)
+
+        ice_thickness.set(4000.0)
+        u.set(0.0)
+        v.set(0.0)
+        w.set(0.0)
+
+        config = ctx.config
+        config.set_string("age.method", "semi_lagrangian")
+        config.set_number("age.semi_lagrangian.update_interval", 2.0)
+        try:
+            model = PISM.AgeModel(self.grid, None)
+            input_options = PISM.process_input_options(ctx.com, ctx.config)
+            model.init(input_options)
+
+            inputs = PISM.AgeModelInputs(ice_thickness, u, v, w)
+
+            dt = PISM.util.convert(1, "years", "seconds")
+
+            # the first step is shorter than the update interval: age is not updated
+            model.update(0, dt, inputs)
+            np.testing.assert_almost_equal(model.age().norm(PISM.PETSc.NormType.NORM_INFINITY), 0.0)
+
+            # save the model state and re-start: the time since the last update is
+            # preserved, so the restarted model updates age after one more step
+            output = PISM.util.prepare_output(self.output_file)
+            model.define_model_state(output)
+            model.write_model_state(output)
+            output.close()
+
+            restarted = PISM.AgeModel(self.grid, None)
+            restarted.init(PISM.InputOptions(PISM.INIT_RESTART, self.output_file, 0))
+
+            for m in [model, restarted]:
+                # with zero velocity the age in the ice is the time since the beginning of
+                # the run
+                m.update(dt, dt, inputs)
+                age = m.age()
+                with PISM.vec.Access(nocomm=age):
+                    for (i, j) in self.grid.points():
+                        np.testing.assert_almost_equal(age.get_column_vector(i, j)[0] / dt, 2.0)
+
+            model.age().dump(self.output_file)
+        finally:
+            config.set_string("age.method", "upwind")
+            config.set_number("age.semi_lagrangian.update_interval", 0.0)
+
     def tearDown(self):
         os.remove(self.output_file)
 
@@ -1165,6 +1256,538 @@ def checksum_test():
 
     assert old_checksum != v.checksum()
 
+def async_output_test():
+    "Write fields using the asynchronous writer and read them back"
+    filename = "async_output.nc"
+
+    if not PISM.AsyncWriter.supported():
+        return
+
+    grid = PISM.testing.shallow_grid(Mx=23, My=31)
+    field_size = grid.Mx() * grid.My() * 8
+
+    with PISM.testing.temporary_files(filename, filename + "~"):
+        # the second queue fits one field only: the writer blocks and then falls back to
+        # synchronous writes
+        for queue_size, n_staged in [(2**20, 3), (field_size, 1)]:
+            writer = PISM.AsyncWriter(ctx.com, queue_size)
+
+            output = PISM.util.prepare_output(filename)
+            output.set_async_writer(writer)
+            for k in range(3):
+                PISM.testing.index_field(grid, "v{}".format(k), k).write(output)
+            output.close()
+
+            writer.wait(filename)
+
+            for k in range(3):
+                v = PISM.testing.read_field(grid, "v{}".format(k), filename, method="read")
+                PISM.testing.check_index_field(v, k)
+
+            if ctx.rank == 0:
+                assert writer.stats().n_arrays == n_staged
+
+def aggregated_output_test():
+    "Write fields using the netcdf3 backend with different numbers of aggregators"
+    config = ctx.config
+
+    old_format = config.get_string("output.format")
+    old_aggregators = config.get_number("output.aggregators")
+
+    filename = "aggregated_output.nc"
+    try:
+        config.set_string("output.format", "netcdf3")
+        with PISM.testing.temporary_files(filename):
+            for N in [0, 1, 2, 100]:
+                config.set_number("output.aggregators", N)
+
+                # aggregation groups are created once per grid
+                grid = PISM.testing.shallow_grid(Mx=23, My=31)
+
+                PISM.testing.index_field(grid, "v").dump(filename)
+                PISM.testing.check_index_field(PISM.testing.read_field(grid, "v", filename))
+
+                # aggregators assemble blocks of rows: check interleaved components and
+                # arrays with ghosts
+                u = PISM.IceModelVec2V(grid, "u", PISM.WITH_GHOSTS, 2)
+                with PISM.vec.Access(nocomm=u):
+                    for (i, j) in grid.points():
+                        u[i, j].u = 1000.0 * j + i
+                        u[i, j].v = -(1000.0 * j + i)
+                u.dump(filename)
+
+                w = PISM.IceModelVec2V(grid, "u", PISM.WITHOUT_GHOSTS)
+                w.regrid(filename, critical=True)
+                with PISM.vec.Access(nocomm=w):
+                    for (i, j) in grid.points():
+                        assert w[i, j].u == 1000.0 * j + i
+                        assert w[i, j].v == -(1000.0 * j + i)
+    finally:
+        config.set_string("output.format", old_format)
+        config.set_number("output.aggregators", old_aggregators)
+
+def output_quantization_test():
+    "Check that compressed output keeps the requested number of significant digits"
+    import numpy as np
+
+    ctx = PISM.Context()
+    config = ctx.config
+
+    # keep 3 digits, i.e. ceil(3 * log2(10)) = 10 of 52 mantissa bits
+    digits = 3
+    drop_bits = 52 - int(np.ceil(digits * np.log2(10.0)))
+
+    def write(filename, fields):
+        output = PISM.util.prepare_output(filename)
+        for f in fields:
+            f.define(output, PISM.PISM_DOUBLE)
+        for f in fields:
+            f.write(output)
+        output.close()
+
+    def quantized(v):
+        "Returns True if low mantissa bits of all values of v are zero."
+        bits = np.ascontiguousarray(v.numpy(), dtype=np.float64).view(np.uint64)
+        return np.all(bits & np.uint64((1 << drop_bits) - 1) == 0)
+
+    filename = "quantized_output.nc"
+    old_format = config.get_string("output.format")
+    with PISM.testing.temporary_files(filename):
+        try:
+            config.set_number("output.compression.level", 1)
+            config.set_string("output.compression.variables", "v:{},thk:{}".format(digits, digits))
+
+            grid = PISM.testing.shallow_grid(Mx=11, My=11)
+
+            v = PISM.IceModelVec2S(grid, "v", PISM.WITHOUT_GHOSTS)
+            with PISM.vec.Access(nocomm=v):
+                for (i, j) in grid.points():
+                    v[i, j] = 1.0 + 0.123456789 * (i + 10 * j)
+
+            # the model state is never quantized
+            H = PISM.testing.index_field(grid, "thk", offset=0.123456789)
+            H.set_attrs("model_state", "ice thickness", "m", "m", "land_ice_thickness", 0)
+
+            # NetCDF-3 files are not compressed, so they are not quantized either
+            config.set_string("output.format", "netcdf3")
+            write(filename, [v, H])
+            w = PISM.testing.read_field(grid, "v", filename)
+            w.add(-1.0, v)
+            assert w.norm(PISM.PETSc.NormType.NORM_INFINITY) == 0.0
+
+            for backend in ["netcdf4_parallel", "pio_netcdf4p", "pio_netcdf4c"]:
+                config.set_string("output.format", backend)
+                try:
+                    write(filename, [v, H])
+                except RuntimeError:
+                    # PISM was built without this backend
+                    continue
+
+                w = PISM.testing.read_field(grid, "v", filename)
+                assert quantized(w)
+                with PISM.vec.Access(nocomm=[v, w]):
+                    for (i, j) in grid.points():
+                        assert abs(w[i, j] - v[i, j]) <= 5e-4 * abs(v[i, j]), (i, j)
+
+                thk = PISM.testing.read_field(grid, "thk", filename)
+                PISM.testing.check_index_field(thk, offset=0.123456789)
+        finally:
+            config.set_string("output.format", old_format)
+            config.set_number("output.compression.level", 0)
+            config.set_string("output.compression.variables", "")
+
+def binary_checkpoint_test():
+    "Write and read back a binary checkpoint"
+    import os
+
+    filename = "binary_checkpoint.nc"
+    with PISM.testing.temporary_files(filename, filename + ".bin"):
+        grid = PISM.testing.shallow_grid(Mx=23, My=31)
+
+        # internal and "glaciological" units differ: binary data are stored in internal units
+        v = PISM.testing.index_field(grid, "v")
+        v.set_attrs("model_state", "velocity", "m s-1", "m year-1", "", 0)
+
+        # defined after the binary checkpoint is stopped: stored in the NetCDF file
+        u = PISM.testing.index_field(grid, "u", offset=0.5)
+
+        output = PISM.util.prepare_output(filename)
+        output.start_binary_checkpoint(grid)
+        v.define(output)
+        output.stop_binary_checkpoint()
+        u.define(output)
+        v.write(output)
+        u.write(output)
+        output.close()
+
+        if ctx.rank == 0:
+            # one double per grid point
+            assert os.stat(filename + ".bin").st_size == 8 * grid.Mx() * grid.My()
+
+        f = PISM.File(ctx.com, filename, PISM.PISM_NETCDF3, PISM.PISM_READONLY)
+        assert f.is_binary("v")
+        assert not f.is_binary("u")
+        f.close()
+
+        for method in ["read", "regrid"]:
+            w = PISM.IceModelVec2S(grid, "v", PISM.WITHOUT_GHOSTS)
+            w.set_attrs("model_state", "velocity", "m s-1", "m year-1", "", 0)
+            if method == "read":
+                w.read(filename, 0)
+            else:
+                w.regrid(filename, critical=True)
+            PISM.testing.check_index_field(w)
+
+            PISM.testing.check_index_field(PISM.testing.read_field(grid, "u", filename, method),
+                                           offset=0.5)
+
+def define_batch_test():
+    "Write variables defined in a batch, with and without committing it early"
+    filename = "define_batch.nc"
+    time_name = ctx.config.get_string("time.dimension_name")
+
+    grid = PISM.testing.shallow_grid(Mx=23, My=31)
+    Mx, My = grid.Mx(), grid.My()
+
+    fields = [PISM.testing.index_field(grid, "v{}".format(k), offset=k) for k in range(6)]
+
+    def write(output, fields):
+        # interleave definitions and writes
+        for v in fields:
+            v.define(output)
+            v.write(output)
+            output.write_attribute(v.get_name(), "comment", "written in a batch")
+
+    with PISM.testing.temporary_files(filename):
+        # a zero buffer size forces writing data right away
+        for buffer_size in [0, 2**20]:
+            output = PISM.util.prepare_output(filename)
+
+            output.begin_define_batch(buffer_size)
+            write(output, fields[:2])
+            # reading ends the batch: data written so far have to be available
+            data = output.read_variable("v1", [0, 0, 0], [1, My, Mx])
+            for j in range(My):
+                for i in range(Mx):
+                    assert data[j * Mx + i] == 1000.0 * j + i + 1
+            # the batch is over: these are written right away
+            write(output, fields[2:4])
+
+            output.begin_define_batch(buffer_size)
+            write(output, fields[4:5])
+            # writing a time-dependent variable ends the batch, too
+            output.write_variable(time_name, [1], [1], [1.0])
+            assert output.dimension_length(time_name) == 2
+            write(output, fields[5:])
+            output.commit_define_batch()
+            output.close()
+
+            # v5 was written after the second record was added
+            for k, v in enumerate(fields):
+                w = PISM.IceModelVec2S(grid, v.get_name(), PISM.WITHOUT_GHOSTS)
+                w.read(filename, 1 if k == 5 else 0)
+                PISM.testing.check_index_field(w, offset=k)
+
+            f = PISM.File(ctx.com, filename, PISM.PISM_NETCDF3, PISM.PISM_READONLY)
+            for v in fields:
+                assert f.read_text_attribute(v.get_name(), "comment") == "written in a batch"
+            f.close()
+
+def incremental_backup_test():
+    "Fields that did not change are not written to delta files"
+    base = "backup_base.nc"
+    deltas = ["backup_delta_1.nc", "backup_delta_2.nc"]
+    full = "backup_full.nc"
+
+    index = PISM.BackupIndex()
+
+    def backup(filename, fields, index):
+        output = PISM.util.prepare_output(filename)
+        if index is not None:
+            output.set_backup_index(index)
+        for f in fields:
+            f.write(output)
+        output.close()
+
+    def sources(filename):
+        f = PISM.File(ctx.com, filename, PISM.PISM_NETCDF3, PISM.PISM_READONLY)
+        try:
+            return [f.read_text_attribute(name, "pism_backup_source") for name in ["v", "w"]]
+        finally:
+            f.close()
+
+    with PISM.testing.temporary_files(base, full, *deltas):
+        grid = PISM.testing.shallow_grid(Mx=11, My=13)
+
+        v = PISM.testing.index_field(grid, "v")
+        w = PISM.testing.index_field(grid, "w", offset=1.0)
+
+        backup(base, [v, w], index)
+        assert sources(base) == ["", ""]
+
+        w.shift(1.0)
+        backup(deltas[0], [v, w], index)
+        assert sources(deltas[0]) == [base, ""]
+
+        # nothing changed: each variable refers to the file it was last written to
+        backup(deltas[1], [v, w], index)
+        assert sources(deltas[1]) == [base, deltas[0]]
+
+        # files written without a backup index contain all the data
+        backup(full, [v, w], None)
+        assert sources(full) == ["", ""]
+
+        for filename in deltas + [full]:
+            for method in ["read", "regrid"]:
+                PISM.testing.check_index_field(PISM.testing.read_field(grid, "v", filename, method))
+                PISM.testing.check_index_field(PISM.testing.read_field(grid, "w", filename, method),
+                                               offset=2.0)
+
+def output_coarsening_test():
+    "Write coarsened spatial fields"
+    filename = "output_coarsening.nc"
+    factor = 5
+    fill_value = -2e9
+
+    grid = PISM.testing.shallow_grid(Mx=23, My=31)
+
+    def create(name, f):
+        v = PISM.IceModelVec2S(grid, name, PISM.WITHOUT_GHOSTS)
+        with PISM.vec.Access(nocomm=v):
+            for (i, j) in grid.points():
+                v[i, j] = f(i, j)
+        return v
+
+    # block averages of a linear function are equal to its values at block centers
+    linear = create("linear", lambda i, j: grid.x(i) + 2.0 * grid.y(j))
+
+    # block averages of i**2 + j**2 exceed values at block centers by 4 (factor 5)
+    def quadratic(i, j):
+        return float(i**2 + j**2)
+    q = create("q", quadratic)
+    # flags are subsampled
+    flags = create("flags", quadratic)
+    flags.metadata().set_numbers("flag_values", [0, 1])
+    # the method is set explicitly
+    r = create("r", quadratic)
+
+    # the first column of blocks is missing and the second one has one missing column of
+    # points
+    v = PISM.testing.index_field(grid, "v")
+    v.metadata().set_number("_FillValue", fill_value)
+    with PISM.vec.Access(nocomm=v):
+        for (i, j) in grid.points():
+            if i <= factor:
+                v[i, j] = fill_value
+
+    center = (factor - 1) // 2
+
+    with PISM.testing.temporary_files(filename):
+        for method in ["average", "subsample"]:
+            coarsening = PISM.Coarsening(grid, factor, PISM.string_to_coarsening_method(method))
+            coarsening.set_method("r", PISM.string_to_coarsening_method("subsample"))
+
+            output = PISM.util.prepare_output(filename)
+            output.set_coarsening(coarsening)
+            for field in [linear, q, flags, r, v]:
+                field.write(output)
+            output.close()
+
+            f = PISM.File(ctx.com, filename, PISM.PISM_NETCDF3, PISM.PISM_READONLY)
+            x = f.read_dimension("x")
+            y = f.read_dimension("y")
+
+            assert len(x) == grid.Mx() // factor
+            assert len(y) == grid.My() // factor
+            np.testing.assert_almost_equal(x[1] - x[0], factor * grid.dx())
+            np.testing.assert_almost_equal(y[1] - y[0], factor * grid.dy())
+
+            def read(name):
+                data = f.read_variable(name, [0, 0, 0], [1, len(y), len(x)])
+                return np.array(data).reshape((len(y), len(x)))
+
+            data = {name: read(name) for name in ["linear", "q", "flags", "r", "v"]}
+            f.close()
+
+            for J in range(len(y)):
+                for I in range(len(x)):
+                    i = I * factor + center
+                    j = J * factor + center
+
+                    np.testing.assert_almost_equal(data["linear"][J, I], x[I] + 2.0 * y[J])
+
+                    if method == "average":
+                        np.testing.assert_almost_equal(data["q"][J, I], quadratic(i, j) + 4.0)
+                    else:
+                        assert data["q"][J, I] == quadratic(i, j)
+                    assert data["flags"][J, I] == quadratic(i, j)
+                    assert data["r"][J, I] == quadratic(i, j)
+
+                    if I == 0:
+                        assert data["v"][J, I] == fill_value
+                    elif I == 1 and method == "average":
+                        # the average of columns that are not missing
+                        np.testing.assert_almost_equal(data["v"][J, I],
+                                                       1000.0 * j + i + 0.5)
+                    else:
+                        assert data["v"][J, I] == 1000.0 * j + i
+
+def label_components_test():
+    "Compare distributed connected component labeling to a serial flood fill"
+    Mx, My = 23, 17
+    grid = PISM.testing.shallow_grid(Mx=Mx, My=My)
+
+    def pattern(i, j):
+        "A pattern of stripes and blobs, some of them 'grounded' (value 2)"
+        if (i + 2 * j) % 7 < 3 or (i * j) % 5 == 1:
+            return 2.0 if (i + j) % 11 == 0 else 1.0
+        return 0.0
+
+    # serial flood fill: labels are assigned in the order of first cells in the natural
+    # ordering
+    image = [[pattern(i, j) for i in range(Mx)] for j in range(My)]
+    labels = [[0] * Mx for j in range(My)]
+    grounded = {}
+    n_components = 0
+    for j in range(My):
+        for i in range(Mx):
+            if image[j][i] > 0 and labels[j][i] == 0:
+                n_components += 1
+                labels[j][i] = n_components
+                grounded[n_components] = False
+                stack = [(i, j)]
+                while stack:
+                    a, b = stack.pop()
+                    grounded[n_components] |= image[b][a] == 2.0
+                    for c, d in [(a - 1, b), (a + 1, b), (a, b - 1), (a, b + 1)]:
+                        if 0 <= c < Mx and 0 <= d < My and image[d][c] > 0 and labels[d][c] == 0:
+                            labels[d][c] = n_components
+                            stack.append((c, d))
+
+    mask = PISM.IceModelVec2Int(grid, "mask", PISM.WITHOUT_GHOSTS)
+
+    for identify_icebergs in [False, True]:
+        with PISM.vec.Access(nocomm=mask):
+            for (i, j) in grid.points():
+                mask[i, j] = pattern(i, j)
+
+        PISM.label_components(mask, identify_icebergs, 2.0)
+
+        with PISM.vec.Access(nocomm=mask):
+            for (i, j) in grid.points():
+                label = labels[j][i]
+                if identify_icebergs and label > 0:
+                    expected = 0 if grounded[label] else 1
+                else:
+                    expected = label
+                assert mask[i, j] == expected
+
+def front_band_test():
+    "Check that incremental updates of the narrow band near ice margins match re-building it"
+    Mx, My = 31, 31
+    grid = PISM.testing.shallow_grid(Mx=Mx, My=My)
+
+    geometry = PISM.Geometry(grid)
+    geometry.bed_elevation.set(-500.0)
+    geometry.sea_level_elevation.set(0.0)
+
+    width = 2
+
+    def band_cells(band):
+        xs, ys, xm = grid.xs(), grid.ys(), grid.xm()
+        return set((xs + band.index(k) % xm, ys + band.index(k) // xm)
+                   for k in range(band.size()))
+
+    def expected_cells(R):
+        "Cells within 'width' of a cell on either side of the edge of a disc of radius R"
+        icy = set((i, j) for i in range(Mx) for j in range(My)
+                  if (i - Mx // 2)**2 + (j - My // 2)**2 < R**2)
+        front = set()
+        for (i, j) in [(i, j) for i in range(Mx) for j in range(My)]:
+            for (a, b) in [(i + 1, j), (i - 1, j), (i, j + 1), (i, j - 1)]:
+                if 0 <= a < Mx and 0 <= b < My and ((i, j) in icy) != ((a, b) in icy):
+                    front.add((i, j))
+        return set((i, j) for (i, j) in grid.points()
+                   if any(abs(i - a) <= width and abs(j - b) <= width for (a, b) in front))
+
+    # re-build every 1000 updates, i.e. only during the first one
+    band = PISM.FrontBand(grid, width, 1000)
+
+    # a shrinking disc: the front moves by at most one cell between updates
+    for R in [10.0, 9.5, 9.0, 8.0, 7.0]:
+        with PISM.vec.Access(nocomm=geometry.ice_thickness):
+            for (i, j) in grid.points():
+                if (i - Mx // 2)**2 + (j - My // 2)**2 < R**2:
+                    geometry.ice_thickness[i, j] = 100.0
+                else:
+                    geometry.ice_thickness[i, j] = 0.0
+        geometry.ensure_consistency(0.0)
+
+        band.update(geometry.cell_type)
+
+        assert band_cells(band) == expected_cells(R)
+
+    try:
+        PISM.FrontBand(grid, 1, 1000)
+        assert False, "a narrow band of width 1 should be rejected"
+    except RuntimeError:
+        pass
+
+def front_band_calving_test():
+    "Check that calving rates computed using the narrow band match the ones computed everywhere"
+    Mx, My = 31, 31
+    grid = PISM.testing.shallow_grid(Mx=Mx, My=My, Lx=10e3, Ly=10e3)
+
+    geometry = PISM.Geometry(grid)
+    geometry.bed_elevation.set(-500.0)
+    geometry.sea_level_elevation.set(0.0)
+
+    R = 10.0
+    with PISM.vec.Access(nocomm=geometry.ice_thickness):
+        for (i, j) in grid.points():
+            if (i - Mx // 2)**2 + (j - My // 2)**2 < R**2:
+                geometry.ice_thickness[i, j] = 800.0
+            else:
+                geometry.ice_thickness[i, j] = 0.0
+    geometry.ensure_consistency(0.0)
+
+    band = PISM.FrontBand(grid, 2, 1000)
+    band.update(geometry.cell_type)
+
+    xs, ys, xm = grid.xs(), grid.ys(), grid.xm()
+    in_band = set((xs + band.index(k) % xm, ys + band.index(k) // xm)
+                  for k in range(band.size()))
+
+    def calving_rate(band):
+        model = PISM.CalvingHayhurstCalving(grid)
+        model.init()
+        model.update(geometry.cell_type, geometry.ice_thickness,
+                     geometry.sea_level_elevation, geometry.bed_elevation, band)
+
+        result = PISM.IceModelVec2S(grid, "calving_rate", PISM.WITHOUT_GHOSTS)
+        result.copy_from(model.calving_rate())
+        return result
+
+    everywhere = calving_rate(None)
+    near_margins = calving_rate(band)
+
+    cell_type = geometry.cell_type
+    n_front = 0
+    with PISM.vec.Access(nocomm=[everywhere, near_margins, cell_type]):
+        for (i, j) in grid.points():
+            if (i, j) in in_band:
+                assert near_margins[i, j] == everywhere[i, j]
+            else:
+                assert near_margins[i, j] == 0.0
+
+            # front retreat code uses calving rates at these locations
+            if cell_type.ice_free_ocean(i, j) and cell_type.next_to_ice(i, j):
+                assert (i, j) in in_band
+                assert near_margins[i, j] > 0.0
+                n_front += 1
+
+    assert PISM.GlobalSum(ctx.com, n_front) > 0
+
 class ForcingOptions(TestCase):
     def setUp(self):
         # store current configuration parameters
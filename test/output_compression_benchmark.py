@@ -0,0 +1,129 @@
+#!/usr/bin/env python
+
+"""Compare write throughput and file sizes of spatial output using different I/O backends
+and compression settings.
+
+Usage: python output_compression_benchmark.py [Mx] [Mz] [n_records]
+
+Writes n_records records of a smooth 3D field (similar to ice enthalpy) and a 2D field
+(similar to ice thickness) to a file, once for each combination of I/O backend and
+compression settings. Backends PISM was built without are skipped.
+
+Run with mpiexec to include parallel backends.
+"""
+
+import os
+import sys
+import time
+
+import numpy as np
+import PISM
+
+ctx = PISM.Context()
+config = ctx.config
+
+backends = ["netcdf3", "netcdf4_parallel", "pnetcdf",
+            "pio_netcdf", "pio_netcdf4c", "pio_netcdf4p", "pio_pnetcdf"]
+
+# (deflate level, shuffle, significant digits)
+compression = [(0, False, 0),
+               (1, True, 0),
+               (5, True, 0),
+               (1, True, 4),
+               (1, True, 3)]
+
+def create_grid(Mx, Mz):
+    "Create a grid with Mx*Mx points and Mz vertical levels."
+    config.set_number("grid.Mz", Mz)
+    config.set_number("grid.Lz", 4000.0)
+
+    params = PISM.GridParameters(config)
+    params.Lx = 1e6
+    params.Ly = 1e6
+    params.Mx = Mx
+    params.My = Mx
+    params.ownership_ranges_from_options(ctx.size)
+
+    return PISM.IceGrid(ctx.ctx, params)
+
+def create_fields(grid):
+    "Create smooth 2D and 3D fields with a bit of noise."
+    H = PISM.IceModelVec2S(grid, "thk", PISM.WITHOUT_GHOSTS)
+    H.set_attrs("model_state", "ice thickness", "m", "m", "land_ice_thickness", 0)
+
+    E = PISM.IceModelVec3(grid, "enthalpy", PISM.WITHOUT_GHOSTS)
+    E.set_attrs("model_state", "ice enthalpy", "J kg-1", "J kg-1", "", 0)
+
+    z = np.array(grid.z())
+    noise = np.random.RandomState(ctx.rank)
+
+    with PISM.vec.Access(nocomm=[H, E]):
+        for (i, j) in grid.points():
+            r = PISM.radius(grid, i, j) / grid.Lx()
+            H[i, j] = max(3000.0 * (1.0 - r**2), 0.0) + noise.uniform(0.0, 1.0)
+            column = 1.0e5 + 1.0e3 * r - 10.0 * z + noise.uniform(0.0, 10.0, z.size)
+            E.set_column(i, j, list(column))
+
+    return H, E
+
+def write(filename, backend, fields, n_records):
+    "Write n_records records of fields. Returns the time spent writing."
+    config.set_string("output.format", backend)
+
+    start = time.time()
+    output = PISM.util.prepare_output(filename, append_time=False)
+
+    for f in fields:
+        f.define(output, PISM.PISM_FLOAT)
+
+    for k in range(n_records):
+        PISM.append_time(output, config.get_string("time.dimension_name"), float(k))
+        for f in fields:
+            f.write(output)
+
+    output.close()
+
+    return time.time() - start
+
+def run(Mx, Mz, n_records):
+    grid = create_grid(Mx, Mz)
+    fields = create_fields(grid)
+
+    # uncompressed size of the data, in MiB (single precision)
+    data_size = 4.0 * Mx * Mx * (Mz + 1) * n_records / 2**20
+
+    filename = "output_compression_benchmark.nc"
+
+    log = ctx.log
+    log.message(1, "{:>18} {:>5} {:>7} {:>6} {:>9} {:>9} {:>10}\n".format(
+        "backend", "level", "shuffle", "digits", "time, s", "MiB/s", "size, MiB"))
+
+    for backend in backends:
+        for (level, shuffle, digits) in compression:
+            config.set_number("output.compression.level", level)
+            config.set_flag("output.compression.shuffle", shuffle)
+            config.set_number("output.compression.significant_digits", digits)
+
+            try:
+                elapsed = write(filename, backend, fields, n_records)
+            except RuntimeError as e:
+                log.message(1, "{:>18}: skipped ({})\n".format(backend, str(e).split("\n")[0]))
+                break
+
+            size = 0.0
+            if ctx.rank == 0:
+                size = os.stat(filename).st_size / 2.0**20
+                os.remove(filename)
+
+            log.message(1, "{:>18} {:>5} {:>7} {:>6} {:9.3f} {:9.1f} {:10.1f}\n".format(
+                backend, level, str(shuffle), digits, elapsed, data_size / elapsed, size))
+
+    config.set_number("output.compression.level", 0)
+    config.set_number("output.compression.significant_digits", 0)
+
+if __name__ == "__main__":
+    Mx = int(sys.argv[1]) if len(sys.argv) > 1 else 201
+    Mz = int(sys.argv[2]) if len(sys.argv) > 2 else 51
+    n_records = int(sys.argv[3]) if len(sys.argv) > 3 else 5
+
+    run(Mx, Mz, n_records)
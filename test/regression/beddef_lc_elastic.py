@@ -1,6 +1,7 @@
 #!/usr/bin/env python
 
 from unittest import TestCase
+import os
 
 import numpy as np
 import scipy.integrate
@@ -131,6 +132,25 @@ class LingleClarkElastic(TestCase):
         # This is a crappy relative tolerance. Oh well...
         np.testing.assert_allclose(self.lrm_pism, lrm_python, rtol=1e-2)
 
+    def cache_test(self):
+        "Check that the load response matrix read from a cache file is the same"
+        config = self.ctx.config
+        filename = "beddef_lc_elastic_load_response.nc"
+
+        config.set_string("bed_deformation.lc.elastic_load_response_file", filename)
+        try:
+            # the first run computes and saves the load response, the second one reads it
+            _, db_computed, lrm_computed = self.run_model(self.grid)
+            _, db_cached, lrm_cached = self.run_model(self.grid)
+        finally:
+            config.set_string("bed_deformation.lc.elastic_load_response_file", "")
+            if os.path.exists(filename):
+                os.remove(filename)
+
+        np.testing.assert_equal(lrm_cached, lrm_computed)
+        np.testing.assert_equal(db_cached, db_computed)
+        np.testing.assert_equal(lrm_computed, self.lrm_pism)
+
     def tearDown(self):
         # reset configuration parameters
         self.ctx.config.set_flag("bed_deformation.lc.elastic_model", self.elastic)
@@ -0,0 +1,80 @@
+#!/usr/bin/env python
+
+"""Compares the serial and distributed FFT implementations of the Lingle-Clark bed
+deformation model.
+
+Uses a non-square grid and an asymmetric load, so that results depend on the slab
+decomposition and transposes of the extended grid if these are wrong. Meant to be run
+using several numbers of processes.
+"""
+
+import PISM
+from PISM.util import convert
+import numpy as np
+
+ctx = PISM.Context()
+
+# silence initialization messages
+ctx.log.set_threshold(1)
+
+Lx = convert(2000, "km", "m")
+Ly = convert(1500, "km", "m")
+Mx = 61
+My = 47
+
+ctx.config.set_number("bed_deformation.lc.grid_size_factor", 2)
+
+dt = convert(1000.0, "years", "seconds")
+
+def add_load(ice_thickness):
+    "Add an off-center disc and a rectangular load."
+    grid = ice_thickness.grid()
+
+    R = 0.3 * Lx
+    with PISM.vec.Access(nocomm=ice_thickness):
+        for (i, j) in grid.points():
+            x = grid.x(i)
+            y = grid.y(j)
+            if (x - 0.25 * Lx)**2 + (y + 0.2 * Ly)**2 <= R**2:
+                ice_thickness[i, j] = 1000.0
+            elif -0.8 * Lx < x < -0.4 * Lx and 0.3 * Ly < y < 0.9 * Ly:
+                ice_thickness[i, j] = 500.0
+
+def run(fft):
+    "Take two time steps using a given FFT implementation."
+    ctx.config.set_string("bed_deformation.lc.fft", fft)
+
+    grid = PISM.IceGrid.Shallow(ctx.ctx, Lx, Ly, 0, 0, Mx, My,
+                                PISM.CELL_CORNER, PISM.NOT_PERIODIC)
+
+    model = PISM.LingleClark(grid)
+
+    geometry = PISM.Geometry(grid)
+    geometry.bed_elevation.set(0.0)
+    geometry.ice_thickness.set(0.0)
+    geometry.sea_level_elevation.set(0.0)
+    geometry.ensure_consistency(0.0)
+
+    bed_uplift = PISM.IceModelVec2S(grid, "uplift", PISM.WITHOUT_GHOSTS)
+    bed_uplift.set(0.0)
+
+    model.bootstrap(geometry.bed_elevation, bed_uplift, geometry.ice_thickness,
+                    geometry.sea_level_elevation)
+
+    add_load(geometry.ice_thickness)
+
+    model.step(geometry.ice_thickness, geometry.sea_level_elevation, dt)
+    model.step(geometry.ice_thickness, geometry.sea_level_elevation, dt)
+
+    return model
+
+if __name__ == "__main__":
+    serial = run("serial")
+    parallel = run("parallel")
+
+    for name in ["bed_elevation", "uplift", "total_displacement", "viscous_displacement",
+                 "elastic_displacement"]:
+        v1 = getattr(serial, name)()
+        v2 = getattr(parallel, name)()
+        ctx.log.message(1, "Comparing {} on {} processes\n".format(v1.get_name(), ctx.size))
+        np.testing.assert_allclose(v1.numpy(), v2.numpy(), rtol=1e-10, atol=1e-10)
@@ -0,0 +1,20 @@
+#!/bin/bash
+
+# Compares the serial and distributed FFT implementations of the Lingle-Clark model using
+# 1-4 processes (exercises the slab decomposition and transposes of the extended grid).
+
+PISM_PATH=$1
+MPIEXEC=$2
+PISM_SOURCE_DIR=$3
+PYTHONEXEC=$5
+
+export PYTHONPATH=${PISM_PATH}/site-packages:${PYTHONPATH}
+
+NRANGE="1 2 3 4"
+
+set -e -x
+
+for N in $NRANGE;
+do
+    $MPIEXEC -n $N $PYTHONEXEC $PISM_SOURCE_DIR/test/regression/beddef_lc_parallel.py
+done
@@ -118,3 +118,95 @@ def lingle_clark_restart_test():
     "Compare straight and re-started runs."
     compare(run(dt),
             run(dt, restart=True))
+
+def compare_allclose(model1, model2):
+    "Compare two models, allowing for differences due to rounding."
+    for name in ["bed_elevation", "uplift", "total_displacement", "viscous_displacement",
+                 "elastic_displacement"]:
+        v1 = getattr(model1, name)()
+        v2 = getattr(model2, name)()
+        print("Comparing {}".format(v1.get_name()))
+        np.testing.assert_allclose(v1.numpy(), v2.numpy(), rtol=1e-10, atol=1e-10)
+
+def lingle_clark_parallel_test():
+    "Compare serial and distributed FFT implementations."
+    serial = run(dt)
+
+    ctx.config.set_string("bed_deformation.lc.fft", "parallel")
+    try:
+        parallel = run(dt, restart=True)
+    finally:
+        ctx.config.set_string("bed_deformation.lc.fft", "serial")
+
+    compare_allclose(serial, parallel)
+
+def lingle_clark_adaptive_test():
+    "Check that updates are skipped if the load does not change."
+    ctx.config.set_number("bed_deformation.lc.load_change_tolerance", 1.0)
+    try:
+        grid = PISM.IceGrid.Shallow(ctx.ctx, Lx, Ly, 0, 0, N, N,
+                                    PISM.CELL_CORNER, PISM.NOT_PERIODIC)
+
+        model = PISM.LingleClark(grid)
+
+        geometry = PISM.Geometry(grid)
+        geometry.bed_elevation.set(0.0)
+        geometry.ice_thickness.set(0.0)
+        # keep the sea level well below the bed so that the load is the ice thickness
+        # (bed deformation does not add ocean loads)
+        geometry.sea_level_elevation.set(-1000.0)
+        geometry.ensure_consistency(0.0)
+
+        bed_uplift = PISM.IceModelVec2S(grid, "uplift", PISM.WITHOUT_GHOSTS)
+        bed_uplift.set(0.0)
+
+        model.bootstrap(geometry.bed_elevation, bed_uplift, geometry.ice_thickness,
+                        geometry.sea_level_elevation)
+
+        t = ctx.time.current()
+        dt = model.max_timestep(t).value()
+
+        # the load did not change: skip the update
+        model.update(geometry.ice_thickness, geometry.sea_level_elevation, t, dt)
+        assert model.skipped_updates() == 1
+        assert model.error_bound() == 0.0
+
+        # add the load: the next scheduled update is performed
+        add_disc_load(geometry.ice_thickness, disc_radius, disc_thickness)
+
+        t += dt
+        dt = model.max_timestep(t).value()
+        model.update(geometry.ice_thickness, geometry.sea_level_elevation, t, dt)
+        assert model.skipped_updates() == 0
+        assert model.total_displacement().norm(PISM.PETSc.NormType.NORM_INFINITY) > 0.0
+
+        # add a small load: the RMS load change is below the tolerance, so the next two
+        # updates are skipped
+        load_change = 10.0
+        with PISM.vec.Access(nocomm=geometry.ice_thickness):
+            for (i, j) in grid.points():
+                if PISM.radius(grid, i, j) <= 0.1 * disc_radius:
+                    geometry.ice_thickness[i, j] += load_change
+
+        # the uplift does not change while updates are skipped
+        max_uplift = model.uplift().norm(PISM.PETSc.NormType.NORM_INFINITY)
+        rho_i = ctx.config.get_number("constants.ice.density")
+        rho_m = ctx.config.get_number("bed_deformation.mantle_density")
+
+        elapsed_time = 0.0
+        for k in [1, 2]:
+            t += dt
+            dt = model.max_timestep(t).value()
+            elapsed_time += dt
+            model.update(geometry.ice_thickness, geometry.sea_level_elevation, t, dt)
+            assert model.skipped_updates() == k
+
+            # the error bound is positive and equal to the displacement due to the uplift
+            # during the elapsed time plus the equilibrium response to the load change
+            error_bound = model.error_bound()
+            assert error_bound > 0.0
+            np.testing.assert_allclose(error_bound,
+                                       max_uplift * elapsed_time + (rho_i / rho_m) * load_change,
+                                       rtol=1e-12)
+    finally:
+        ctx.config.set_number("bed_deformation.lc.load_change_tolerance", 0.0)
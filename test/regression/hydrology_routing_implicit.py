@@ -0,0 +1,121 @@
+#!/usr/bin/env python
+"""Tests of the implicit time stepping in the routing and distributed hydrology models.
+"""
+
+import PISM
+
+ctx = PISM.Context()
+ctx.log.set_threshold(1)
+config = ctx.config
+
+# water input rate, kg m-2 s-1 (equivalent to 1 meter of water per year)
+input_rate = 1000.0 / PISM.util.convert(1.0, "year", "second")
+
+def setup(time_stepping, model_class=PISM.RoutingHydrology):
+    """Set up a small non-periodic domain covered by grounded ice with a patch of water input.
+
+    Modifies configuration parameters; callers have to restore them (see
+    save_config() and restore_config()).
+    """
+    config.set_string("hydrology.routing.time_stepping", time_stepping)
+    config.set_flag("hydrology.add_water_input_to_till_storage", False)
+
+    L = 5e3
+    M = 21
+    grid = PISM.IceGrid.Shallow(ctx.ctx, L, L, 0.0, 0.0, M, M,
+                                PISM.CELL_CENTER, PISM.NOT_PERIODIC)
+
+    geometry = PISM.Geometry(grid)
+
+    with PISM.vec.Access(nocomm=[geometry.bed_elevation, geometry.ice_thickness]):
+        for (i, j) in grid.points():
+            geometry.bed_elevation[i, j] = 100.0 + 0.01 * grid.x(i)
+            geometry.ice_thickness[i, j] = 500.0
+    geometry.sea_level_elevation.set(0.0)
+    geometry.ensure_consistency(0.0)
+
+    surface_input_rate = PISM.IceModelVec2S(grid, "water_input_rate", PISM.WITHOUT_GHOSTS)
+    surface_input_rate.set_attrs("", "water input rate", "kg m-2 s-1", "kg m-2 s-1", "", 0)
+
+    R = 0.25 * L
+    with PISM.vec.Access(nocomm=surface_input_rate):
+        for (i, j) in grid.points():
+            if abs(grid.x(i)) < R and abs(grid.y(j)) < R:
+                surface_input_rate[i, j] = input_rate
+            else:
+                surface_input_rate[i, j] = 0.0
+
+    zero = PISM.IceModelVec2S(grid, "zero", PISM.WITHOUT_GHOSTS)
+    zero.set(0.0)
+
+    model = model_class(grid)
+    model.init(zero, zero, zero)
+
+    inputs = PISM.HydrologyInputs()
+    inputs.no_model_mask = None
+    inputs.geometry = geometry
+    inputs.basal_melt_rate = zero
+    inputs.ice_sliding_speed = zero
+    inputs.surface_input_rate = surface_input_rate
+
+    # keep objects used by inputs alive
+    return grid, model, inputs, (geometry, surface_input_rate, zero)
+
+def save_config():
+    "Save configuration parameters modified by setup()."
+    return (config.get_string("hydrology.routing.time_stepping"),
+            config.get_flag("hydrology.add_water_input_to_till_storage"))
+
+def restore_config(saved):
+    "Restore configuration parameters saved by save_config()."
+    time_stepping, add_to_till_storage = saved
+    config.set_string("hydrology.routing.time_stepping", time_stepping)
+    config.set_flag("hydrology.add_water_input_to_till_storage", add_to_till_storage)
+
+def total_volume(grid, W):
+    return W.sum() * grid.cell_area()
+
+def test_implicit_mass_conservation():
+    "Implicit routing conserves water and keeps the water thickness non-negative"
+    saved = save_config()
+    try:
+        grid, model, inputs, _ = setup("implicit")
+
+        dt = PISM.util.convert(1.0, "year", "second")
+        model.update(0.0, dt, inputs)
+
+        W = model.subglacial_water_thickness()
+
+        expected = total_volume(grid, model.surface_input_rate()) * dt
+        volume = total_volume(grid, W)
+
+        assert abs(volume - expected) / expected < 1e-4
+        assert W.min() >= 0.0
+    finally:
+        restore_config(saved)
+
+def test_distributed_implicit():
+    "Implicit distributed model conserves water and keeps W and P within bounds"
+    saved = save_config()
+    try:
+        grid, model, inputs, _ = setup("implicit", PISM.DistributedHydrology)
+
+        dt = PISM.util.convert(1.0, "year", "second")
+        model.update(0.0, dt, inputs)
+
+        W = model.subglacial_water_thickness()
+        P = model.subglacial_water_pressure()
+        P_overburden = model.overburden_pressure()
+
+        expected = total_volume(grid, model.surface_input_rate()) * dt
+        volume = total_volume(grid, W)
+
+        assert abs(volume - expected) / expected < 1e-4
+        assert W.min() >= 0.0
+        assert P.min() >= 0.0
+
+        with PISM.vec.Access(nocomm=[P, P_overburden]):
+            for (i, j) in grid.points():
+                assert P[i, j] <= P_overburden[i, j]
+    finally:
+        restore_config(saved)
@@ -0,0 +1,43 @@
+#!/bin/bash
+
+# Tests processor independence of priority-flood depression filling and flow accumulation
+# in the steady state hydrology model (results are stitched across subdomain boundaries).
+
+PISM_PATH=$1
+MPIEXEC=$2
+PISM_SOURCE_DIR=$3
+PYTHONEXEC=$5
+
+export PYTHONPATH=${PISM_PATH}/site-packages:${PYTHONPATH}
+
+NRANGE="1 2 3 4"
+
+files="hydrology_steady_surface_input.nc"
+for N in $NRANGE;
+do
+    files="$files steady-pf-$N.nc"
+done
+
+rm -f $files
+
+set -e -x
+
+for N in $NRANGE;
+do
+    $MPIEXEC -n $N $PYTHONEXEC $PISM_SOURCE_DIR/test/regression/hydrology_steady_test.py \
+             -hydrology_steady_method priority_flood -o steady-pf-$N.nc
+done
+
+set +e
+
+# Compare:
+for N in 2 3 4;
+do
+    $PISM_PATH/nccmp.py -x -v timestamp steady-pf-1.nc steady-pf-$N.nc
+    if [ $? != 0 ];
+    then
+        exit 1
+    fi
+done
+
+rm -f $files; exit 0
@@ -138,6 +138,16 @@ class SteadyHydrology(TestCase):
 
         f.close()
 
+class SteadyHydrologyPriorityFlood(SteadyHydrology):
+    "Same tests, using priority-flood depression filling and flow accumulation."
+    def setUp(self):
+        ctx.config.set_string("hydrology.steady.method", "priority_flood")
+        SteadyHydrology.setUp(self)
+
+    def tearDown(self):
+        SteadyHydrology.tearDown(self)
+        ctx.config.set_string("hydrology.steady.method", "iterative")
+
 if __name__ == "__main__":
 
     t = SteadyHydrology()
@@ -0,0 +1,43 @@
+#!/bin/bash
+
+# Tests processor independence of the distributed connected component labeling (components
+# span sub-domain boundaries and are merged across them).
+
+PISM_PATH=$1
+MPIEXEC=$2
+PISM_SOURCE_DIR=$3
+PYTHONEXEC=$5
+
+export PYTHONPATH=${PISM_PATH}/site-packages:${PYTHONPATH}
+
+NRANGE="1 2 3 4"
+
+files=""
+for N in $NRANGE;
+do
+    files="$files label-components-$N.nc"
+done
+
+rm -f $files
+
+set -e -x
+
+for N in $NRANGE;
+do
+    $MPIEXEC -n $N $PYTHONEXEC $PISM_SOURCE_DIR/test/regression/label_components_test.py \
+             -o label-components-$N.nc
+done
+
+set +e
+
+# Compare:
+for N in 2 3 4;
+do
+    $PISM_PATH/nccmp.py -x -v timestamp label-components-1.nc label-components-$N.nc
+    if [ $? != 0 ];
+    then
+        exit 1
+    fi
+done
+
+rm -f $files; exit 0
@@ -0,0 +1,98 @@
+#!/usr/bin/env python
+
+"""Labels connected components of a mask containing a "snake" that winds through the
+whole domain (and so crosses all sub-domain boundaries), stripes and blobs.
+
+Compares results to a serial flood fill and saves them to the file set using -o (for
+comparisons of runs using different numbers of processes).
+"""
+
+import PISM
+import PISM.testing
+
+ctx = PISM.Context()
+ctx.log.set_threshold(1)
+
+# grid sizes are chosen so that sub-domains have different sizes
+Mx, My = 43, 37
+
+def snake(i, j):
+    """Rows j = 1, 5, 9, ... joined at alternating ends, forming one component spanning the
+    whole domain."""
+    if not (1 <= i <= Mx - 2 and 1 <= j <= My - 2):
+        return False
+    if j % 4 == 1:
+        return True
+    if j % 8 in (2, 3, 4):
+        return i == Mx - 2
+    if j % 8 in (6, 7, 0):
+        return i == 1
+    return False
+
+def pattern(i, j):
+    "The snake (grounded at one end only), plus blobs between its rows, some of them grounded"
+    if snake(i, j):
+        return 2.0 if (i, j) == (Mx - 2, My - 4) else 1.0
+    if j % 4 == 3 and (i * j) % 5 < 2:
+        return 2.0 if (i + j) % 11 == 0 else 1.0
+    return 0.0
+
+def flood_fill():
+    """Serial flood fill. Labels are assigned in the order of first cells in the natural
+    ordering."""
+    image = [[pattern(i, j) for i in range(Mx)] for j in range(My)]
+    labels = [[0] * Mx for j in range(My)]
+    grounded = {}
+    n_components = 0
+    for j in range(My):
+        for i in range(Mx):
+            if image[j][i] > 0 and labels[j][i] == 0:
+                n_components += 1
+                labels[j][i] = n_components
+                grounded[n_components] = False
+                stack = [(i, j)]
+                while stack:
+                    a, b = stack.pop()
+                    grounded[n_components] |= image[b][a] == 2.0
+                    for c, d in [(a - 1, b), (a + 1, b), (a, b - 1), (a, b + 1)]:
+                        if 0 <= c < Mx and 0 <= d < My and image[d][c] > 0 and labels[d][c] == 0:
+                            labels[d][c] = n_components
+                            stack.append((c, d))
+    return labels, grounded
+
+def label(grid, name, identify_icebergs):
+    "Label components of the pattern, checking results using a serial flood fill."
+    labels, grounded = flood_fill()
+
+    mask = PISM.IceModelVec2Int(grid, name, PISM.WITHOUT_GHOSTS)
+    mask.set_attrs("", "connected components (icebergs = {})".format(identify_icebergs),
+                   "", "", "", 0)
+
+    with PISM.vec.Access(nocomm=mask):
+        for (i, j) in grid.points():
+            mask[i, j] = pattern(i, j)
+
+    PISM.label_components(mask, identify_icebergs, 2.0)
+
+    with PISM.vec.Access(nocomm=mask):
+        for (i, j) in grid.points():
+            l = labels[j][i]
+            if identify_icebergs and l > 0:
+                expected = 0 if grounded[l] else 1
+            else:
+                expected = l
+            assert mask[i, j] == expected, (i, j, mask[i, j], expected)
+
+    return mask
+
+if __name__ == "__main__":
+    grid = PISM.testing.shallow_grid(Mx=Mx, My=My)
+
+    output_file = ctx.config.get_string("output.file_name")
+
+    f = PISM.util.prepare_output(output_file)
+
+    label(grid, "labels", False).write(f)
+    label(grid, "icebergs", True).write(f)
+
+    f.close()
@@ -0,0 +1,32 @@
+#!/bin/bash
+
+PISM_PATH=$1
+MPIEXEC=$2
+
+echo "Test: comparing single-rate and multirate coupling of mass continuity and energy steps."
+# The list of files to delete when done.
+files="single-rate-multirate.nc multirate-multirate.nc"
+
+rm -f $files
+
+set -e -x
+
+OPTS="-test G -Mx 31 -My 31 -Mz 31 -Mbz 1 -y 1000 -verbose 1"
+
+# single-rate
+$PISM_PATH/pismv $OPTS -o single-rate-multirate.nc
+
+# multirate: energy is updated every 10 years, using velocity sampled every year
+$PISM_PATH/pismv $OPTS -multirate -multirate_interval 10 -multirate_sampling_interval 1 \
+                 -o multirate-multirate.nc
+
+set +e
+
+# Compare: energy steps are longer, so results are close but not identical.
+$PISM_PATH/nccmp.py -t 0.5 -v temp,thk single-rate-multirate.nc multirate-multirate.nc
+if [ $? != 0 ];
+then
+    exit 1
+fi
+
+rm -f $files; exit 0